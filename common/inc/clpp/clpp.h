@@ -4,19 +4,23 @@
 #include "clpp/clppContext.h"
 #include "clpp/clppSort.h"
 #include "clpp/clppScan.h"
+#include "clpp/clppOperator.h"
 
 class clpp
 {
 public:
 	
 	// Create the best scan primitive for the context and a number of elements to scan.
-	static clppScan* createBestScan(clppContext* context, size_t valueSize, unsigned int maxElements);
+	static clppScan* createBestScan(clppContext* context, size_t valueSize, clppIndex maxElements);
+
+	// Create the best scan primitive for a data type and an associative operator (compiled on demand).
+	static clppScan* createBestScan(clppContext* context, const clppOperator& op, clppIndex maxElements);
 
 	// Create the best sort primitive for the context and a number of elements to sort.
-	static clppSort* createBestSort(clppContext* context, unsigned int maxElements, unsigned int bits);
+	static clppSort* createBestSort(clppContext* context, clppIndex maxElements, unsigned int bits);
 
 	// Create the best sort (Key+Value) primitive for the context and a number of elements to sort.
-	static clppSort* createBestSortKV(clppContext* context, unsigned int maxElements, unsigned int bits);
+	static clppSort* createBestSortKV(clppContext* context, clppIndex maxElements, unsigned int bits);
 };
 
 #endif
\ No newline at end of file
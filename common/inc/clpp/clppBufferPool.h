@@ -0,0 +1,137 @@
+#ifndef __CLPP_BUFFERPOOL_H__
+#define __CLPP_BUFFERPOOL_H__
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "clpp/clppContext.h"
+
+using namespace std;
+
+/// The allocation counters of a clppBufferPool, in bytes (the size classes, not the requested sizes)
+struct clppBufferPoolStats
+{
+	size_t inUseBytes;			// Held by the primitives and the applications
+	size_t peakInUseBytes;		// High-water mark of 'inUseBytes'
+	size_t deviceBytes;			// Allocated on the device : slabs, dedicated and pinned buffers
+	size_t peakDeviceBytes;		// High-water mark of 'deviceBytes'
+	size_t pinnedBytes;			// Part of 'deviceBytes' in pinned buffers
+	size_t acquires;			// Number of calls to 'acquire'
+	size_t deviceAllocations;	// Number of clCreateBuffer
+};
+
+/// Device buffers (CL_MEM_READ_WRITE), shared by all the primitives of a context. On the host-unified
+/// devices (clppContext::isHostUnified) they are allocated in the host memory (CL_MEM_ALLOC_HOST_PTR).
+///
+/// The requests are rounded to a size class. The small classes are carved as sub-buffers from large slabs,
+/// one device allocation for many buffers, and the large ones are dedicated buffers. The released buffers
+/// stay in the pool and are reused by the next requests of the same class, so there is no allocation in the
+/// hot loop. Use clppContext::getBufferPool() to get the pool of a context.
+///
+/// The pinned buffers (CL_MEM_ALLOC_HOST_PTR) are a class of their own, for the data sets given by the host
+/// (pushDatas) : they are dedicated buffers, with their own free lists, and are counted in the same stats.
+///
+/// The pool must outlive the primitives holding its buffers.
+///
+/// \version 1.0
+class clppBufferPool
+{
+public:
+	clppBufferPool(clppContext* context);
+	~clppBufferPool();
+
+	/// Returns a buffer of at least 'bytes' bytes
+	cl_mem acquire(size_t bytes);
+
+	/// Returns a pinned buffer of at least 'bytes' bytes
+	cl_mem acquirePinned(size_t bytes);
+
+	/// Returns the pinned 'clBuffer' when it is large enough, otherwise gives it back and returns a larger one.
+	/// 'clBuffer' can be 0.
+	cl_mem resizePinned(cl_mem clBuffer, size_t bytes);
+
+	/// Gives a buffer (pinned or not) back to the pool. 'clBuffer' can be 0.
+	void release(cl_mem clBuffer);
+
+	/// Release the free dedicated and pinned buffers, and the slabs without buffer in use
+	void trim();
+
+	/// Returns the allocation counters
+	clppBufferPoolStats getStats() { return _stats; }
+
+	/// Restart the high-water marks from the current values
+	void resetPeaks();
+
+	/// Print the allocation counters
+	void printStats();
+
+	/// The size class of a request : the next power of 2 for the slab classes, then 8 classes per power of 2
+	size_t getSizeClass(size_t bytes);
+
+private:
+	clppContext* _context;
+
+	size_t _minSizeClass;						// At least the base address alignment of the device
+
+	map<size_t, vector<cl_mem> > _freeBuffers;	// Free buffers by size class
+	map<cl_mem, size_t> _usedBuffers;			// Size class of the buffers in use, pinned or not
+
+	map<size_t, vector<cl_mem> > _freePinnedBuffers;	// Free pinned buffers by size class
+	set<cl_mem> _pinnedBuffers;						// All the pinned buffers, free or in use
+
+	map<cl_mem, cl_mem> _slabOf;				// The slab of each sub-buffer
+	map<cl_mem, size_t> _slabUsers;				// The number of sub-buffers in use of each slab
+
+	clppBufferPoolStats _stats;
+
+	void carveSlab(size_t sizeClass);
+	cl_mem createBuffer(cl_mem_flags flags, size_t sizeClass);
+	cl_mem_flags getMemFlags();
+};
+
+/// A buffer of a clppBufferPool, given back to the pool when it is destroyed. It converts to a cl_mem.
+///
+/// Ex : clppBuffer d_times(context->getBufferPool(), sizeof(float) * N);
+///
+/// \version 1.0
+class clppBuffer
+{
+public:
+	clppBuffer() : _pool(0), _clBuffer(0) {}
+	clppBuffer(clppBufferPool* pool, size_t bytes) : _pool(pool), _clBuffer(pool->acquire(bytes)) {}
+	~clppBuffer() { reset(); }
+
+	clppBuffer(clppBuffer&& other) : _pool(other._pool), _clBuffer(other._clBuffer) { other._clBuffer = 0; }
+	clppBuffer& operator=(clppBuffer&& other)
+	{
+		if (this != &other)
+		{
+			reset();
+			_pool = other._pool;
+			_clBuffer = other._clBuffer;
+			other._clBuffer = 0;
+		}
+		return *this;
+	}
+
+	clppBuffer(const clppBuffer&) = delete;
+	clppBuffer& operator=(const clppBuffer&) = delete;
+
+	/// Gives the buffer back to the pool
+	void reset()
+	{
+		if (_pool && _clBuffer)
+			_pool->release(_clBuffer);
+		_clBuffer = 0;
+	}
+
+	cl_mem get() const { return _clBuffer; }
+	operator cl_mem() const { return _clBuffer; }
+
+private:
+	clppBufferPool* _pool;
+	cl_mem _clBuffer;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,89 @@
+#ifndef __CLPP_COMPACT_H__
+#define __CLPP_COMPACT_H__
+
+#include "clpp/clppProgram.h"
+#include "clpp/clppOperator.h"
+#include "clpp/clppScan.h"
+#include "clpp/clppKernelLauncher.h"
+
+/// Stream compaction : write the selected elements of a data set, in order, into a dense buffer.
+///
+/// The elements are selected by a byte flag per element (ex : markNextEventByLP), or by a predicate
+/// compiled in the kernels. Without a value buffer, the indices of the selected elements are written,
+/// so the next kernel can be launched only over the active items.
+///
+/// \version 1.0
+class clppCompact : public clppProgram
+{
+public:
+	/// Create a compaction driven by a byte flag per element (see pushCLFlags)
+	///
+	/// \param valueSize	The size of a value in bytes, must be a multiple of 4
+	/// \param maxElements	The maximum number of elements
+	clppCompact(clppContext* context, size_t valueSize, clppIndex maxElements);
+
+	/// Create a compaction driven by a predicate on the values
+	///
+	/// \param type			The data type of the values
+	/// \param predicate	An expression of the value X, ex : "(X) <= 4.0f"
+	/// \param maxElements	The maximum number of elements
+	clppCompact(clppContext* context, clppDataType type, string predicate, clppIndex maxElements);
+	~clppCompact();
+
+	/// Returns the algorithm name
+	string getName() { return "Stream compaction"; }
+
+	/// Compact the pushed data set
+	void compact();
+
+	/// Push the values on the device
+	void pushDatas(void* values, size_t datasetSize);
+
+	/// Push values that are already on the device side. (Data are not sended)
+	/// With a null buffer, the indices of the selected elements are written (flag mode only).
+	void pushCLDatas(cl_mem clBuffer_values, size_t datasetSize);
+
+	/// Push the flags (one byte per element, 0 : not selected), already on the device side
+	void pushCLFlags(cl_mem clBuffer_flags);
+
+	/// Retreive the number of selected elements (blocking)
+	clppIndex popCount();
+
+	/// Retreive the selected elements (blocking), 'popCount' elements
+	void popDatas(void* dataSet);
+
+	/// Returns the device buffer holding the selected elements
+	cl_mem getCLResultBuffer() { return _clBuffer_output; }
+
+	/// Returns the device buffer holding the number of selected elements (clppIndex)
+	cl_mem getCLCountBuffer() { return _clBuffer_count; }
+
+	string compilePreprocess(string kernel);
+
+private:
+	void* _values;
+	size_t _datasetSize;
+	size_t _valueSize;
+
+	string _predicate;				// Empty in the flag mode
+	clppOperator _operator;			// The data type of the predicate mode
+
+	cl_mem _clBuffer_values;
+	cl_mem _clBuffer_flags;
+	bool _is_clBuffersOwner;
+
+	cl_mem _clBuffer_indices;		// The scanned flags : destination of each selected element
+	cl_mem _clBuffer_output;
+	cl_mem _clBuffer_count;
+
+	clppKernelLauncher<cl_mem, cl_mem, cl_mem, clppIndex> _kernel_Flags;
+	clppKernelLauncher<cl_mem, cl_mem, cl_mem, cl_mem, cl_mem, clppIndex, unsigned int> _kernel_Scatter;
+
+	size_t _workgroupSize;
+
+	clppScan* _scan;
+
+	void initialize(clppIndex maxElements);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+
+char clCode_clppCompact[]=
+"#pragma OPENCL EXTENSION cl_amd_printf : enable\n"
+"#if VALUE_WORDS == 1\n"
+"#define V uint\n"
+"#elif VALUE_WORDS == 2\n"
+"#define V uint2\n"
+"#elif VALUE_WORDS == 4\n"
+"#define V uint4\n"
+"#endif\n"
+"inline INDEX_T isSelected(__global const uint* values, __global const uchar* flags, const INDEX_T i)\n"
+"{\n"
+"#ifdef PREDICATE\n"
+"	T X = ((__global const T*)values)[i];\n"
+"	return (PREDICATE(X)) ? 1 : 0;\n"
+"#else\n"
+"	return (flags[i] != 0) ? 1 : 0;\n"
+"#endif\n"
+"}\n"
+"__kernel\n"
+"void kernel__compactFlags(\n"
+"	__global const uint* values,\n"
+"	__global const uchar* flags,\n"
+"	__global INDEX_T* indices,\n"
+"	const INDEX_T N)\n"
+"{\n"
+"	const INDEX_T gid = get_global_id(0);\n"
+"	if (gid >= N)\n"
+"		return;\n"
+"	indices[gid] = isSelected(values, flags, gid);\n"
+"}\n"
+"__kernel\n"
+"void kernel__compactScatter(\n"
+"	__global const uint* values,\n"
+"	__global const uchar* flags,\n"
+"	__global const INDEX_T* indices,\n"
+"	__global uint* output,\n"
+"	__global INDEX_T* count,\n"
+"	const INDEX_T N,\n"
+"	const uint outputIndices)\n"
+"{\n"
+"	const INDEX_T gid = get_global_id(0);\n"
+"	if (gid >= N)\n"
+"		return;\n"
+"	const INDEX_T selected = isSelected(values, flags, gid);\n"
+"	const INDEX_T dst = indices[gid];\n"
+"	if (gid == N - 1)\n"
+"		count[0] = dst + selected;\n"
+"	if (!selected)\n"
+"		return;\n"
+"	if (outputIndices)\n"
+"	{\n"
+"		((__global INDEX_T*)output)[dst] = gid;\n"
+"		return;\n"
+"	}\n"
+"#ifdef V\n"
+"	((__global V*)output)[dst] = ((__global const V*)values)[gid];\n"
+"#else\n"
+"	__global const uint* from = values + gid * VALUE_WORDS;\n"
+"	__global uint* to = output + dst * VALUE_WORDS;\n"
+"	for(uint i = 0; i < VALUE_WORDS; i++)\n"
+"		to[i] = from[i];\n"
+"#endif\n"
+"}\n"
+;
@@ -9,9 +9,15 @@
 
 enum clppVendor { Vendor_Unknown, Vendor_NVidia, Vendor_AMD, Vendor_Intel };
 
+class clppBufferPool;
+class clppProfiler;
+
 class clppContext
 {
 public:
+	clppContext();
+	~clppContext();
+
 	cl_context clContext;			// OpenCL context
 	cl_platform_id clPlatform;		// OpenCL Platform
 	cl_device_id clDevice;			// OpenCL Device
@@ -32,12 +38,22 @@ public:
 	// Print the information related to the context.
 	void printInformation();
 
+	// The device and pinned buffers shared by all the primitives of the context.
+	clppBufferPool* getBufferPool();
+
+	// The kernel profiler of the queue.
+	clppProfiler* getProfiler();
+
 	// Informations
 	bool isGPU;
 	bool isCPU;
+	bool isHostUnified;		// The device memory is the host memory (CPU, integrated GPU)
 	clppVendor Vendor;
 
 private:
+	clppBufferPool* _bufferPool;
+	clppProfiler* _profiler;
+
 	// Case-insensitive strstr() work-alike.
 	static char* stristr(const char *String, const char *Pattern);
 };
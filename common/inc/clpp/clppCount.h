@@ -7,50 +7,74 @@
 class clppCount : public clppProgram
 {
 public:
-	
+
 	// Create a new counting program.
-	// maxElements : the maximum number of elements to scan.
-	clppCount(clppContext* context, size_t valueSize, unsigned int countings, unsigned int maxElements);
+	// valueSize : the size of a value, 4 (uint) or 8 (ulong).
+	// countings : the number of bins. By default the bin of a value is the value itself, the values outside [0, countings[ are not counted.
+	// maxElements : the maximum number of elements to count.
+	clppCount(clppContext* context, size_t valueSize, unsigned int countings, clppIndex maxElements);
 	~clppCount();
 
 	// Returns the algorithm name
-	string getName();
+	string getName() { return "Counting"; }
 
 	// Start the counting operation
 	void count();
 
+	// Count arbitrary key values : the bin of a value is its index in 'keys' ('countings' values, copied on the device).
+	// The keys are sorted on the host side, then copied : beyond 16 keys, the bin of a value is found by a binary search.
+	// With 0, the bin of a value is the value itself.
+	void setKeys(void* keys);
+
 	// Send a Host data set to the device
 	void pushDatas(void* values, size_t datasetSize);
 
 	// Push a buffer that is already on the device side. (Data are not sended)
 	void pushCLDatas(cl_mem clBuffer_values, size_t datasetSize);
 
-	// Retreive the datas (To the same zone as the source).
-	void popDatas();
-	void popDatas(void* dataSet);
+	// Retreive the count of each bin ('countings' values).
+	void popDatas(clppIndex* countings);
+
+	// Returns the device buffer holding the count of each bin (clppIndex)
+	cl_mem getCLResultBuffer() { return _clBuffer_Countings; }
+
+	// Returns the device buffer holding the first position of each (bin, work-group), bin-major (ex : for a counting sort)
+	cl_mem getCLOffsetsBuffer() { return _clBuffer_CountingBlocks; }
+
+	string compilePreprocess(string kernel);
 
 protected:
-	size_t _datasetSize;	// The number of values to scan
+	size_t _datasetSize;	// The number of values to count
 
-	void* _values;			// The associated data set to scan
+	void* _values;			// The associated data set to count
 	size_t _valueSize;		// The size of a value in bytes
 
 	cl_mem _clBuffer_values;
 	bool _is_clBuffersOwner;
 
 	size_t _workgroupSize;
-	
+	size_t _workgroups;		// The number of work-groups of the local counting
+
 	// The number of parallel countings
 	unsigned int _countings;
 
-	// The temporary buffer used to count
+	// The keys of the bins, sorted, and the bin of each sorted key
+	cl_mem _clBuffer_keys;
+	cl_mem _clBuffer_keyBins;
+	bool _useKeys;
+
+	// The counters (and the keys) do not fit in local memory : each work-group counts in its row of '_clBuffer_counters'
+	bool _globalCounters;
+	cl_mem _clBuffer_counters;
+
+	// The temporary buffer used to count : the counters of each work-group, then their scan
 	cl_mem _clBuffer_CountingBlocks;
 
 	// The buffers that will contains the results
-	unsigned int* _countingsBuffer;
 	cl_mem _clBuffer_Countings;
 
-	cl_kernel _kernel_Count;
+	clppKernel _kernel_Count;
+	clppKernel _kernel_Totals;
 
 	clppScan* _scan;
 };
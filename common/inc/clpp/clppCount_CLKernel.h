@@ -0,0 +1,92 @@
+
+char clCode_clppCount[]=
+"#pragma OPENCL EXTENSION cl_amd_printf : enable\n"
+"__kernel\n"
+"void kernel__count(\n"
+"	__global const T* data,\n"
+"	__global const T* keys,\n"
+"	__global const uint* keyBins,\n"
+"	__global uint* groupCounters,\n"
+"	__global INDEX_T* blocks,\n"
+"	const INDEX_T N,\n"
+"	const uint useKeys)\n"
+"{\n"
+"	const uint lid = get_local_id(0);\n"
+"	const uint lsz = get_local_size(0);\n"
+"	const INDEX_T gid = get_global_id(0);\n"
+"	const INDEX_T gsz = get_global_size(0);\n"
+"	const uint groups = get_num_groups(0);\n"
+"#ifdef GLOBAL_COUNTERS\n"
+"	__global uint* counters = groupCounters + get_group_id(0) * COUNTINGS;\n"
+"	__global const T* binKeys = keys;\n"
+"	__global const uint* binOfKey = keyBins;\n"
+"	for(uint b = lid; b < COUNTINGS; b += lsz)\n"
+"		counters[b] = 0;\n"
+"	barrier(CLK_GLOBAL_MEM_FENCE);\n"
+"#else\n"
+"	__local uint counters[COUNTINGS];\n"
+"	__local T binKeys[COUNTINGS];\n"
+"	__local uint binOfKey[COUNTINGS];\n"
+"	for(uint b = lid; b < COUNTINGS; b += lsz)\n"
+"	{\n"
+"		counters[b] = 0;\n"
+"		if (useKeys)\n"
+"		{\n"
+"			binKeys[b] = keys[b];\n"
+"			binOfKey[b] = keyBins[b];\n"
+"		}\n"
+"	}\n"
+"	barrier(CLK_LOCAL_MEM_FENCE);\n"
+"#endif\n"
+"	for(INDEX_T i = gid; i < N; i += gsz)\n"
+"	{\n"
+"		const T value = data[i];\n"
+"		uint bin = COUNTINGS;\n"
+"		if (useKeys)\n"
+"		{\n"
+"#ifdef KEYS_BINARY_SEARCH\n"
+"			uint first = 0;\n"
+"			uint last = COUNTINGS;\n"
+"			while (first < last)\n"
+"			{\n"
+"				const uint middle = (first + last) >> 1;\n"
+"				if (binKeys[middle] < value)\n"
+"					first = middle + 1;\n"
+"				else\n"
+"					last = middle;\n"
+"			}\n"
+"			if (first < COUNTINGS && binKeys[first] == value)\n"
+"				bin = binOfKey[first];\n"
+"#else\n"
+"			for(uint b = 0; b < COUNTINGS; b++)\n"
+"				if (binKeys[b] == value) { bin = binOfKey[b]; break; }\n"
+"#endif\n"
+"		}\n"
+"		else if (value < COUNTINGS)\n"
+"			bin = (uint)value;\n"
+"		if (bin < COUNTINGS)\n"
+"			atomic_inc(&counters[bin]);\n"
+"	}\n"
+"#ifdef GLOBAL_COUNTERS\n"
+"	barrier(CLK_GLOBAL_MEM_FENCE);\n"
+"#else\n"
+"	barrier(CLK_LOCAL_MEM_FENCE);\n"
+"#endif\n"
+"	for(uint b = lid; b < COUNTINGS; b += lsz)\n"
+"		blocks[b * groups + get_group_id(0)] = counters[b];\n"
+"	// The last block is the total after the scan\n"
+"	if (gid == 0)\n"
+"		blocks[COUNTINGS * groups] = 0;\n"
+"}\n"
+"__kernel\n"
+"void kernel__countTotals(\n"
+"	__global const INDEX_T* blocks,\n"
+"	__global INDEX_T* countings,\n"
+"	const uint groups)\n"
+"{\n"
+"	const uint b = get_global_id(0);\n"
+"	if (b >= COUNTINGS)\n"
+"		return;\n"
+"	countings[b] = blocks[(b + 1) * groups] - blocks[b * groups];\n"
+"}\n"
+;
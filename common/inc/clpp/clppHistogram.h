@@ -0,0 +1,93 @@
+#ifndef __CLPP_HISTOGRAM_H__
+#define __CLPP_HISTOGRAM_H__
+
+#include "clpp/clppProgram.h"
+#include "clpp/clppOperator.h"
+
+enum clppHistogramBinning
+{
+	clppHistogram_Key,		// bin = value (integer types)
+	clppHistogram_Range,	// bins of equal width over a range, see setRange
+	clppHistogram_BitField	// bin = (value >> shift) & (bins - 1), see setBitField (integer types, bins is a power of 2)
+};
+
+/// Histogram of a data set on the device : each work-group counts in private bins (local memory),
+/// then the private histograms are merged.
+///
+/// Typical use : the distribution of the event times in a window, or the activity of the LPs.
+///
+/// \version 1.0
+class clppHistogram : public clppProgram
+{
+public:
+	/// Create a histogram with a built-in bin function
+	///
+	/// \param type			The data type of the values
+	/// \param bins			The number of bins
+	/// \param binning		The bin function
+	/// \param maxElements	The maximum number of elements
+	clppHistogram(clppContext* context, clppDataType type, unsigned int bins, clppHistogramBinning binning, unsigned int maxElements);
+
+	/// Create a histogram with a custom bin function
+	///
+	/// \param binFunction	An expression of the value X giving the bin, ex : "(uint)(X) % 7". It can use 'rangeMin',
+	///						'rangeScale' (see setRange) and 'shift' (see setBitField)
+	clppHistogram(clppContext* context, clppDataType type, unsigned int bins, string binFunction, unsigned int maxElements);
+	~clppHistogram();
+
+	/// Returns the algorithm name
+	string getName() { return "Histogram"; }
+
+	/// The range of the bins (clppHistogram_Range) : the values outside [minValue, maxValue[ are not counted
+	void setRange(float minValue, float maxValue);
+
+	/// The first bit of the bit-field (clppHistogram_BitField)
+	void setBitField(unsigned int shift);
+
+	/// Build the histogram of the pushed data set
+	void histogram();
+
+	/// Push the data on the device
+	void pushDatas(void* dataSet, size_t datasetSize);
+
+	/// Push a buffer that is already on the device side. (Data are not sended)
+	void pushCLDatas(cl_mem clBuffer_dataSet, size_t datasetSize);
+
+	/// Retreive the histogram ('bins' values)
+	void popDatas(unsigned int* histogram);
+
+	/// Returns the device buffer holding the histogram
+	cl_mem getCLResultBuffer() { return _clBuffer_histogram; }
+
+	string compilePreprocess(string kernel);
+
+private:
+	clppOperator _operator;			// The data type
+	unsigned int _bins;
+	string _binFunction;
+
+	float _rangeMin;
+	float _rangeScale;
+	unsigned int _shift;
+
+	void* _dataSet;
+	size_t _datasetSize;
+
+	cl_mem _clBuffer_dataSet;
+	bool _is_clBuffersOwner;
+
+	cl_mem _clBuffer_partials;		// The private histogram of each work-group
+	cl_mem _clBuffer_histogram;
+
+	clppKernel _kernel_Histogram;
+	clppKernel _kernel_Clear;
+	clppKernel _kernel_Merge;
+
+	size_t _workgroupSize;
+	size_t _maxWorkgroups;
+	bool _globalBins;				// The bins do not fit in local memory
+
+	void initialize();
+};
+
+#endif
\ No newline at end of file
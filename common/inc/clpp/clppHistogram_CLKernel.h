@@ -0,0 +1,61 @@
+
+char clCode_clppHistogram[]=
+"#pragma OPENCL EXTENSION cl_amd_printf : enable\n"
+"__kernel\n"
+"void kernel__histogram(\n"
+"	__global const T* data,\n"
+"	__global uint* partials,\n"
+"	const uint N,\n"
+"	const float rangeMin,\n"
+"	const float rangeScale,\n"
+"	const uint shift)\n"
+"{\n"
+"	const uint lid = get_local_id(0);\n"
+"	const uint lsz = get_local_size(0);\n"
+"	const uint gid = get_global_id(0);\n"
+"	const uint gsz = get_global_size(0);\n"
+"#ifdef GLOBAL_BINS\n"
+"	__global uint* bins = partials + get_group_id(0) * BINS;\n"
+"#else\n"
+"	__local uint bins[BINS];\n"
+"	for(uint b = lid; b < BINS; b += lsz)\n"
+"		bins[b] = 0;\n"
+"	barrier(CLK_LOCAL_MEM_FENCE);\n"
+"#endif\n"
+"	for(uint i = gid; i < N; i += gsz)\n"
+"	{\n"
+"		const T X = data[i];\n"
+"		const uint bin = BIN(X);\n"
+"		if (bin < BINS)\n"
+"			atomic_inc(&bins[bin]);\n"
+"	}\n"
+"#ifndef GLOBAL_BINS\n"
+"	barrier(CLK_LOCAL_MEM_FENCE);\n"
+"	for(uint b = lid; b < BINS; b += lsz)\n"
+"		partials[get_group_id(0) * BINS + b] = bins[b];\n"
+"#endif\n"
+"}\n"
+"__kernel\n"
+"void kernel__histogramClear(\n"
+"	__global uint* partials,\n"
+"	const uint count)\n"
+"{\n"
+"	const uint gid = get_global_id(0);\n"
+"	if (gid < count)\n"
+"		partials[gid] = 0;\n"
+"}\n"
+"__kernel\n"
+"void kernel__histogramMerge(\n"
+"	__global const uint* partials,\n"
+"	__global uint* histogram,\n"
+"	const uint groups)\n"
+"{\n"
+"	const uint b = get_global_id(0);\n"
+"	if (b >= BINS)\n"
+"		return;\n"
+"	uint sum = 0;\n"
+"	for(uint g = 0; g < groups; g++)\n"
+"		sum += partials[g * BINS + b];\n"
+"	histogram[b] = sum;\n"
+"}\n"
+;
@@ -0,0 +1,114 @@
+#ifndef __CLPP_KERNELLAUNCHER_H__
+#define __CLPP_KERNELLAUNCHER_H__
+
+#include "clpp/clppProgram.h"
+#include "clpp/clppProfiler.h"
+
+#include <cstring>
+#include <type_traits>
+
+/// A __local kernel argument : only its size in bytes is given. Ex : clppLocalMemory{ 256 * sizeof(cl_uint) }
+struct clppLocalMemory
+{
+	size_t size;
+};
+
+//---- The size and the address given to clSetKernelArg for an argument value
+template <typename T> inline size_t clppArgSize(const T&) { return sizeof(T); }
+template <typename T> inline const void* clppArgValue(const T& value) { return &value; }
+inline size_t clppArgSize(const clppLocalMemory& local) { return local.size; }
+inline const void* clppArgValue(const clppLocalMemory&) { return NULL; }
+
+//---- The total size of the argument types
+template <typename... T> struct clppArgsSize { static const size_t value = 0; };
+template <typename T, typename... Rest> struct clppArgsSize<T, Rest...> { static const size_t value = sizeof(T) + clppArgsSize<Rest...>::value; };
+
+/// Launch a kernel with typed arguments. 'Args' are the types of the kernel parameters, in order :
+/// cl_mem for the __global buffers, clppLocalMemory for the __local ones, and the host type of the values
+/// (cl_uint, cl_float, a struct...). The arguments are checked at compile time, the last bound values are
+/// kept, and only the arguments that changed since the last launch are set.
+///
+/// The launcher must be the only one to set the arguments of its kernel : to launch a kernel with two sets
+/// of arguments, use two launchers on two instances of the kernel (clppProgram::getKernel twice). The buffers
+/// are compared by handle : call 'reset' when a bound buffer is released and another one may reuse its handle.
+///
+/// Ex : clppKernelLauncher<cl_mem, cl_mem, cl_uint> launcher(context, getKernel("kernel__reduce"));
+///      launcher.launch(global, local, input, output, N);
+///
+/// \version 1.0
+template <typename... Args>
+class clppKernelLauncher
+{
+public:
+	clppKernelLauncher() : _context(0) { reset(); }
+	clppKernelLauncher(clppContext* context, clppKernel kernel) : _context(context), _kernel(kernel) { reset(); }
+
+	/// Set the changed arguments, then enqueue the kernel on the queue of the context (1 dimension), through its profiler.
+	/// A 'localSize' of 0 lets the driver choose.
+	cl_int launch(size_t globalSize, size_t localSize, const Args&... args)
+	{
+		return launch(0, NULL, NULL, globalSize, localSize, args...);
+	}
+
+	/// The same, after the events of 'waitList' : the event of the kernel is returned in 'event' (can be 0)
+	cl_int launch(cl_uint waitCount, const cl_event* waitList, cl_event* event, size_t globalSize, size_t localSize, const Args&... args)
+	{
+		cl_int clStatus = setArgs(args...);
+		if (clStatus != CL_SUCCESS)
+			return clStatus;
+
+		size_t global[1] = {globalSize};
+		size_t local[1] = {localSize};
+
+		return _context->getProfiler()->enqueueNDRangeKernel(_kernel, 1, NULL, global, (localSize > 0) ? local : NULL, waitCount, waitList, event);
+	}
+
+	/// Set the changed arguments only
+	cl_int setArgs(const Args&... args)
+	{
+		return setArg<0>(0, args...);
+	}
+
+	/// Forget the bound values : all the arguments are set by the next launch
+	void reset()
+	{
+		memset(_bound, 0, sizeof(_bound));
+	}
+
+	/// Returns the kernel
+	cl_kernel getKernel() { return _kernel; }
+
+private:
+	clppContext* _context;
+	clppKernel _kernel;
+
+	bool _bound[sizeof...(Args) + 1];							// The argument is set
+	unsigned char _values[clppArgsSize<Args...>::value + 1];	// The last bound values, packed
+
+	template <cl_uint I>
+	cl_int setArg(size_t)
+	{
+		return CL_SUCCESS;
+	}
+
+	template <cl_uint I, typename T, typename... Rest>
+	cl_int setArg(size_t offset, const T& value, const Rest&... rest)
+	{
+		static_assert(is_pod<T>::value, "A kernel argument is a plain value, a cl_mem or a clppLocalMemory");
+		static_assert(!is_pointer<T>::value || is_same<T, cl_mem>::value, "A host pointer is not a kernel argument : use a cl_mem");
+
+		if (!_bound[I] || memcmp(_values + offset, &value, sizeof(T)) != 0)
+		{
+			cl_int clStatus = clSetKernelArg(_kernel, I, clppArgSize(value), clppArgValue(value));
+			if (clStatus != CL_SUCCESS)
+				return clStatus;
+
+			memcpy(_values + offset, &value, sizeof(T));
+			_bound[I] = true;
+		}
+
+		return setArg<I + 1>(offset + sizeof(T), rest...);
+	}
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef __CLPP_MAPPEDBUFFER_H__
+#define __CLPP_MAPPEDBUFFER_H__
+
+#include <vector>
+
+#include "clpp/clppContext.h"
+
+using namespace std;
+
+/// Host access to a device buffer, for the time of the object (blocking).
+///
+/// On the host-unified devices (clppContext::isHostUnified) the buffer is mapped : the host works directly
+/// in the memory of the buffer, without copy. On the other devices it is read into host memory
+/// (CL_MAP_READ), and written back when the object is destroyed (CL_MAP_WRITE).
+///
+/// Ex : clppMappedBuffer events(context, d_events, sizeof(int) * N);
+///      int* counts = events.as<int>();
+///
+/// \version 1.0
+class clppMappedBuffer
+{
+public:
+	/// Map 'bytes' bytes of 'clBuffer', from 'offset'. 'flags' is a combination of CL_MAP_READ and CL_MAP_WRITE.
+	clppMappedBuffer(clppContext* context, cl_mem clBuffer, size_t bytes, cl_map_flags flags = CL_MAP_READ, size_t offset = 0);
+
+	/// Unmap the buffer, or write back the host copy
+	~clppMappedBuffer();
+
+	clppMappedBuffer(const clppMappedBuffer&) = delete;
+	clppMappedBuffer& operator=(const clppMappedBuffer&) = delete;
+
+	/// Returns the host address of the data
+	void* get() { return _data; }
+
+	template <typename T> T* as() { return (T*)_data; }
+
+	/// True when the buffer is mapped, false when the data are a host copy
+	bool isMapped() { return _mapped; }
+
+private:
+	clppContext* _context;
+	cl_mem _clBuffer;
+	size_t _bytes;
+	size_t _offset;
+	cl_map_flags _flags;
+
+	bool _mapped;
+	void* _data;
+	vector<char> _copy;			// The host copy, when the buffer is not mapped
+};
+
+#endif
\ No newline at end of file
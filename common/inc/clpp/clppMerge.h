@@ -0,0 +1,55 @@
+#ifndef __CLPP_MERGE_H__
+#define __CLPP_MERGE_H__
+
+#include "clpp/clppProgram.h"
+#include "clpp/clppSort.h"
+
+/// Merge two sorted runs that are already on the device (merge path).
+///
+/// Typical use : an event list is sorted once, then after each window only the modified events
+/// are sorted (sortAndMerge) and merged with the untouched sorted run, instead of re-sorting everything.
+///
+/// \version 1.0
+class clppMerge : public clppProgram
+{
+public:
+	/// Create a new merge
+	///
+	/// \param maxElements	The maximum number of merged elements (sizeA + sizeB)
+	/// \param bits			The bits used by the key (for the sort of the modified elements)
+	/// \param keysOnly		Keys only (uint) or Key-Values (uint2, key in x)
+	clppMerge(clppContext* context, unsigned int maxElements, unsigned int bits, bool keysOnly);
+	~clppMerge();
+
+	/// Returns the algorithm name
+	string getName() { return "Merge path"; }
+
+	/// Returns the sort of the modified elements (see sortAndMerge)
+	clppSort* getSort() { return _sort; }
+
+	/// Merge the sorted runs A and B into 'clBuffer_dataSetOut' (sizeA + sizeB elements).
+	/// The output buffer must not be one of the inputs.
+	void merge(cl_mem clBuffer_runA, size_t sizeA, cl_mem clBuffer_runB, size_t sizeB, cl_mem clBuffer_dataSetOut);
+
+	/// Sort the 'updatesSize' modified elements, then merge them with the sorted run.
+	/// 'clBuffer_updates' is used as sort buffer, so its content is lost.
+	void sortAndMerge(cl_mem clBuffer_sorted, size_t sortedSize, cl_mem clBuffer_updates, size_t updatesSize, cl_mem clBuffer_dataSetOut);
+
+	string compilePreprocess(string kernel);
+
+private:
+	bool _keysOnly;				// Key-Values or Keys-only
+
+	clppKernel _kernel_MergePartition;
+	clppKernel _kernel_MergeTile;
+
+	size_t _workgroupSize;
+	size_t _itemsPerWorkitem;
+
+	cl_mem _clBuffer_partitions;
+	size_t _partitionsSize;		// Capacity of '_clBuffer_partitions'
+
+	clppSort* _sort;			// Sort of the modified elements
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,99 @@
+
+char clCode_clppMerge[]=
+"#pragma OPENCL EXTENSION cl_amd_printf : enable\n"
+"#define TILE_SIZE (WORKGROUP_SIZE * ITEMS_PER_WORKITEM)\n"
+"#ifdef KEYS_ONLY\n"
+"#define KEY(DATA) (DATA)\n"
+"#else\n"
+"#define KEY(DATA) (DATA.x)\n"
+"#endif\n"
+"inline\n"
+"uint mergePathSearch_global(__global const KV_TYPE* A, uint sizeA, __global const KV_TYPE* B, uint sizeB, uint diagonal)\n"
+"{\n"
+"	uint low = (diagonal > sizeB) ? diagonal - sizeB : 0;\n"
+"	uint high = min(diagonal, sizeA);\n"
+"	while (low < high)\n"
+"	{\n"
+"		uint mid = (low + high) >> 1;\n"
+"		if (KEY(A[mid]) <= KEY(B[diagonal - 1 - mid]))\n"
+"			low = mid + 1;\n"
+"		else\n"
+"			high = mid;\n"
+"	}\n"
+"	return low;\n"
+"}\n"
+"inline\n"
+"uint mergePathSearch_local(__local const KV_TYPE* A, uint sizeA, __local const KV_TYPE* B, uint sizeB, uint diagonal)\n"
+"{\n"
+"	uint low = (diagonal > sizeB) ? diagonal - sizeB : 0;\n"
+"	uint high = min(diagonal, sizeA);\n"
+"	while (low < high)\n"
+"	{\n"
+"		uint mid = (low + high) >> 1;\n"
+"		if (KEY(A[mid]) <= KEY(B[diagonal - 1 - mid]))\n"
+"			low = mid + 1;\n"
+"		else\n"
+"			high = mid;\n"
+"	}\n"
+"	return low;\n"
+"}\n"
+"__kernel\n"
+"void kernel__mergePartition(\n"
+"	__global const KV_TYPE* A,\n"
+"	const uint sizeA,\n"
+"	__global const KV_TYPE* B,\n"
+"	const uint sizeB,\n"
+"	__global uint* partitions,\n"
+"	const uint partitionsCount)\n"
+"{\n"
+"	const uint gid = get_global_id(0);\n"
+"	if (gid >= partitionsCount)\n"
+"		return;\n"
+"	uint diagonal = min(gid * TILE_SIZE, sizeA + sizeB);\n"
+"	partitions[gid] = mergePathSearch_global(A, sizeA, B, sizeB, diagonal);\n"
+"}\n"
+"__kernel\n"
+"void kernel__mergeTile(\n"
+"	__global const KV_TYPE* A,\n"
+"	const uint sizeA,\n"
+"	__global const KV_TYPE* B,\n"
+"	const uint sizeB,\n"
+"	__global KV_TYPE* dataOut,\n"
+"	__global const uint* partitions)\n"
+"{\n"
+"	const uint tid = get_local_id(0);\n"
+"	const uint groupId = get_group_id(0);\n"
+"	__local KV_TYPE localData[TILE_SIZE];\n"
+"	//---- The ranges of A and B merged by this tile\n"
+"	const uint diagonal0 = groupId * TILE_SIZE;\n"
+"	const uint diagonal1 = min(diagonal0 + TILE_SIZE, sizeA + sizeB);\n"
+"	const uint a0 = partitions[groupId];\n"
+"	const uint a1 = partitions[groupId + 1];\n"
+"	const uint b0 = diagonal0 - a0;\n"
+"	const uint b1 = diagonal1 - a1;\n"
+"	const uint countA = a1 - a0;\n"
+"	const uint countB = b1 - b0;\n"
+"	//---- Load A then B in local memory\n"
+"	for(uint i = tid; i < countA; i += WORKGROUP_SIZE)\n"
+"		localData[i] = A[a0 + i];\n"
+"	for(uint i = tid; i < countB; i += WORKGROUP_SIZE)\n"
+"		localData[countA + i] = B[b0 + i];\n"
+"	barrier(CLK_LOCAL_MEM_FENCE);\n"
+"	__local const KV_TYPE* localA = localData;\n"
+"	__local const KV_TYPE* localB = localData + countA;\n"
+"	//---- Each work-item merges ITEMS_PER_WORKITEM elements from its own diagonal\n"
+"	const uint count = countA + countB;\n"
+"	const uint diagonal = min(tid * ITEMS_PER_WORKITEM, count);\n"
+"	uint i = mergePathSearch_local(localA, countA, localB, countB, diagonal);\n"
+"	uint j = diagonal - i;\n"
+"	__global KV_TYPE* output = dataOut + diagonal0 + diagonal;\n"
+"	#pragma unroll\n"
+"	for(uint k = 0; k < ITEMS_PER_WORKITEM; k++)\n"
+"	{\n"
+"		if (diagonal + k >= count)\n"
+"			break;\n"
+"		bool takeA = (j >= countB) || (i < countA && KEY(localA[i]) <= KEY(localB[j]));\n"
+"		output[k] = takeA ? localA[i++] : localB[j++];\n"
+"	}\n"
+"}\n"
+;
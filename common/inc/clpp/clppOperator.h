@@ -0,0 +1,57 @@
+#ifndef __CLPP_OPERATOR_H__
+#define __CLPP_OPERATOR_H__
+
+#include <string>
+
+using namespace std;
+
+enum clppDataType { clppDataType_Int, clppDataType_UInt, clppDataType_Float, clppDataType_UInt2, clppDataType_ULong, clppDataType_Double };
+
+// The data type of clppIndex (see clppProgram.h), for the scans of counts and destinations
+#ifdef CLPP_64BIT_INDEX
+#define clppDataType_Index clppDataType_ULong
+#else
+#define clppDataType_Index clppDataType_UInt
+#endif
+
+enum clppOperatorKind { clppOperator_Sum, clppOperator_Min, clppOperator_Max, clppOperator_Custom };
+
+/// An associative and commutative operator on a data type, used to specialize the kernels at compile time.
+///
+/// The kernels use the following macros :
+/// T							The data type
+/// OPERATOR_APPLY(A,B)			The operator
+/// OPERATOR_IDENTITY			The identity element of the operator
+///
+/// \version 1.0
+class clppOperator
+{
+public:
+	/// Create a built-in operator (the default is the sum of uint)
+	clppOperator(clppDataType type = clppDataType_UInt, clppOperatorKind kind = clppOperator_Sum);
+
+	/// Create a custom operator
+	///
+	/// \param apply		An expression of A and B, ex : "(A) * (B)"
+	/// \param identity		The identity element, ex : "1"
+	clppOperator(clppDataType type, string apply, string identity);
+
+	/// Returns the size of a value in bytes
+	size_t getValueSize() const;
+
+	/// Returns the OpenCL name of the data type
+	string getTypeName() const;
+
+	/// Returns the definitions of T, OPERATOR_APPLY and OPERATOR_IDENTITY
+	string getDefines() const;
+
+	/// Returns true when the type has OpenCL vector types (int4...)
+	bool isVectorizable() const { return type != clppDataType_UInt2; }
+
+	clppDataType type;
+	clppOperatorKind kind;
+	string apply;
+	string identity;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,200 @@
+#ifndef __CLPP_PROFILER_H__
+#define __CLPP_PROFILER_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "clpp/clppContext.h"
+
+using namespace std;
+
+/// The timestamps of a profiled command, in nanoseconds (CL_PROFILING_COMMAND_QUEUED/SUBMIT/START/END)
+struct clppProfileRecord
+{
+	size_t name;				// Index of the name, see clppProfiler::getName
+	cl_ulong queued;
+	cl_ulong submit;
+	cl_ulong start;
+	cl_ulong end;
+	cl_ulong hostQueued;		// The host time of the enqueue, on std::chrono::steady_clock
+};
+
+/// The statistics of a kernel, in microseconds
+struct clppKernelStats
+{
+	string name;
+	size_t count;
+	double totalTime;			// Sum of the execution times (START to END)
+	double meanTime;
+	double p50Time;
+	double p99Time;
+	double meanOverhead;		// Mean launch overhead (QUEUED to START)
+};
+
+/// Command profiler of a context, on the profiling events of its queue (CL_QUEUE_PROFILING_ENABLE).
+///
+/// The kernels and the transfers are enqueued through the 'enqueue' methods. When the profiler is disabled
+/// (default) they are direct calls to OpenCL. When it is enabled, an event is attached to every command and
+/// its timestamps are collected once the command is complete. Use clppContext::getProfiler() to get the
+/// profiler of a context.
+///
+/// The records are kept until 'reset' : beyond 'setMaxRecords' records (2^20 by default), the next
+/// commands are counted but not recorded. Call 'reset' between the phases of a long run.
+///
+/// Ex : context->getProfiler()->setEnabled(true);
+///      ...
+///      context->getProfiler()->printStats();
+///
+/// \version 1.0
+class clppProfiler
+{
+public:
+	clppProfiler(clppContext* context);
+	~clppProfiler();
+
+	/// Enable or disable the profiling. The queue must be created with CL_QUEUE_PROFILING_ENABLE.
+	void setEnabled(bool enabled);
+	bool isEnabled() { return _enabled; }
+
+	/// clEnqueueNDRangeKernel on the queue of the context, profiled when enabled
+	cl_int enqueueNDRangeKernel(cl_kernel kernel, cl_uint workDim, const size_t* globalOffset, const size_t* globalSize, const size_t* localSize,
+		cl_uint waitCount, const cl_event* waitList, cl_event* event)
+	{
+		if (!_enabled)
+			return clEnqueueNDRangeKernel(_context->clQueue, kernel, workDim, globalOffset, globalSize, localSize, waitCount, waitList, event);
+
+		cl_ulong hostQueued = getHostTime();
+		cl_event profileEvent;
+		cl_int clStatus = clEnqueueNDRangeKernel(_context->clQueue, kernel, workDim, globalOffset, globalSize, localSize, waitCount, waitList, &profileEvent);
+		return addEvent(clStatus, getKernelName(kernel), hostQueued, profileEvent, event);
+	}
+
+	/// clEnqueueReadBuffer on the queue of the context, profiled when enabled
+	cl_int enqueueReadBuffer(cl_mem clBuffer, cl_bool blocking, size_t offset, size_t bytes, void* data,
+		cl_uint waitCount, const cl_event* waitList, cl_event* event)
+	{
+		if (!_enabled)
+			return clEnqueueReadBuffer(_context->clQueue, clBuffer, blocking, offset, bytes, data, waitCount, waitList, event);
+
+		cl_ulong hostQueued = getHostTime();
+		cl_event profileEvent;
+		cl_int clStatus = clEnqueueReadBuffer(_context->clQueue, clBuffer, blocking, offset, bytes, data, waitCount, waitList, &profileEvent);
+		return addEvent(clStatus, getNameId("read buffer"), hostQueued, profileEvent, event);
+	}
+
+	/// clEnqueueWriteBuffer on the queue of the context, profiled when enabled
+	cl_int enqueueWriteBuffer(cl_mem clBuffer, cl_bool blocking, size_t offset, size_t bytes, const void* data,
+		cl_uint waitCount, const cl_event* waitList, cl_event* event)
+	{
+		if (!_enabled)
+			return clEnqueueWriteBuffer(_context->clQueue, clBuffer, blocking, offset, bytes, data, waitCount, waitList, event);
+
+		cl_ulong hostQueued = getHostTime();
+		cl_event profileEvent;
+		cl_int clStatus = clEnqueueWriteBuffer(_context->clQueue, clBuffer, blocking, offset, bytes, data, waitCount, waitList, &profileEvent);
+		return addEvent(clStatus, getNameId("write buffer"), hostQueued, profileEvent, event);
+	}
+
+	/// clEnqueueCopyBuffer on the queue of the context, profiled when enabled
+	cl_int enqueueCopyBuffer(cl_mem srcBuffer, cl_mem dstBuffer, size_t srcOffset, size_t dstOffset, size_t bytes,
+		cl_uint waitCount, const cl_event* waitList, cl_event* event)
+	{
+		if (!_enabled)
+			return clEnqueueCopyBuffer(_context->clQueue, srcBuffer, dstBuffer, srcOffset, dstOffset, bytes, waitCount, waitList, event);
+
+		cl_ulong hostQueued = getHostTime();
+		cl_event profileEvent;
+		cl_int clStatus = clEnqueueCopyBuffer(_context->clQueue, srcBuffer, dstBuffer, srcOffset, dstOffset, bytes, waitCount, waitList, &profileEvent);
+		return addEvent(clStatus, getNameId("copy buffer"), hostQueued, profileEvent, event);
+	}
+
+	/// clEnqueueMapBuffer on the queue of the context, profiled when enabled
+	void* enqueueMapBuffer(cl_mem clBuffer, cl_bool blocking, cl_map_flags flags, size_t offset, size_t bytes,
+		cl_uint waitCount, const cl_event* waitList, cl_event* event, cl_int* clStatus)
+	{
+		if (!_enabled)
+			return clEnqueueMapBuffer(_context->clQueue, clBuffer, blocking, flags, offset, bytes, waitCount, waitList, event, clStatus);
+
+		cl_ulong hostQueued = getHostTime();
+		cl_event profileEvent;
+		cl_int status;
+		void* data = clEnqueueMapBuffer(_context->clQueue, clBuffer, blocking, flags, offset, bytes, waitCount, waitList, &profileEvent, &status);
+		status = addEvent(status, getNameId("map buffer"), hostQueued, profileEvent, event);
+		if (clStatus)
+			*clStatus = status;
+		return data;
+	}
+
+	/// clEnqueueUnmapMemObject on the queue of the context, profiled when enabled
+	cl_int enqueueUnmapMemObject(cl_mem clBuffer, void* data, cl_uint waitCount, const cl_event* waitList, cl_event* event)
+	{
+		if (!_enabled)
+			return clEnqueueUnmapMemObject(_context->clQueue, clBuffer, data, waitCount, waitList, event);
+
+		cl_ulong hostQueued = getHostTime();
+		cl_event profileEvent;
+		cl_int clStatus = clEnqueueUnmapMemObject(_context->clQueue, clBuffer, data, waitCount, waitList, &profileEvent);
+		return addEvent(clStatus, getNameId("unmap buffer"), hostQueued, profileEvent, event);
+	}
+
+	/// Profile another command under 'name', enqueued just before : the event is retained by the profiler
+	void record(const string& name, cl_event event);
+
+	/// The host time in nanoseconds, on the clock of clppTimer (std::chrono::steady_clock)
+	static cl_ulong getHostTime();
+
+	/// Wait for the pending commands and collect their timestamps
+	void collect();
+
+	/// Returns the collected timestamps, in the order of the enqueues
+	const vector<clppProfileRecord>& getRecords();
+
+	/// Returns the name of a record
+	const string& getName(size_t name) { return _names[name]; }
+
+	/// Returns the statistics of each kernel and each kind of command, sorted by total time
+	vector<clppKernelStats> getStats();
+
+	/// Print the statistics of each kernel
+	void printStats();
+
+	/// Forget the collected timestamps
+	void reset();
+
+	/// Set the maximum number of kept records
+	void setMaxRecords(size_t maxRecords) { _maxRecords = maxRecords; }
+
+	/// Returns the number of commands not recorded since the last 'reset' (beyond the maximum number of records)
+	size_t getDroppedCount() { return _droppedCount; }
+
+private:
+	clppContext* _context;
+	bool _enabled;
+
+	vector<string> _names;							// The names of the kernels and the commands
+	map<string, size_t> _nameIds;
+	map<cl_kernel, size_t> _kernelNames;			// The name of each kernel, from CL_KERNEL_FUNCTION_NAME
+
+	// A command not collected yet
+	struct PendingCommand
+	{
+		size_t name;
+		cl_event event;
+		cl_ulong hostQueued;
+	};
+
+	vector<PendingCommand> _pending;						// In the order of the enqueues
+	size_t _firstPending;
+	vector<clppProfileRecord> _records;
+	size_t _maxRecords;
+	size_t _droppedCount;
+
+	cl_int addEvent(cl_int clStatus, size_t name, cl_ulong hostQueued, cl_event profileEvent, cl_event* event);
+
+	size_t getNameId(const string& name);
+	size_t getKernelName(cl_kernel kernel);
+	void collectCompleted(bool wait);
+};
+
+#endif
\ No newline at end of file
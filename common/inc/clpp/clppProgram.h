@@ -7,6 +7,8 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <map>
+#include <future>
 #include <stdexcept>
 #include <assert.h>
 #include <math.h>
@@ -24,8 +26,21 @@
 
 using namespace std;
 
+// The index type of the data sets (element counts, offsets) in scan, sort, count and compaction.
+// Build with CLPP_64BIT_INDEX for data sets of more than 2^32 elements : the kernels then receive
+// INDEX_T as ulong, otherwise as uint (the fastest on the devices).
+#ifdef CLPP_64BIT_INDEX
+typedef uint64_t clppIndex;
+#else
+typedef unsigned int clppIndex;
+#endif
+
+class clppKernel;
+
 class clppProgram
 {
+	friend class clppKernel;
+
 public:
 	clppProgram();
 	virtual ~clppProgram();
@@ -46,20 +61,99 @@ public:
 	// Set/Get the base path for all the OpenCL kernels.
 	static string getBasePath();
 	static void setBasePath(string basePath);
+
+	// Release the programs kept for the next compilations of the same source.
+	static void clearProgramCache();
+
+	// Set/Get the directory of the on-disk cache of the program binaries, shared by the next runs.
+	// Empty (the default) : no on-disk cache. The directory is created if needed.
+	static string getBinaryCachePath();
+	static void setBinaryCachePath(string path);
+
+	// Set/Get the build options of this program (ex : "-cl-mad-enable -I include"), used by the next 'compile'.
+	void setBuildOptions(string options);
+	string getBuildOptions();
+
+	// Set/Get the build options added to all the programs (ex : "-cl-fast-relaxed-math"), used by the next compilations.
+	static void setGlobalBuildOptions(string options);
+	static string getGlobalBuildOptions();
+
+	// Returns the kernel 'name' of this program, created on its first use (at the end of the build).
+	clppKernel getKernel(string name);
+
+	// Wait for the end of the build of this program. Returns false if the build has failed.
+	bool waitBuild();
+
+	// Set/Get the background builds : 'compile' returns at once, so the programs of all the primitives build
+	// in parallel, and the kernels wait for the build of their program on first use. Off by default.
+	static bool getAsyncBuild();
+	static void setAsyncBuild(bool async);
+
+	// Wait for the end of all the background builds
+	static void waitAllBuilds();
 	cl_program _clProgram;
 
 protected:
 	clppContext* _context;
 
+	string _buildOptions;	// Options added to the build of this program (set before 'compile')
+
+	static string _globalBuildOptions;
+
 	static string _basePath;
 
+	// The built programs, by context, device and preprocessed source
+	static map<string, cl_program> _programCache;
+
+	static string _binaryCachePath;
+
+	shared_future<int> _build;		// The background build of '_clProgram' (its cl_int status), if any
+
+	// The background builds, by program
+	static map<cl_program, shared_future<int> > _builds;
+	static bool _asyncBuild;
+
 protected:
 	static const char* getOpenCLErrorString(cl_int err);
 
+	// Build a program from its source, and save its binary in the on-disk cache (if 'binaryKey' is not empty)
+	static cl_int buildProgram(clppContext* context, cl_program program, string buildOptions, string binaryKey);
+
+	// Create a kernel, once the program is built
+	cl_kernel createKernel(string name);
+
+	// The on-disk cache of the program binaries, by device, driver, build options and preprocessed source
+	static string getBinaryKey(clppContext* context, string buildOptions, string programSource);
+	static cl_program loadProgramBinary(clppContext* context, string binaryKey);
+	static void saveProgramBinary(clppContext* context, cl_program program, string binaryKey);
+
 	static size_t toMultipleOf(size_t N, size_t base) 
 	{
 		return (ceil((double)N / (double)base) * base);
 	}
 };
 
+// A kernel of a program, created on its first use : the program may still be building in the background.
+// It converts to a cl_kernel.
+class clppKernel
+{
+public:
+	clppKernel() : _program(0), _kernel(0) {}
+	clppKernel(clppProgram* program, string name) : _program(program), _name(name), _kernel(0) {}
+	clppKernel(cl_kernel kernel) : _program(0), _kernel(kernel) {}
+
+	operator cl_kernel()
+	{
+		if (!_kernel && _program)
+			_kernel = _program->createKernel(_name);
+
+		return _kernel;
+	}
+
+private:
+	clppProgram* _program;
+	string _name;
+	cl_kernel _kernel;
+};
+
 #endif
@@ -0,0 +1,63 @@
+#ifndef __CLPP_REDUCE_H__
+#define __CLPP_REDUCE_H__
+
+#include "clpp/clppProgram.h"
+#include "clpp/clppOperator.h"
+#include "clpp/clppKernelLauncher.h"
+
+/// Reduce a data set to a single value (sum, min, max...) on the device.
+///
+/// Typical use : the LBTS (the min of the event times) or some statistics. The result stays on
+/// the device (getCLResultBuffer), so it can be used by the next kernels without a read-back.
+///
+/// \version 1.0
+class clppReduce : public clppProgram
+{
+public:
+	/// Create a new reduction
+	///
+	/// \param op			The data type and the operator, ex : clppOperator(clppDataType_Float, clppOperator_Min)
+	/// \param maxElements	The maximum number of elements to reduce
+	clppReduce(clppContext* context, const clppOperator& op, unsigned int maxElements);
+	~clppReduce();
+
+	/// Returns the algorithm name
+	string getName() { return "Reduction"; }
+
+	/// Reduce the pushed data set
+	void reduce();
+
+	/// Push the data on the device
+	void pushDatas(void* dataSet, size_t datasetSize);
+
+	/// Push a buffer that is already on the device side. (Data are not sended)
+	void pushCLDatas(cl_mem clBuffer_dataSet, size_t datasetSize);
+
+	/// Retreive the result (a single value, blocking)
+	void popDatas(void* result);
+
+	/// Returns the device buffer holding the result (a single value)
+	cl_mem getCLResultBuffer() { return _clBuffer_result; }
+
+	string compilePreprocess(string kernel);
+
+private:
+	clppOperator _operator;
+
+	void* _dataSet;
+	size_t _datasetSize;
+
+	cl_mem _clBuffer_dataSet;
+	bool _is_clBuffersOwner;
+
+	cl_mem _clBuffer_partials;	// One partial result per work-group of the first pass
+	cl_mem _clBuffer_result;
+
+	clppKernelLauncher<cl_mem, cl_mem, unsigned int> _kernel_Reduce;			// The first pass
+	clppKernelLauncher<cl_mem, cl_mem, unsigned int> _kernel_ReducePartials;	// The second pass, its own kernel instance
+
+	size_t _workgroupSize;
+	size_t _maxWorkgroups;		// The number of work-groups of the first pass
+};
+
+#endif
\ No newline at end of file
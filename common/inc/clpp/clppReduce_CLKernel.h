@@ -0,0 +1,52 @@
+
+char clCode_clppReduce[]=
+"#pragma OPENCL EXTENSION cl_amd_printf : enable\n"
+"#if defined(WORKGROUP_REDUCE) && defined(__OPENCL_C_VERSION__) && __OPENCL_C_VERSION__ >= 200\n"
+"#if __OPENCL_C_VERSION__ < 300 || defined(__opencl_c_work_group_collective_functions)\n"
+"#define USE_WORKGROUP_FUNCTIONS\n"
+"#endif\n"
+"#endif\n"
+"__kernel\n"
+"void kernel__reduce(\n"
+"	__global const T* data,\n"
+"	__global T* output,\n"
+"	const uint N)\n"
+"{\n"
+"	const uint tid = get_local_id(0);\n"
+"	const uint gid = get_global_id(0);\n"
+"	const uint gsz = get_global_size(0);\n"
+"	//---- 1) Each work-item reduces its elements\n"
+"	T value = OPERATOR_IDENTITY;\n"
+"#if VECTOR_WIDTH == 4\n"
+"	const uint N4 = N >> 2;\n"
+"	for(uint i = gid; i < N4; i += gsz)\n"
+"	{\n"
+"		T4 v = vload4(i, data);\n"
+"		value = OPERATOR_APPLY(value, OPERATOR_APPLY(OPERATOR_APPLY(v.x, v.y), OPERATOR_APPLY(v.z, v.w)));\n"
+"	}\n"
+"	// The last elements, when N is not a multiple of 4\n"
+"	for(uint i = (N4 << 2) + gid; i < N; i += gsz)\n"
+"		value = OPERATOR_APPLY(value, data[i]);\n"
+"#else\n"
+"	for(uint i = gid; i < N; i += gsz)\n"
+"		value = OPERATOR_APPLY(value, data[i]);\n"
+"#endif\n"
+"	//---- 2) Reduce the work-group\n"
+"#ifdef USE_WORKGROUP_FUNCTIONS\n"
+"	value = WORKGROUP_REDUCE(value);\n"
+"#else\n"
+"	__local T localData[WORKGROUP_SIZE];\n"
+"	localData[tid] = value;\n"
+"	barrier(CLK_LOCAL_MEM_FENCE);\n"
+"	for(uint s = WORKGROUP_SIZE >> 1; s > 0; s >>= 1)\n"
+"	{\n"
+"		if (tid < s)\n"
+"			localData[tid] = OPERATOR_APPLY(localData[tid], localData[tid + s]);\n"
+"		barrier(CLK_LOCAL_MEM_FENCE);\n"
+"	}\n"
+"	value = localData[0];\n"
+"#endif\n"
+"	if (tid == 0)\n"
+"		output[get_group_id(0)] = value;\n"
+"}\n"
+;
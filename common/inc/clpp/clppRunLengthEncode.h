@@ -0,0 +1,76 @@
+#ifndef __CLPP_RUNLENGTHENCODE_H__
+#define __CLPP_RUNLENGTHENCODE_H__
+
+#include "clpp/clppProgram.h"
+#include "clpp/clppOperator.h"
+#include "clpp/clppScan.h"
+
+/// Run-length encoding (unique by key) : the runs of equal consecutive keys give their unique key,
+/// their offset and their length.
+///
+/// Typical use : the event list of each LP, after a sort of the events by LP. The keys are of a scalar type.
+///
+/// \version 1.0
+class clppRunLengthEncode : public clppProgram
+{
+public:
+	/// Create a new run-length encoding
+	///
+	/// \param type			The data type of the keys
+	/// \param maxElements	The maximum number of keys
+	clppRunLengthEncode(clppContext* context, clppDataType type, clppIndex maxElements);
+	~clppRunLengthEncode();
+
+	/// Returns the algorithm name
+	string getName() { return "Run-length encoding"; }
+
+	/// Encode the pushed keys
+	void encode();
+
+	/// Push the keys on the device
+	void pushDatas(void* keys, size_t datasetSize);
+
+	/// Push keys that are already on the device side. (Data are not sended)
+	void pushCLDatas(cl_mem clBuffer_keys, size_t datasetSize);
+
+	/// Retreive the number of runs (blocking)
+	clppIndex popCount();
+
+	/// Retreive the runs (blocking), 'popCount' values each. Any pointer can be 0.
+	void popDatas(void* uniqueKeys, clppIndex* offsets, clppIndex* lengths);
+
+	/// Returns the device buffers holding the unique keys, the offsets (clppIndex) and the lengths (clppIndex) of the runs
+	cl_mem getCLUniqueKeysBuffer() { return _clBuffer_uniqueKeys; }
+	cl_mem getCLOffsetsBuffer() { return _clBuffer_offsets; }
+	cl_mem getCLLengthsBuffer() { return _clBuffer_lengths; }
+
+	/// Returns the device buffer holding the number of runs (clppIndex)
+	cl_mem getCLCountBuffer() { return _clBuffer_count; }
+
+	string compilePreprocess(string kernel);
+
+private:
+	clppOperator _operator;			// The data type of the keys
+
+	void* _keys;
+	size_t _datasetSize;
+
+	cl_mem _clBuffer_keys;
+	bool _is_clBuffersOwner;
+
+	cl_mem _clBuffer_indices;		// The scanned flags : the run of each first element
+	cl_mem _clBuffer_uniqueKeys;
+	cl_mem _clBuffer_offsets;
+	cl_mem _clBuffer_lengths;
+	cl_mem _clBuffer_count;
+
+	clppKernel _kernel_Flags;
+	clppKernel _kernel_Scatter;
+	clppKernel _kernel_Lengths;
+
+	size_t _workgroupSize;
+
+	clppScan* _scan;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,55 @@
+
+char clCode_clppRunLengthEncode[]=
+"#pragma OPENCL EXTENSION cl_amd_printf : enable\n"
+"__kernel\n"
+"void kernel__rleFlags(\n"
+"	__global const T* keys,\n"
+"	__global INDEX_T* indices,\n"
+"	const INDEX_T N)\n"
+"{\n"
+"	const INDEX_T gid = get_global_id(0);\n"
+"	if (gid >= N)\n"
+"		return;\n"
+"	indices[gid] = (gid == 0 || keys[gid] != keys[gid - 1]) ? 1 : 0;\n"
+"}\n"
+"__kernel\n"
+"void kernel__rleScatter(\n"
+"	__global const T* keys,\n"
+"	__global const INDEX_T* indices,\n"
+"	__global T* uniqueKeys,\n"
+"	__global INDEX_T* offsets,\n"
+"	__global INDEX_T* lengths,\n"
+"	__global INDEX_T* runs,\n"
+"	const INDEX_T N)\n"
+"{\n"
+"	const INDEX_T gid = get_global_id(0);\n"
+"	if (gid >= N)\n"
+"		return;\n"
+"	const T key = keys[gid];\n"
+"	const INDEX_T head = (gid == 0 || key != keys[gid - 1]) ? 1 : 0;\n"
+"	const INDEX_T run = indices[gid] + head - 1;\n"
+"	if (head)\n"
+"	{\n"
+"		uniqueKeys[run] = key;\n"
+"		offsets[run] = gid;\n"
+"	}\n"
+"	if (gid == N - 1)\n"
+"	{\n"
+"		lengths[run] = N;\n"
+"		runs[0] = run + 1;\n"
+"	}\n"
+"	else if (key != keys[gid + 1])\n"
+"		lengths[run] = gid + 1;\n"
+"}\n"
+"__kernel\n"
+"void kernel__rleLengths(\n"
+"	__global const INDEX_T* offsets,\n"
+"	__global INDEX_T* lengths,\n"
+"	__global const INDEX_T* runs)\n"
+"{\n"
+"	const INDEX_T gid = get_global_id(0);\n"
+"	if (gid >= runs[0])\n"
+"		return;\n"
+"	lengths[gid] -= offsets[gid];\n"
+"}\n"
+;
@@ -2,14 +2,15 @@
 #define __CLPP_SCAN_H__
 
 #include "clpp/clppProgram.h"
+#include "clpp/clppOperator.h"
 
 class clppScan : public clppProgram
 {
 public:
 	
-	// Create a new scan.
+	// Create a new scan : a sum, of uint unless the implementation sets another type.
 	// maxElements : the maximum number of elements to scan.
-	clppScan(clppContext* context, size_t valueSize, unsigned int maxElements)
+	clppScan(clppContext* context, size_t valueSize, clppIndex maxElements)
 	{
 		_values = 0;
 		_context = context;
@@ -20,6 +21,20 @@ public:
 		_is_clBuffersOwner = false;
 	}
 
+	// Create a new scan, specialized for a data type and an associative operator.
+	// maxElements : the maximum number of elements to scan.
+	clppScan(clppContext* context, const clppOperator& op, clppIndex maxElements)
+	{
+		_values = 0;
+		_context = context;
+		_operator = op;
+		_valueSize = op.getValueSize();
+		_datasetSize = 0;
+		_clBuffer_values = 0;
+		_workgroupSize = 0;
+		_is_clBuffersOwner = false;
+	}
+
 	// Returns the algorithm name
 	virtual string getName() = 0;
 
@@ -36,12 +51,17 @@ public:
 	virtual void popDatas() = 0;
 	virtual void popDatas(void* dataSet) = 0;
 
+	// Prepend the definitions of the data type and the operator to the kernels
+	string compilePreprocess(string kernel) { return clppProgram::compilePreprocess(_operator.getDefines() + kernel); }
+
 protected:
 	size_t _datasetSize;	// The number of values to scan
 
 	void* _values;			// The associated data set to scan
 	size_t _valueSize;		// The size of a value in bytes
 
+	clppOperator _operator;	// The data type and the operator of the scan
+
 	cl_mem _clBuffer_values;
 	bool _is_clBuffersOwner;
 
@@ -0,0 +1,44 @@
+#ifndef __CLPP_SCAN_CHAINED_H__
+#define __CLPP_SCAN_CHAINED_H__
+
+#include "clpp/clppScan.h"
+
+// Single-pass scan (chained scan with decoupled look-back) : the data set is read and written once.
+class clppScan_Chained : public clppScan
+{
+public:
+	clppScan_Chained(clppContext* context, size_t valueSize, clppIndex maxElements);
+	clppScan_Chained(clppContext* context, const clppOperator& op, clppIndex maxElements);
+	~clppScan_Chained();
+
+	string getName() { return "Prefix sum (exclusive), single pass"; }
+
+	// Returns true when the device can run the single-pass scan (the work-groups must run concurrently :
+	// GPU devices with the global atomics of OpenCL 1.1). Otherwise use the multi-level scans.
+	static bool isSupported(clppContext* context);
+
+	void scan();
+
+	void pushDatas(void* values, size_t datasetSize);
+	void pushCLDatas(cl_mem clBuffer_values, size_t datasetSize);
+
+	void popDatas();
+	void popDatas(void* dataSet);
+
+	string compilePreprocess(string kernel);
+
+private:
+	clppKernel _kernel_Init;
+	clppKernel _kernel_Scan;
+
+	size_t _itemsPerWorkitem;
+
+	cl_mem _clBuffer_status;		// The status of each tile (nothing, aggregate, inclusive prefix)
+	cl_mem _clBuffer_aggregates;
+	cl_mem _clBuffer_prefixes;
+	cl_mem _clBuffer_tileCounter;
+
+	void initialize(clppIndex maxElements);
+};
+
+#endif
\ No newline at end of file
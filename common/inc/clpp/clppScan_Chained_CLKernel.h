@@ -0,0 +1,145 @@
+
+char clCode_clppScan_Chained[]=
+"#pragma OPENCL EXTENSION cl_amd_printf : enable\n"
+"#define TILE_SIZE (WORKGROUP_SIZE * ITEMS)\n"
+"#define STATUS_X 0		// Nothing published\n"
+"#define STATUS_A 1		// The aggregate of the tile\n"
+"#define STATUS_P 2		// The inclusive prefix of the tile\n"
+"#define SPIN_LIMIT 100000\n"
+"__kernel\n"
+"void kernel__chainedInit(\n"
+"	__global uint* status,\n"
+"	__global uint* tileCounter,\n"
+"	const uint tiles)\n"
+"{\n"
+"	const uint gid = get_global_id(0);\n"
+"	if (gid < tiles)\n"
+"		status[gid] = STATUS_X;\n"
+"	if (gid == 0)\n"
+"		tileCounter[0] = 0;\n"
+"}\n"
+"inline T reduce_tile_serial(volatile __global T* data, const uint tile, const INDEX_T N)\n"
+"{\n"
+"	const INDEX_T start = (INDEX_T)tile * TILE_SIZE;\n"
+"	const INDEX_T end = min(start + TILE_SIZE, N);\n"
+"	T value = OPERATOR_IDENTITY;\n"
+"	for(INDEX_T i = start; i < end; i++)\n"
+"		value = OPERATOR_APPLY(value, data[i]);\n"
+"	return value;\n"
+"}\n"
+"__kernel\n"
+"void kernel__chainedScan(\n"
+"	volatile __global T* data,\n"
+"	volatile __global uint* status,\n"
+"	volatile __global T* aggregates,\n"
+"	volatile __global T* prefixes,\n"
+"	__global uint* tileCounter,\n"
+"	const INDEX_T N)\n"
+"{\n"
+"	const uint lid = get_local_id(0);\n"
+"	__local T tileData[TILE_SIZE];\n"
+"	__local T sums[WORKGROUP_SIZE];\n"
+"	__local uint tileId;\n"
+"	__local T tileExclusive;\n"
+"	//---- 1) Take the next tile\n"
+"	if (lid == 0)\n"
+"		tileId = atomic_inc(tileCounter);\n"
+"	barrier(CLK_LOCAL_MEM_FENCE);\n"
+"	const uint tile = tileId;\n"
+"	const INDEX_T base = (INDEX_T)tile * TILE_SIZE;\n"
+"	// Coalesced load\n"
+"	for(uint k = 0; k < ITEMS; k++)\n"
+"	{\n"
+"		const uint i = k * WORKGROUP_SIZE + lid;\n"
+"		tileData[i] = (base + i < N) ? data[base + i] : OPERATOR_IDENTITY;\n"
+"	}\n"
+"	barrier(CLK_LOCAL_MEM_FENCE);\n"
+"	//---- 2) Reduce the tile : each work-item reduces ITEMS consecutive elements, then a scan of the work-items\n"
+"	T value = OPERATOR_IDENTITY;\n"
+"	for(uint k = 0; k < ITEMS; k++)\n"
+"		value = OPERATOR_APPLY(value, tileData[lid * ITEMS + k]);\n"
+"	sums[lid] = value;\n"
+"	barrier(CLK_LOCAL_MEM_FENCE);\n"
+"	for(uint offset = 1; offset < WORKGROUP_SIZE; offset <<= 1)\n"
+"	{\n"
+"		T left = (lid >= offset) ? sums[lid - offset] : OPERATOR_IDENTITY;\n"
+"		barrier(CLK_LOCAL_MEM_FENCE);\n"
+"		if (lid >= offset)\n"
+"			sums[lid] = OPERATOR_APPLY(left, sums[lid]);\n"
+"		barrier(CLK_LOCAL_MEM_FENCE);\n"
+"	}\n"
+"	const T itemExclusive = (lid > 0) ? sums[lid - 1] : OPERATOR_IDENTITY;\n"
+"	//---- 3) Publish, look back, publish the inclusive prefix\n"
+"	if (lid == 0)\n"
+"	{\n"
+"		const T aggregate = sums[WORKGROUP_SIZE - 1];\n"
+"		T exclusive = OPERATOR_IDENTITY;\n"
+"		if (tile == 0)\n"
+"		{\n"
+"			prefixes[0] = aggregate;\n"
+"			write_mem_fence(CLK_GLOBAL_MEM_FENCE);\n"
+"			atomic_xchg(&status[0], STATUS_P);\n"
+"		}\n"
+"		else\n"
+"		{\n"
+"			aggregates[tile] = aggregate;\n"
+"			write_mem_fence(CLK_GLOBAL_MEM_FENCE);\n"
+"			atomic_xchg(&status[tile], STATUS_A);\n"
+"			int i = tile - 1;\n"
+"			uint spins = 0;\n"
+"			while (i >= 0)\n"
+"			{\n"
+"				uint s = atomic_or(&status[i], 0);\n"
+"				if (s == STATUS_X && ++spins < SPIN_LIMIT)\n"
+"					continue;\n"
+"				read_mem_fence(CLK_GLOBAL_MEM_FENCE);\n"
+"				if (s == STATUS_X)\n"
+"				{\n"
+"					// Fallback : reduce the input of the tile, kept if the tile is still not published\n"
+"					T fallback = reduce_tile_serial(data, i, N);\n"
+"					read_mem_fence(CLK_GLOBAL_MEM_FENCE);\n"
+"					s = atomic_or(&status[i], 0);\n"
+"					read_mem_fence(CLK_GLOBAL_MEM_FENCE);\n"
+"					if (s == STATUS_X)\n"
+"					{\n"
+"						exclusive = OPERATOR_APPLY(fallback, exclusive);\n"
+"						i--;\n"
+"						spins = 0;\n"
+"						continue;\n"
+"					}\n"
+"				}\n"
+"				spins = 0;\n"
+"				if (s == STATUS_P)\n"
+"				{\n"
+"					exclusive = OPERATOR_APPLY(prefixes[i], exclusive);\n"
+"					break;\n"
+"				}\n"
+"				exclusive = OPERATOR_APPLY(aggregates[i], exclusive);\n"
+"				i--;\n"
+"			}\n"
+"			prefixes[tile] = OPERATOR_APPLY(exclusive, aggregate);\n"
+"			write_mem_fence(CLK_GLOBAL_MEM_FENCE);\n"
+"			atomic_xchg(&status[tile], STATUS_P);\n"
+"		}\n"
+"		tileExclusive = exclusive;\n"
+"	}\n"
+"	barrier(CLK_LOCAL_MEM_FENCE);\n"
+"	//---- 4) Scan the tile\n"
+"	T running = OPERATOR_APPLY(tileExclusive, itemExclusive);\n"
+"	for(uint k = 0; k < ITEMS; k++)\n"
+"	{\n"
+"		const uint i = lid * ITEMS + k;\n"
+"		const T v = tileData[i];\n"
+"		tileData[i] = running;\n"
+"		running = OPERATOR_APPLY(running, v);\n"
+"	}\n"
+"	barrier(CLK_LOCAL_MEM_FENCE);\n"
+"	// Coalesced store\n"
+"	for(uint k = 0; k < ITEMS; k++)\n"
+"	{\n"
+"		const uint i = k * WORKGROUP_SIZE + lid;\n"
+"		if (base + i < N)\n"
+"			data[base + i] = tileData[i];\n"
+"	}\n"
+"}\n"
+;
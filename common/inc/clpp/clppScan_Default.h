@@ -6,7 +6,8 @@
 class clppScan_Default : public clppScan
 {
 public:
-	clppScan_Default(clppContext* context, size_t valueSize, unsigned int maxElements);
+	clppScan_Default(clppContext* context, size_t valueSize, clppIndex maxElements);
+	clppScan_Default(clppContext* context, const clppOperator& op, clppIndex maxElements);
 	~clppScan_Default();
 
 	string getName() { return "Prefix sum (exclusive)"; }
@@ -20,9 +21,9 @@ public:
 	void popDatas(void* dataSet);
 
 private:
-	cl_kernel _kernel_Scan;
-	cl_kernel _kernel_ScanSmall;
-	cl_kernel _kernel_UniformAdd;
+	clppKernel _kernel_Scan;
+	clppKernel _kernel_ScanSmall;
+	clppKernel _kernel_UniformAdd;
 
 	cl_mem _clBuffer_Temp;
 
@@ -30,9 +31,10 @@ private:
 
 	int _pass;
 	cl_mem* _clBuffer_BlockSums;
-	unsigned int* _blockSumsSizes;
+	clppIndex* _blockSumsSizes;
 
-	void allocateBlockSums(unsigned int maxElements);
+	void initialize(clppIndex maxElements);
+	void allocateBlockSums(clppIndex maxElements);
 	void freeBlockSums();
 };
 
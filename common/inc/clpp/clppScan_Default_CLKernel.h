@@ -1,7 +1,6 @@
 
 char clCode_clppScan_Default[]=
 "#pragma OPENCL EXTENSION cl_amd_printf : enable\n"
-"#define T int\n"
 "__kernel \n"
 "void kernel__ExclusivePrefixScanSmall(\n"
 "	__global T* input,\n"
@@ -23,12 +22,12 @@ char clCode_clppScan_Default[]=
 "			int ai = offset*(2*tid + 1) - 1;\n"
 "			int bi = offset*(2*tid + 2) - 1;\n"
 "			\n"
-"			block[bi] += block[ai];\n"
+"			block[bi] = OPERATOR_APPLY(block[bi], block[ai]);\n"
 "		}\n"
 "		offset *= 2;\n"
 "	}\n"
 "	if(tid == 0)\n"
-"		block[length - 1] = 0;\n"
+"		block[length - 1] = OPERATOR_IDENTITY;\n"
 "	for(int d = 1; d < length ; d *= 2)\n"
 "	{\n"
 "		offset >>=1;\n"
@@ -39,9 +38,9 @@ char clCode_clppScan_Default[]=
 "			int ai = offset*(2*tid + 1) - 1;\n"
 "			int bi = offset*(2*tid + 2) - 1;\n"
 "			\n"
-"			float t = block[ai];\n"
+"			T t = block[ai];\n"
 "			block[ai] = block[bi];\n"
-"			block[bi] += t;\n"
+"			block[bi] = OPERATOR_APPLY(block[bi], t);\n"
 "		}\n"
 "	}\n"
 "	\n"
@@ -63,10 +62,10 @@ char clCode_clppScan_Default[]=
 "	__local T* localBuffer,\n"
 "	\n"
 "	__global T* blockSums,\n"
-"	const uint blockSumsSize\n"
+"	const INDEX_T blockSumsSize\n"
 "	)\n"
 "{\n"
-"	const uint gid = get_global_id(0);\n"
+"	const INDEX_T gid = get_global_id(0);\n"
 "	const uint tid = get_local_id(0);\n"
 "	const uint bid = get_group_id(0);\n"
 "	const uint lwz  = get_local_size(0);\n"
@@ -78,21 +77,21 @@ char clCode_clppScan_Default[]=
 "const int tid2_0 = tid << 1;\n"
 "const int tid2_1 = tid2_0 + 1;\n"
 "	\n"
-"	const int gid2_0 = gid << 1;\n"
-"const int gid2_1 = gid2_0 + 1;\n"
+"	const INDEX_T gid2_0 = gid << 1;\n"
+"const INDEX_T gid2_1 = gid2_0 + 1;\n"
 "	// Cache the datas in local memory\n"
 "#ifdef SUPPORT_AVOID_BANK_CONFLICT\n"
 "	uint ai = tid;\n"
 "	uint bi = tid + lwz;\n"
-"	uint gai = gid;\n"
-"	uint gbi = gid + lwz;\n"
+"	INDEX_T gai = gid;\n"
+"	INDEX_T gbi = gid + lwz;\n"
 "	uint bankOffsetA = CONFLICT_FREE_OFFSET(ai); \n"
 "	uint bankOffsetB = CONFLICT_FREE_OFFSET(bi);\n"
-"	localBuffer[ai + bankOffsetA] = (gai < blockSumsSize) ? dataSet[gai] : 0; \n"
-"	localBuffer[bi + bankOffsetB] = (gbi < blockSumsSize) ? dataSet[gbi] : 0;\n"
+"	localBuffer[ai + bankOffsetA] = (gai < blockSumsSize) ? dataSet[gai] : OPERATOR_IDENTITY; \n"
+"	localBuffer[bi + bankOffsetB] = (gbi < blockSumsSize) ? dataSet[gbi] : OPERATOR_IDENTITY;\n"
 "#else\n"
-"	localBuffer[tid2_0] = (gid2_0 < blockSumsSize) ? dataSet[gid2_0] : 0;\n"
-"	localBuffer[tid2_1] = (gid2_1 < blockSumsSize) ? dataSet[gid2_1] : 0;\n"
+"	localBuffer[tid2_0] = (gid2_0 < blockSumsSize) ? dataSet[gid2_0] : OPERATOR_IDENTITY;\n"
+"	localBuffer[tid2_1] = (gid2_1 < blockSumsSize) ? dataSet[gid2_1] : OPERATOR_IDENTITY;\n"
 "#endif\n"
 "	\n"
 "for(uint d = lwz; d > 0; d >>= 1)\n"
@@ -112,7 +111,7 @@ char clCode_clppScan_Default[]=
 "const uint ai = mad24(offset, (tid2_1+0), -1);	// offset*(tid2_0+1)-1 = offset*(tid2_1+0)-1\n"
 "const uint bi = mad24(offset, (tid2_1+1), -1);	// offset*(tid2_1+1)-1;\n"
 "#endif\n"
-"localBuffer[bi] += localBuffer[ai];\n"
+"localBuffer[bi] = OPERATOR_APPLY(localBuffer[bi], localBuffer[ai]);\n"
 "}\n"
 "offset <<= 1;\n"
 "}\n"
@@ -134,13 +133,13 @@ char clCode_clppScan_Default[]=
 "		uint index = localBufferSize-1;\n"
 "		index += CONFLICT_FREE_OFFSET(index);\n"
 "		blockSums[bid] = localBuffer[index];\n"
-"		localBuffer[index] = 0;\n"
+"		localBuffer[index] = OPERATOR_IDENTITY;\n"
 "#else\n"
 "		// We store the biggest value (the last) to the sum-block for later use.\n"
 "blockSums[bid] = localBuffer[localBufferSize-1];		\n"
 "		//barrier(CLK_LOCAL_MEM_FENCE | CLK_GLOBAL_MEM_FENCE);		\n"
 "		// Clear the last element\n"
-"localBuffer[localBufferSize - 1] = 0;\n"
+"localBuffer[localBufferSize - 1] = OPERATOR_IDENTITY;\n"
 "#endif\n"
 "}\n"
 "for(uint d = 1; d < localBufferSize; d <<= 1)\n"
@@ -163,14 +162,16 @@ char clCode_clppScan_Default[]=
 "#endif\n"
 "T tmp = localBuffer[ai];\n"
 "localBuffer[ai] = localBuffer[bi];\n"
-"localBuffer[bi] += tmp;\n"
+"localBuffer[bi] = OPERATOR_APPLY(localBuffer[bi], tmp);\n"
 "}\n"
 "}\n"
 "barrier(CLK_LOCAL_MEM_FENCE);\n"
 "	\n"
 "#ifdef SUPPORT_AVOID_BANK_CONFLICT\n"
-"	dataSet[gai] = (gai < blockSumsSize) * localBuffer[ai + bankOffsetA];		\n"
-"	dataSet[gbi] = (gbi < blockSumsSize) * localBuffer[bi + bankOffsetB];		\n"
+"	if (gai < blockSumsSize)\n"
+"		dataSet[gai] = localBuffer[ai + bankOffsetA];\n"
+"	if (gbi < blockSumsSize)\n"
+"		dataSet[gbi] = localBuffer[bi + bankOffsetB];\n"
 "#else\n"
 "	if (gid2_0 < blockSumsSize)\n"
 "		dataSet[gid2_0] = localBuffer[tid2_0];\n"
@@ -182,10 +183,10 @@ char clCode_clppScan_Default[]=
 "void kernel__UniformAdd(\n"
 "	__global T* output,\n"
 "	__global const T* blockSums,\n"
-"	const uint outputSize\n"
+"	const INDEX_T outputSize\n"
 "	)\n"
 "{\n"
-"uint gid = get_global_id(0) * 2;\n"
+"INDEX_T gid = (INDEX_T)get_global_id(0) * 2;\n"
 "const uint tid = get_local_id(0);\n"
 "const uint blockId = get_group_id(0);\n"
 "	\n"
@@ -204,16 +205,17 @@ char clCode_clppScan_Default[]=
 "barrier(CLK_LOCAL_MEM_FENCE);\n"
 "	\n"
 "#ifdef SUPPORT_AVOID_BANK_CONFLICT\n"
-"	unsigned int address = blockId * get_local_size(0) * 2 + get_local_id(0); \n"
+"	INDEX_T address = (INDEX_T)blockId * get_local_size(0) * 2 + get_local_id(0); \n"
 "	\n"
-"	output[address] += localBuffer[0];\n"
-"output[address + get_local_size(0)] += (get_local_id(0) + get_local_size(0) < outputSize) * localBuffer[0];\n"
+"	output[address] = OPERATOR_APPLY(output[address], localBuffer[0]);\n"
+"	if (get_local_id(0) + get_local_size(0) < outputSize)\n"
+"		output[address + get_local_size(0)] = OPERATOR_APPLY(output[address + get_local_size(0)], localBuffer[0]);\n"
 "#else\n"
 "	if (gid < outputSize)\n"
-"		output[gid] += localBuffer[0];\n"
+"		output[gid] = OPERATOR_APPLY(output[gid], localBuffer[0]);\n"
 "	gid++;\n"
 "	if (gid < outputSize)\n"
-"		output[gid] += localBuffer[0];\n"
+"		output[gid] = OPERATOR_APPLY(output[gid], localBuffer[0]);\n"
 "#endif\n"
 "}\n"
 ;
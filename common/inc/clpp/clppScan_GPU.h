@@ -6,7 +6,8 @@
 class clppScan_GPU : public clppScan
 {
 public:
-	clppScan_GPU(clppContext* context, size_t valueSize, unsigned int maxElements);
+	clppScan_GPU(clppContext* context, size_t valueSize, clppIndex maxElements);
+	clppScan_GPU(clppContext* context, const clppOperator& op, clppIndex maxElements);
 	~clppScan_GPU();
 
 	string getName() { return "Prefix sum (exclusive) for the GPU"; }
@@ -22,7 +23,9 @@ public:
 	string compilePreprocess(string kernel);
 
 private:
-	cl_kernel kernel__scan;
+	clppKernel kernel__scan;
+
+	void initialize();
 };
 
 #endif
\ No newline at end of file
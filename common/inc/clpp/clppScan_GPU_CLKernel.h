@@ -1,10 +1,7 @@
 
 char clCode_clppScan_GPU[]=
 "#pragma OPENCL EXTENSION cl_amd_printf : enable\n"
-"#define T uint\n"
 "#define OPERATOR_INDEXOF(I) I\n"
-"#define OPERATOR_APPLY(A,B) A+B\n"
-"#define OPERATOR_IDENTITY 0\n"
 "#define VOLATILE\n"
 "inline T scan_simt_exclusive(__local VOLATILE T* input, size_t idx, const uint lane)\n"
 "{\n"
@@ -54,9 +51,9 @@ char clCode_clppScan_GPU[]=
 "void kernel__scan_block_anylength(\n"
 "	__local T* localBuf,\n"
 "	__global T* dataSet,\n"
-"	const uint B,\n"
-"	uint size,\n"
-"	const uint passesCount\n"
+"	const INDEX_T B,\n"
+"	INDEX_T size,\n"
+"	const INDEX_T passesCount\n"
 ")\n"
 "{	\n"
 "	size_t idx = get_local_id(0);\n"
@@ -69,10 +66,10 @@ char clCode_clppScan_GPU[]=
 "	T reduceValue = OPERATOR_IDENTITY;\n"
 "	\n"
 "	//#pragma unroll 4\n"
-"	for(uint i = 0; i < passesCount; ++i)\n"
+"	for(INDEX_T i = 0; i < passesCount; ++i)\n"
 "	{\n"
-"		const uint offset = i * TC + (bidx * B);\n"
-"		const uint offsetIdx = offset + idx;\n"
+"		const INDEX_T offset = i * TC + (bidx * B);\n"
+"		const INDEX_T offsetIdx = offset + idx;\n"
 "		\n"
 "#ifdef OCL_PLATFORM_AMD\n"
 "		if (offsetIdx > size-1)\n"
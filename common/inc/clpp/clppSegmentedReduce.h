@@ -0,0 +1,86 @@
+#ifndef __CLPP_SEGMENTEDREDUCE_H__
+#define __CLPP_SEGMENTEDREDUCE_H__
+
+#include "clpp/clppProgram.h"
+#include "clpp/clppOperator.h"
+#include "clpp/clppSegmentedScan.h"
+
+/// Segmented reduction : one result per segment (ex : the earliest event of each LP), in a single
+/// pass over the data set instead of a loop over the segments.
+///
+/// The segments are given by head flags or by offsets, as for clppSegmentedScan. The data set is not modified.
+///
+/// \version 1.0
+class clppSegmentedReduce : public clppProgram
+{
+public:
+	/// Create a new segmented reduction
+	///
+	/// \param op			The data type and the operator, ex : clppOperator(clppDataType_Float, clppOperator_Min)
+	/// \param maxElements	The maximum number of elements to reduce
+	clppSegmentedReduce(clppContext* context, const clppOperator& op, clppIndex maxElements);
+	~clppSegmentedReduce();
+
+	/// Returns the algorithm name
+	string getName() { return "Segmented reduction"; }
+
+	/// Reduce each segment of the pushed data set
+	void reduce();
+
+	/// Push the data on the device
+	void pushDatas(void* dataSet, size_t datasetSize);
+
+	/// Push a buffer that is already on the device side. (Data are not sended)
+	void pushCLDatas(cl_mem clBuffer_dataSet, size_t datasetSize);
+
+	/// Push the head flags (one byte per element, not 0 : the element starts a segment), already on the device side
+	void pushCLHeads(cl_mem clBuffer_heads);
+
+	/// Push the offsets of the segments (clppIndex, sorted), already on the device side. An empty segment gives the identity.
+	/// There are at most 'maxElements' segments.
+	void pushCLOffsets(cl_mem clBuffer_offsets, size_t segments);
+
+	/// Retreive the number of segments (blocking)
+	clppIndex popCount();
+
+	/// Retreive the result of each segment (blocking), 'popCount' values
+	void popDatas(void* results);
+
+	/// Returns the device buffer holding the result of each segment
+	cl_mem getCLResultBuffer() { return _clBuffer_output; }
+
+	/// Returns the device buffer holding the number of segments (clppIndex)
+	cl_mem getCLCountBuffer() { return _clBuffer_count; }
+
+	string compilePreprocess(string kernel);
+
+private:
+	clppOperator _operator;
+
+	void* _dataSet;
+	size_t _datasetSize;
+
+	cl_mem _clBuffer_dataSet;
+	bool _is_clBuffersOwner;
+
+	cl_mem _clBuffer_heads;
+	cl_mem _clBuffer_offsets;
+	clppIndex _segments;				// The number of offsets (the source of the write of '_clBuffer_count')
+
+	cl_mem _clBuffer_scanned;		// The inclusive segmented scan of the data set
+	cl_mem _clBuffer_indices;		// The scanned head flags : index of each segment
+	cl_mem _clBuffer_ownOffsets;	// The offsets built from the head flags
+	cl_mem _clBuffer_output;
+	cl_mem _clBuffer_count;
+
+	clppKernel _kernel_HeadFlags;
+	clppKernel _kernel_HeadOffsets;
+	clppKernel _kernel_Gather;
+
+	size_t _workgroupSize;
+
+	clppSegmentedScan* _segmentedScan;
+	clppScan* _scan;				// The scan of the head flags
+};
+
+#endif
\ No newline at end of file
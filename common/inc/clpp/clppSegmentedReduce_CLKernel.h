@@ -0,0 +1,48 @@
+
+char clCode_clppSegmentedReduce[]=
+"#pragma OPENCL EXTENSION cl_amd_printf : enable\n"
+"__kernel\n"
+"void kernel__segHeadFlags(\n"
+"	__global const uchar* heads,\n"
+"	__global INDEX_T* indices,\n"
+"	const INDEX_T N)\n"
+"{\n"
+"	const INDEX_T gid = get_global_id(0);\n"
+"	if (gid >= N)\n"
+"		return;\n"
+"	indices[gid] = (gid == 0 || heads[gid] != 0) ? 1 : 0;\n"
+"}\n"
+"__kernel\n"
+"void kernel__segHeadOffsets(\n"
+"	__global const uchar* heads,\n"
+"	__global const INDEX_T* indices,\n"
+"	__global INDEX_T* offsets,\n"
+"	__global INDEX_T* segments,\n"
+"	const INDEX_T N)\n"
+"{\n"
+"	const INDEX_T gid = get_global_id(0);\n"
+"	if (gid >= N)\n"
+"		return;\n"
+"	const INDEX_T head = (gid == 0 || heads[gid] != 0) ? 1 : 0;\n"
+"	if (head)\n"
+"		offsets[indices[gid]] = gid;\n"
+"	if (gid == N - 1)\n"
+"		segments[0] = indices[gid] + head;\n"
+"}\n"
+"__kernel\n"
+"void kernel__segReduceGather(\n"
+"	__global const T* scanned,\n"
+"	__global const INDEX_T* offsets,\n"
+"	__global const INDEX_T* segments,\n"
+"	__global T* output,\n"
+"	const INDEX_T N)\n"
+"{\n"
+"	const INDEX_T gid = get_global_id(0);\n"
+"	const INDEX_T S = segments[0];\n"
+"	if (gid >= S)\n"
+"		return;\n"
+"	const INDEX_T start = offsets[gid];\n"
+"	const INDEX_T end = (gid + 1 < S) ? offsets[gid + 1] : N;\n"
+"	output[gid] = (end > start) ? scanned[end - 1] : OPERATOR_IDENTITY;\n"
+"}\n"
+;
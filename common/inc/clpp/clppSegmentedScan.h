@@ -0,0 +1,59 @@
+#ifndef __CLPP_SEGMENTEDSCAN_H__
+#define __CLPP_SEGMENTEDSCAN_H__
+
+#include "clpp/clppScan.h"
+
+/// Segmented scan : a scan restarted at the head of each segment, in a single pass over the data set.
+///
+/// The segments are given by head flags (one byte per element, ex : d_next_event_flag) or by the
+/// offsets of the segments. The first element always starts a segment.
+///
+/// \version 1.0
+class clppSegmentedScan : public clppScan
+{
+public:
+	/// Create a new segmented scan
+	///
+	/// \param op			The data type and the operator, ex : clppOperator(clppDataType_Float, clppOperator_Min)
+	/// \param maxElements	The maximum number of elements to scan
+	/// \param inclusive	true : each element includes its own value, false : exclusive (like the other scans)
+	clppSegmentedScan(clppContext* context, const clppOperator& op, clppIndex maxElements, bool inclusive = false);
+	~clppSegmentedScan();
+
+	string getName() { return "Segmented scan"; }
+
+	void scan();
+
+	void pushDatas(void* values, size_t datasetSize);
+	void pushCLDatas(cl_mem clBuffer_values, size_t datasetSize);
+
+	/// Push the head flags (one byte per element, not 0 : the element starts a segment), already on the device side
+	void pushCLHeads(cl_mem clBuffer_heads);
+
+	/// Push the offsets of the segments (clppIndex, sorted), already on the device side
+	void pushCLOffsets(cl_mem clBuffer_offsets, size_t segments);
+
+	void popDatas();
+	void popDatas(void* dataSet);
+
+	string compilePreprocess(string kernel);
+
+private:
+	bool _inclusive;
+
+	cl_mem _clBuffer_heads;
+	cl_mem _clBuffer_offsets;		// Not 0 : the head flags are built from these offsets
+	size_t _segments;
+
+	cl_mem _clBuffer_ownHeads;		// The head flags built from the offsets
+	cl_mem _clBuffer_tileValues;	// The (flag, value) pair, then the carry, of each tile
+	cl_mem _clBuffer_tileFlags;
+
+	clppKernel _kernel_ReduceTiles;
+	clppKernel _kernel_Carries;
+	clppKernel _kernel_ScanTiles;
+	clppKernel _kernel_ClearHeads;
+	clppKernel _kernel_SetHeads;
+};
+
+#endif
\ No newline at end of file
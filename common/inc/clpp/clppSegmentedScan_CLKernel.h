@@ -0,0 +1,133 @@
+
+char clCode_clppSegmentedScan[]=
+"#pragma OPENCL EXTENSION cl_amd_printf : enable\n"
+"inline void scan_workgroup_segmented(__local T* values, __local uint* flags, const uint lid)\n"
+"{\n"
+"	for(uint offset = 1; offset < WORKGROUP_SIZE; offset <<= 1)\n"
+"	{\n"
+"		T left = OPERATOR_IDENTITY;\n"
+"		uint leftFlag = 0;\n"
+"		if (lid >= offset)\n"
+"		{\n"
+"			left = values[lid - offset];\n"
+"			leftFlag = flags[lid - offset];\n"
+"		}\n"
+"		barrier(CLK_LOCAL_MEM_FENCE);\n"
+"		if (lid >= offset)\n"
+"		{\n"
+"			if (!flags[lid])\n"
+"				values[lid] = OPERATOR_APPLY(left, values[lid]);\n"
+"			flags[lid] |= leftFlag;\n"
+"		}\n"
+"		barrier(CLK_LOCAL_MEM_FENCE);\n"
+"	}\n"
+"}\n"
+"__kernel\n"
+"void kernel__segScanReduceTiles(\n"
+"	__global const T* data,\n"
+"	__global const uchar* heads,\n"
+"	__global T* tileValues,\n"
+"	__global uint* tileFlags,\n"
+"	const INDEX_T N)\n"
+"{\n"
+"	const uint lid = get_local_id(0);\n"
+"	const INDEX_T gid = get_global_id(0);\n"
+"	__local T values[WORKGROUP_SIZE];\n"
+"	__local uint flags[WORKGROUP_SIZE];\n"
+"	values[lid] = (gid < N) ? data[gid] : OPERATOR_IDENTITY;\n"
+"	flags[lid] = (gid < N) ? (gid == 0 || heads[gid] != 0) : 0;\n"
+"	barrier(CLK_LOCAL_MEM_FENCE);\n"
+"	scan_workgroup_segmented(values, flags, lid);\n"
+"	if (lid == WORKGROUP_SIZE - 1)\n"
+"	{\n"
+"		tileValues[get_group_id(0)] = values[lid];\n"
+"		tileFlags[get_group_id(0)] = flags[lid];\n"
+"	}\n"
+"}\n"
+"__kernel\n"
+"void kernel__segScanCarries(\n"
+"	__global T* tileValues,\n"
+"	__global const uint* tileFlags,\n"
+"	const INDEX_T tiles)\n"
+"{\n"
+"	const uint lid = get_local_id(0);\n"
+"	__local T values[WORKGROUP_SIZE];\n"
+"	__local uint flags[WORKGROUP_SIZE];\n"
+"	T carry = OPERATOR_IDENTITY;\n"
+"	for(INDEX_T base = 0; base < tiles; base += WORKGROUP_SIZE)\n"
+"	{\n"
+"		const INDEX_T i = base + lid;\n"
+"		values[lid] = (i < tiles) ? tileValues[i] : OPERATOR_IDENTITY;\n"
+"		flags[lid] = (i < tiles) ? tileFlags[i] : 0;\n"
+"		barrier(CLK_LOCAL_MEM_FENCE);\n"
+"		scan_workgroup_segmented(values, flags, lid);\n"
+"		// The carry of the tile 'i' is the inclusive result of the tile 'i - 1'\n"
+"		T carryIn = carry;\n"
+"		if (lid > 0)\n"
+"			carryIn = flags[lid - 1] ? values[lid - 1] : OPERATOR_APPLY(carry, values[lid - 1]);\n"
+"		T last = values[WORKGROUP_SIZE - 1];\n"
+"		uint lastFlag = flags[WORKGROUP_SIZE - 1];\n"
+"		barrier(CLK_LOCAL_MEM_FENCE);\n"
+"		if (i < tiles)\n"
+"			tileValues[i] = carryIn;\n"
+"		carry = lastFlag ? last : OPERATOR_APPLY(carry, last);\n"
+"	}\n"
+"}\n"
+"__kernel\n"
+"void kernel__segScanTiles(\n"
+"	__global T* data,\n"
+"	__global const uchar* heads,\n"
+"	__global const T* tileCarries,\n"
+"	const INDEX_T N,\n"
+"	const uint inclusive)\n"
+"{\n"
+"	const uint lid = get_local_id(0);\n"
+"	const INDEX_T gid = get_global_id(0);\n"
+"	__local T values[WORKGROUP_SIZE];\n"
+"	__local uint flags[WORKGROUP_SIZE];\n"
+"	const uint head = (gid < N) ? (gid == 0 || heads[gid] != 0) : 0;\n"
+"	values[lid] = (gid < N) ? data[gid] : OPERATOR_IDENTITY;\n"
+"	flags[lid] = head;\n"
+"	barrier(CLK_LOCAL_MEM_FENCE);\n"
+"	scan_workgroup_segmented(values, flags, lid);\n"
+"	if (gid >= N)\n"
+"		return;\n"
+"	const T carry = tileCarries[get_group_id(0)];\n"
+"	if (inclusive)\n"
+"	{\n"
+"		data[gid] = flags[lid] ? values[lid] : OPERATOR_APPLY(carry, values[lid]);\n"
+"	}\n"
+"	else if (head)\n"
+"	{\n"
+"		data[gid] = OPERATOR_IDENTITY;\n"
+"	}\n"
+"	else\n"
+"	{\n"
+"		data[gid] = (lid == 0) ? carry : (flags[lid - 1] ? values[lid - 1] : OPERATOR_APPLY(carry, values[lid - 1]));\n"
+"	}\n"
+"}\n"
+"__kernel\n"
+"void kernel__segClearHeads(\n"
+"	__global uchar* heads,\n"
+"	const INDEX_T N)\n"
+"{\n"
+"	const INDEX_T gid = get_global_id(0);\n"
+"	if (gid >= N)\n"
+"		return;\n"
+"	heads[gid] = 0;\n"
+"}\n"
+"__kernel\n"
+"void kernel__segSetHeads(\n"
+"	__global const INDEX_T* offsets,\n"
+"	__global uchar* heads,\n"
+"	const INDEX_T segments,\n"
+"	const INDEX_T N)\n"
+"{\n"
+"	const INDEX_T gid = get_global_id(0);\n"
+"	if (gid >= segments)\n"
+"		return;\n"
+"	const INDEX_T offset = offsets[gid];\n"
+"	if (offset < N)\n"
+"		heads[offset] = 1;\n"
+"}\n"
+;
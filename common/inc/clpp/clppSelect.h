@@ -0,0 +1,73 @@
+#ifndef __CLPP_SELECT_H__
+#define __CLPP_SELECT_H__
+
+#include "clpp/clppProgram.h"
+
+/// Select the 'k' smallest keys (and their values) of a data set, on the device, without sorting it.
+///
+/// The selection is a radix select : one histogram pass per 8 bits of key, then one gather pass.
+/// The 'k' selected elements are not sorted.
+///
+/// \version 1.0
+class clppSelect : public clppProgram
+{
+public:
+	/// Create a new selection
+	///
+	/// \param maxElements	The maximum number of elements in the data set
+	/// \param bits			The bits used by the key
+	/// \param keysOnly		Keys only (uint) or Key-Values (uint2, key in x)
+	clppSelect(clppContext* context, unsigned int maxElements, unsigned int bits, bool keysOnly);
+	~clppSelect();
+
+	/// Returns the algorithm name
+	string getName() { return "Radix select"; }
+
+	/// Select the 'k' smallest elements of the pushed data set
+	void select(unsigned int k);
+
+	/// Push the data on the device
+	void pushDatas(void* dataSet, size_t datasetSize);
+
+	/// Push a buffer that is already on the device side. (Data are not sended)
+	void pushCLDatas(cl_mem clBuffer_dataSet, size_t datasetSize);
+
+	/// Retreive the 'k' selected elements
+	void popDatas(void* dataSet);
+
+	/// Returns the device buffer holding the 'k' selected elements
+	cl_mem getCLResultBuffer() { return _clBuffer_dataSetOut; }
+
+	/// Returns the k-th smallest key (blocking)
+	unsigned int getKthKey();
+
+	string compilePreprocess(string kernel);
+
+private:
+	bool _keysOnly;				// Key-Values or Keys-only
+	unsigned int _bits;			// The bits used by the key
+	unsigned int _k;			// The number of selected elements
+
+	void* _dataSet;
+	size_t _datasetSize;
+
+	cl_mem _clBuffer_dataSet;
+	cl_mem _clBuffer_dataSetOut;
+	size_t _dataSetOutSize;		// Capacity of '_clBuffer_dataSetOut' (in elements)
+	bool _is_clBuffersOwner;
+
+	cl_mem _clBuffer_histogram;	// 256 counters
+	cl_mem _clBuffer_state;		// The selection state, see clppSelect.cl
+
+	unsigned int _initialState[6 + 256];
+
+	clppKernel _kernel_Histogram;
+	clppKernel _kernel_Digit;
+	clppKernel _kernel_Gather;
+
+	size_t _workgroupSize;
+
+	size_t getElementSize() { return _keysOnly ? sizeof(cl_uint) : sizeof(cl_uint2); }
+};
+
+#endif
\ No newline at end of file
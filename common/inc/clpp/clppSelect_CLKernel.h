@@ -0,0 +1,91 @@
+
+char clCode_clppSelect[]=
+"#pragma OPENCL EXTENSION cl_amd_printf : enable\n"
+"#define RADIX 256\n"
+"#define RADIX_MASK 0xFF\n"
+"#ifdef KEYS_ONLY\n"
+"#define KEY(DATA) (DATA)\n"
+"#else\n"
+"#define KEY(DATA) (DATA.x)\n"
+"#endif\n"
+"#define STATE_PREFIX 0\n"
+"#define STATE_MASK 1\n"
+"#define STATE_RANK 2\n"
+"#define STATE_LESS 3\n"
+"#define STATE_EQUAL 4\n"
+"#define STATE_K 5\n"
+"__kernel\n"
+"void kernel__selectHistogram(\n"
+"	__global const KV_TYPE* data,\n"
+"	__global uint* histogram,\n"
+"	__global const uint* state,\n"
+"	const uint shift,\n"
+"	const uint N)\n"
+"{\n"
+"	const uint tid = get_local_id(0);\n"
+"	const uint lsz = get_local_size(0);\n"
+"	__local uint localHistogram[RADIX];\n"
+"	for(uint i = tid; i < RADIX; i += lsz)\n"
+"		localHistogram[i] = 0;\n"
+"	barrier(CLK_LOCAL_MEM_FENCE);\n"
+"	const uint prefix = state[STATE_PREFIX];\n"
+"	const uint mask = state[STATE_MASK];\n"
+"	for(uint i = get_global_id(0); i < N; i += get_global_size(0))\n"
+"	{\n"
+"		uint key = KEY(data[i]);\n"
+"		if ((key & mask) == prefix)\n"
+"			atomic_inc(&localHistogram[(key >> shift) & RADIX_MASK]);\n"
+"	}\n"
+"	barrier(CLK_LOCAL_MEM_FENCE);\n"
+"	for(uint i = tid; i < RADIX; i += lsz)\n"
+"		if (localHistogram[i] > 0)\n"
+"			atomic_add(&histogram[i], localHistogram[i]);\n"
+"}\n"
+"__kernel\n"
+"void kernel__selectDigit(\n"
+"	__global uint* histogram,\n"
+"	__global uint* state,\n"
+"	const uint shift)\n"
+"{\n"
+"	uint rank = state[STATE_RANK];\n"
+"	uint digit = 0;\n"
+"	for(; digit < RADIX_MASK; digit++)\n"
+"	{\n"
+"		uint count = histogram[digit];\n"
+"		if (rank <= count)\n"
+"			break;\n"
+"		rank -= count;\n"
+"	}\n"
+"	state[STATE_PREFIX] |= digit << shift;\n"
+"	state[STATE_MASK] |= RADIX_MASK << shift;\n"
+"	state[STATE_RANK] = rank;\n"
+"	for(uint i = 0; i < RADIX; i++)\n"
+"		histogram[i] = 0;\n"
+"}\n"
+"__kernel\n"
+"void kernel__selectGather(\n"
+"	__global const KV_TYPE* data,\n"
+"	__global KV_TYPE* dataOut,\n"
+"	__global uint* state,\n"
+"	const uint N)\n"
+"{\n"
+"	const uint kth = state[STATE_PREFIX];\n"
+"	const uint rank = state[STATE_RANK];\n"
+"	const uint equalOffset = state[STATE_K] - rank;\n"
+"	for(uint i = get_global_id(0); i < N; i += get_global_size(0))\n"
+"	{\n"
+"		KV_TYPE value = data[i];\n"
+"		uint key = KEY(value);\n"
+"		if (key < kth)\n"
+"		{\n"
+"			dataOut[atomic_inc(&state[STATE_LESS])] = value;\n"
+"		}\n"
+"		else if (key == kth)\n"
+"		{\n"
+"			uint index = atomic_inc(&state[STATE_EQUAL]);\n"
+"			if (index < rank)\n"
+"				dataOut[equalOffset + index] = value;\n"
+"		}\n"
+"	}\n"
+"}\n"
+;
@@ -30,6 +30,18 @@ public:
 	/// \param datasetSize			Number of elements to be sorted. Must be <= maxElements passed to the constructor
 	virtual void pushCLDatas(cl_mem clBuffer_dataSet, size_t datasetSize) = 0;
 
+	/// Push a persistent double-buffer pair that is already on the device.
+	/// The sort passes ping-pong between the two buffers : nothing is allocated and nothing is copied.
+	/// After sort(), use getCLResultBuffer() to know which buffer of the pair holds the result.
+	///
+	/// \param clBuffer_dataSet		Array of data to be sorted.
+	/// \param clBuffer_dataSetOut	Array of the same size, used as the second buffer of the pair. Its content is overwritten.
+	/// \param datasetSize			Number of elements to be sorted. Must be <= maxElements passed to the constructor
+	virtual void pushCLDatas(cl_mem clBuffer_dataSet, cl_mem clBuffer_dataSetOut, size_t datasetSize) = 0;
+
+	/// Returns the device buffer that holds the sorted data after the last call to sort()
+	cl_mem getCLResultBuffer() { return _clBuffer_result; }
+
 	/// Pop the data from the device
 	virtual void popDatas() = 0;
 	virtual void popDatas(void* dataSet) = 0;
@@ -38,6 +50,7 @@ protected:
 	
 	void* _dataSet;				// The associated data set to sort
 	cl_mem _clBuffer_dataSet;	// The cl buffers for the values
+	cl_mem _clBuffer_result;	// The cl buffer holding the sorted values (one of the ping-pong pair)
 	size_t _dataSize;			// The size of a value in bytes
 
 	unsigned int _keySize;
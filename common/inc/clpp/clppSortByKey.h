@@ -0,0 +1,75 @@
+#ifndef __CLPP_SORTBYKEY_H__
+#define __CLPP_SORTBYKEY_H__
+
+#include "clpp/clppProgram.h"
+#include "clpp/clppSort.h"
+
+/// Sort a set of keys and output the permutation, to reorder any number of payload arrays.
+///
+/// The keys are sorted with their index (uint2) : the radix passes move 8 bytes per element
+/// instead of the full record. Each payload array (time, LP, RNG state...) is then reordered
+/// with a single gather pass.
+///
+/// \version 1.0
+class clppSortByKey : public clppProgram
+{
+public:
+	/// Create a new sort by key
+	///
+	/// \param maxElements	The maximum number of elements to sort
+	/// \param bits			The bits used by the key
+	clppSortByKey(clppContext* context, unsigned int maxElements, unsigned int bits);
+	~clppSortByKey();
+
+	/// Returns the algorithm name
+	string getName() { return "Sort by key"; }
+
+	/// Sort the pushed keys (in place) and build the permutation
+	void sort();
+
+	/// Reorder a payload array with the permutation of the last sort : dst[i] = src[permutation[i]]
+	///
+	/// \param clBuffer_src		The payload array, in the unsorted order
+	/// \param clBuffer_dst		The reordered payload array. Must not be 'clBuffer_src'
+	/// \param elementSize		The size of a payload element in bytes, must be a multiple of 4
+	void gather(cl_mem clBuffer_src, cl_mem clBuffer_dst, size_t elementSize);
+
+	/// Push the keys on the device
+	void pushDatas(void* keys, size_t datasetSize);
+
+	/// Push keys that are already on the device side. (Data are not sended)
+	void pushCLDatas(cl_mem clBuffer_keys, size_t datasetSize);
+
+	/// Retreive the sorted keys
+	void popDatas(void* keys);
+
+	/// Retreive the permutation
+	void popPermutation(void* permutation);
+
+	/// Returns the device buffer holding the permutation (uint per element)
+	cl_mem getCLPermutationBuffer() { return _clBuffer_permutation; }
+
+private:
+	void* _dataSet;
+	size_t _datasetSize;
+
+	cl_mem _clBuffer_keys;
+	bool _is_clBuffersOwner;
+
+	cl_mem _clBuffer_pairs;			// The (key, index) pairs
+	cl_mem _clBuffer_pairsScratch;	// Second buffer of the ping-pong pair of the sort
+	cl_mem _clBuffer_permutation;
+
+	clppKernel _kernel_Init;
+	clppKernel _kernel_Split;
+	clppKernel _kernel_Gather1;
+	clppKernel _kernel_Gather2;
+	clppKernel _kernel_Gather4;
+	clppKernel _kernel_GatherWords;
+
+	size_t _workgroupSize;
+
+	clppSort* _sort;				// The key-value sort of the pairs
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,81 @@
+
+char clCode_clppSortByKey[]=
+"#pragma OPENCL EXTENSION cl_amd_printf : enable\n"
+"__kernel\n"
+"void kernel__sortByKeyInit(\n"
+"	__global const uint* keys,\n"
+"	__global uint2* pairs,\n"
+"	const uint N)\n"
+"{\n"
+"	const uint gid = get_global_id(0);\n"
+"	if (gid >= N)\n"
+"		return;\n"
+"	pairs[gid] = (uint2)(keys[gid], gid);\n"
+"}\n"
+"__kernel\n"
+"void kernel__sortByKeySplit(\n"
+"	__global const uint2* pairs,\n"
+"	__global uint* keys,\n"
+"	__global uint* permutation,\n"
+"	const uint N)\n"
+"{\n"
+"	const uint gid = get_global_id(0);\n"
+"	if (gid >= N)\n"
+"		return;\n"
+"	uint2 pair = pairs[gid];\n"
+"	keys[gid] = pair.x;\n"
+"	permutation[gid] = pair.y;\n"
+"}\n"
+"__kernel\n"
+"void kernel__gather1(\n"
+"	__global const uint* src,\n"
+"	__global uint* dst,\n"
+"	__global const uint* permutation,\n"
+"	const uint N)\n"
+"{\n"
+"	const uint gid = get_global_id(0);\n"
+"	if (gid >= N)\n"
+"		return;\n"
+"	dst[gid] = src[permutation[gid]];\n"
+"}\n"
+"__kernel\n"
+"void kernel__gather2(\n"
+"	__global const uint2* src,\n"
+"	__global uint2* dst,\n"
+"	__global const uint* permutation,\n"
+"	const uint N)\n"
+"{\n"
+"	const uint gid = get_global_id(0);\n"
+"	if (gid >= N)\n"
+"		return;\n"
+"	dst[gid] = src[permutation[gid]];\n"
+"}\n"
+"__kernel\n"
+"void kernel__gather4(\n"
+"	__global const uint4* src,\n"
+"	__global uint4* dst,\n"
+"	__global const uint* permutation,\n"
+"	const uint N)\n"
+"{\n"
+"	const uint gid = get_global_id(0);\n"
+"	if (gid >= N)\n"
+"		return;\n"
+"	dst[gid] = src[permutation[gid]];\n"
+"}\n"
+"__kernel\n"
+"void kernel__gatherWords(\n"
+"	__global const uint* src,\n"
+"	__global uint* dst,\n"
+"	__global const uint* permutation,\n"
+"	const uint N,\n"
+"	const uint words)\n"
+"{\n"
+"	const uint gid = get_global_id(0);\n"
+"	if (gid >= N)\n"
+"		return;\n"
+"	__global const uint* from = src + permutation[gid] * words;\n"
+"	__global uint* to = dst + gid * words;\n"
+"	for(uint i = 0; i < words; i++)\n"
+"		to[i] = from[i];\n"
+"}\n"
+;
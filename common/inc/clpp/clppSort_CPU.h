@@ -1,26 +1,61 @@
 #ifndef __CLPP_SORT_CPU_H__
 #define __CLPP_SORT_CPU_H__
 
+#include <vector>
+
 #include "clpp/clppSort.h"
 
+/// Native host sort : a multithreaded LSD radix sort, 8 bits per pass.
+///
+/// Each thread builds the histogram of its own slice of the data, the per-thread
+/// histograms are scanned together, then each thread scatters its slice. The digit
+/// extraction of the histogram pass is vectorized (SSE2) when available.
+///
+/// On a CPU device, this is faster than the OpenCL kernels. The device buffers pushed
+/// with pushCLDatas are read, sorted on the host and written back.
+///
+/// \version 1.0
 class clppSort_CPU : public clppSort
 {
 public:
-	clppSort_CPU(clppContext* context);
+	/// Create a new host sort
+	///
+	/// \param maxElements	The maximum number of elements to sort
+	/// \param bits			The bits used by the key
+	/// \param keysOnly		Keys only (uint) or Key-Values (uint2, key in x)
+	clppSort_CPU(clppContext* context, clppIndex maxElements, unsigned int bits, bool keysOnly);
 	~clppSort_CPU();
 
-	string getName() { return "CPU Brute force"; }
+	string getName() { return "CPU Radix sort"; }
+
+	/// Set the number of sorting threads (default : the number of hardware threads).
+	/// Each thread sorts at least 65536 elements : the small sets use fewer threads.
+	void setThreadCount(unsigned int threadCount);
+	unsigned int getThreadCount() { return _threadCount; }
 
 	void sort();
-	void sort(void* dataSet) {}
 
 	void pushDatas(void* dataSet, size_t datasetSize);
 	void pushCLDatas(cl_mem clBuffer_dataSet, size_t datasetSize);
+	void pushCLDatas(cl_mem clBuffer_dataSet, cl_mem clBuffer_dataSetOut, size_t datasetSize);
 
 	void popDatas();
-	void popDatas(void* dataSet) {}
+	void popDatas(void* dataSet);
 
 	void waitCompletion() {}
+
+private:
+	bool _keysOnly;					// Key-Values or Keys-only
+	unsigned int _bits;				// The bits used by the key
+	unsigned int _threadCount;		// The number of sorting threads
+
+	vector<unsigned int> _hostData;		// Host copy of the device data set
+	vector<unsigned int> _temp;			// The second buffer of the ping-pong pair
+	vector<size_t> _histograms;			// One histogram per thread
+
+	size_t getElementSize() { return _keysOnly ? sizeof(cl_uint) : sizeof(cl_uint2); }
+
+	template<typename T> void radixSort(T* data, T* temp, size_t count);
 };
 
 #endif
\ No newline at end of file
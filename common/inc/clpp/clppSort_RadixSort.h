@@ -7,7 +7,7 @@
 class clppSort_RadixSort : public clppSort
 {
 public:
-	clppSort_RadixSort(clppContext* context, unsigned int maxElements, unsigned int bits, bool keysOnly);
+	clppSort_RadixSort(clppContext* context, clppIndex maxElements, unsigned int bits, bool keysOnly);
 	~clppSort_RadixSort();
 
 	string getName() { return "Radix sort"; }
@@ -16,6 +16,7 @@ public:
 
 	void pushDatas(void* dataSet, size_t datasetSize);
 	void pushCLDatas(cl_mem clBuffer_dataSet, size_t datasetSize);
+	void pushCLDatas(cl_mem clBuffer_dataSet, cl_mem clBuffer_dataSetOut, size_t datasetSize);
 
 	void popDatas();
 	void popDatas(void* dataSet);
@@ -27,11 +28,15 @@ private:
 	size_t _datasetSize;	// The number of keys to sort
 
 	void* _dataSetOut;
-	cl_mem _clBuffer_dataSetOut;
+	cl_mem _clBuffer_dataSetOut;	// The second buffer of the ping-pong pair
 
-	cl_kernel _kernel_RadixLocalSort;
-	cl_kernel _kernel_LocalHistogram;
-	cl_kernel _kernel_RadixPermute;	
+	cl_mem _clBuffer_scratch;		// Owned second buffer, used when the caller doesn't supply a pair
+	size_t _scratchSize;			// Capacity of '_clBuffer_scratch' (in elements)
+	size_t _histogramBlocks;		// Capacity of the radix histograms (in blocks)
+
+	clppKernel _kernel_RadixLocalSort;
+	clppKernel _kernel_LocalHistogram;
+	clppKernel _kernel_RadixPermute;	
 
 	size_t _workgroupSize;
 
@@ -41,6 +46,9 @@ private:
 	void localHistogram(const size_t* global, const size_t* local, cl_mem* data, cl_mem* hist, cl_mem* blockHists, int bitOffset);
 	void radixPermute(const size_t* global, const size_t* local, cl_mem* dataIn, cl_mem* dataOut, cl_mem* histScan, cl_mem* blockHists, int bitOffset, unsigned int numBlocks);
 	void freeUpRadixMems();
+	void allocateHistograms(size_t datasetSize);
+	void allocateScratch(size_t datasetSize);
+	size_t getElementSize() { return _keysOnly ? _keySize : (_keySize + _valueSize); }
 
 	clppScan* _scan;
 
@@ -18,6 +18,10 @@ char clCode_clppSort_RadixSortGPU[]=
 "#endif\n"
 "#define EXTRACT_KEY_BIT(VALUE,BIT) ((KEY(VALUE)>>BIT)&0x1)\n"
 "#define EXTRACT_KEY_4BITS(VALUE,BIT) ((KEY(VALUE)>>BIT)&0xF)\n"
+"#define VECTOR4_(TYPE) TYPE##4\n"
+"#define VECTOR4(TYPE) VECTOR4_(TYPE)\n"
+"#define INDEX_T4 VECTOR4(INDEX_T)\n"
+"#define GLOBAL_ID4 ((INDEX_T4)((INDEX_T)get_global_id(0) << 2) + (INDEX_T4)(0,1,2,3))\n"
 "#define BARRIER_LOCAL barrier(CLK_LOCAL_MEM_FENCE)\n"
 "#define SIMT 32\n"
 "#define SIMT_1 (SIMT-1)\n"
@@ -98,11 +102,11 @@ char clCode_clppSort_RadixSortGPU[]=
 "	//__local KV_TYPE* localDataOLD,\n"
 "	__global KV_TYPE* data,\n"
 "	const int bitOffset,\n"
-"	const int N)\n"
+"	const INDEX_T N)\n"
 "{\n"
 "	const uint tid = (uint)get_local_id(0);\n"
 "	const uint4 tid4 = (const uint4)(tid << 2) + (const uint4)(0,1,2,3);\n"
-"	const uint4 gid4 = (const uint4)(get_global_id(0) << 2) + (const uint4)(0,1,2,3);\n"
+"	const INDEX_T4 gid4 = GLOBAL_ID4;\n"
 "	\n"
 "	// Local memory\n"
 "	__local KV_TYPE localDataArray[TPG*4*2]; // Faster than using it as a parameter !!!\n"
@@ -160,11 +164,11 @@ char clCode_clppSort_RadixSortGPU[]=
 "if (gid4.w < N) data[gid4.w] = localData[tid4.w];\n"
 "}\n"
 "__kernel\n"
-"void kernel__localHistogram(__global KV_TYPE* data, const int bitOffset, __global int* radixCount, __global int* radixOffsets, const int N)\n"
+"void kernel__localHistogram(__global KV_TYPE* data, const int bitOffset, __global INDEX_T* radixCount, __global int* radixOffsets, const INDEX_T N)\n"
 "{\n"
 "const int tid = (int)get_local_id(0);\n"
 "const int4 tid4 = (int4)(tid << 2) + (const int4)(0,1,2,3);\n"
-"	const int4 gid4 = (int4)(get_global_id(0) << 2) + (const int4)(0,1,2,3);\n"
+"	const INDEX_T4 gid4 = GLOBAL_ID4;\n"
 "	const int blockId = (int)get_group_id(0);\n"
 "	\n"
 "	__local uint localData[WGZ_x4];\n"
@@ -237,19 +241,19 @@ char clCode_clppSort_RadixSortGPU[]=
 "void kernel__radixPermute(\n"
 "	__global const KV_TYPE* dataIn,		// size 4*4 int2s per block\n"
 "	__global KV_TYPE* dataOut,			// size 4*4 int2s per block\n"
-"	__global const int* histSum,		// size 16 per block (64 B)\n"
+"	__global const INDEX_T* histSum,	// size 16 per block\n"
 "	__global const int* blockHists,		// size 16 int2s per block (64 B)\n"
 "	const int bitOffset,				// k*4, k=0..7\n"
-"	const int N,\n"
+"	const INDEX_T N,\n"
 "	const int numBlocks)\n"
 "{    \n"
 "const int tid = get_local_id(0);	\n"
 "	const int groupId = get_group_id(0);\n"
 "const int4 tid4 = (int4)(tid << 2) + (const int4)(0,1,2,3);\n"
-"	const int4 gid4 = (int4)(get_global_id(0) << 2) + (const int4)(0,1,2,3);\n"
+"	const INDEX_T4 gid4 = GLOBAL_ID4;\n"
 "	\n"
 "	\n"
-"__local int sharedHistSum[16];\n"
+"__local INDEX_T sharedHistSum[16];\n"
 "__local int localHistStart[16];\n"
 "if (tid < 16)\n"
 "{\n"
@@ -261,7 +265,7 @@ char clCode_clppSort_RadixSortGPU[]=
 "	\n"
 "	KV_TYPE myData;\n"
 "int myShiftedKeys;\n"
-"	int finalOffset;\n"
+"	INDEX_T finalOffset;\n"
 "	\n"
 "	myData = (gid4.x < N) ? dataIn[gid4.x] : MAX_KV_TYPE;\n"
 "myShiftedKeys = EXTRACT_KEY_4BITS(myData, bitOffset);\n"
@@ -17,6 +17,10 @@ char clCode_clppSort_RadixSort[]=
 "#endif\n"
 "#define EXTRACT_KEY_BIT(VALUE,BIT) ((KEY(VALUE)>>BIT)&0x1)\n"
 "#define EXTRACT_KEY_4BITS(VALUE,BIT) ((KEY(VALUE)>>BIT)&0xF)\n"
+"#define VECTOR4_(TYPE) TYPE##4\n"
+"#define VECTOR4(TYPE) VECTOR4_(TYPE)\n"
+"#define INDEX_T4 VECTOR4(INDEX_T)\n"
+"#define GLOBAL_ID4 ((INDEX_T4)((INDEX_T)get_global_id(0) << 2) + (INDEX_T4)(0,1,2,3))\n"
 "#define BARRIER_LOCAL barrier(CLK_LOCAL_MEM_FENCE)\n"
 "inline\n"
 "void exclusive_scan_4(const uint tid, const int4 tid4, __local uint* localBuffer, __local uint* bitsOnCount)\n"
@@ -86,11 +90,11 @@ char clCode_clppSort_RadixSort[]=
 "	__local KV_TYPE* localData,			// size 4*4 int2s (8 kB)\n"
 "	__global KV_TYPE* data,				// size 4*4 int2s per block (8 kB)\n"
 "	const int bitOffset,				// k*4, k=0..7\n"
-"	const int N)						// Total number of items to sort\n"
+"	const INDEX_T N)					// Total number of items to sort\n"
 "{\n"
 "	const int tid = (int)get_local_id(0);\n"
 "		\n"
-"const int4 gid4 = (int4)(get_global_id(0) << 2) + (const int4)(0,1,2,3);    \n"
+"const INDEX_T4 gid4 = GLOBAL_ID4;\n"
 "const int4 tid4 = (int4)(tid << 2) + (const int4)(0,1,2,3);\n"
 "	// Local memory\n"
 "	__local uint localBitsScan[WGZ_x4];\n"
@@ -157,11 +161,11 @@ char clCode_clppSort_RadixSort[]=
 "if (gid4.w < N) data[gid4.w] = localData[tid4.w];	\n"
 "}\n"
 "__kernel\n"
-"void kernel__localHistogram(__global KV_TYPE* data, const int bitOffset, __global uint* radixCount, __global uint* radixOffsets, const int N)\n"
+"void kernel__localHistogram(__global KV_TYPE* data, const int bitOffset, __global INDEX_T* radixCount, __global uint* radixOffsets, const INDEX_T N)\n"
 "{\n"
 "const int tid = (int)get_local_id(0);\n"
 "const int4 tid4 = (int4)(tid << 2) + (const int4)(0,1,2,3);\n"
-"	const int4 gid4 = (int4)(get_global_id(0) << 2) + (const int4)(0,1,2,3);\n"
+"	const INDEX_T4 gid4 = GLOBAL_ID4;\n"
 "	const int blockId = (int)get_group_id(0);\n"
 "	\n"
 "	__local uint localData[WGZ_x4];\n"
@@ -227,16 +231,16 @@ char clCode_clppSort_RadixSort[]=
 "void kernel__radixPermute(\n"
 "	__global const KV_TYPE* dataIn,\n"
 "	__global KV_TYPE* dataOut,\n"
-"	__global const int* histSum,\n"
+"	__global const INDEX_T* histSum,\n"
 "	__global const int* radixOffsets,\n"
 "	const uint bitOffset,\n"
-"	const uint N,\n"
+"	const INDEX_T N,\n"
 "	const int numBlocks)\n"
 "{\n"
-"const int4 gid4 = ((const int4)(get_global_id(0) << 2)) + (const int4)(0,1,2,3);\n"
+"const INDEX_T4 gid4 = GLOBAL_ID4;\n"
 "const int tid = get_local_id(0);\n"
 "const int4 tid4 = ((const int4)(tid << 2)) + (const int4)(0,1,2,3);\n"
-"__local int sharedHistSum[16];\n"
+"__local INDEX_T sharedHistSum[16];\n"
 "__local int localHistStart[16];\n"
 "if (tid < 16)\n"
 "{\n"
@@ -257,7 +261,7 @@ char clCode_clppSort_RadixSort[]=
 "myShiftedKeys[2] = EXTRACT_KEY_4BITS(myData[2], bitOffset);\n"
 "myShiftedKeys[3] = EXTRACT_KEY_4BITS(myData[3], bitOffset);\n"
 "	// Necessary ?\n"
-"uint4 finalOffset;\n"
+"INDEX_T4 finalOffset;\n"
 "finalOffset.x = tid4.x - localHistStart[myShiftedKeys[0]] + sharedHistSum[myShiftedKeys[0]];\n"
 "finalOffset.y = tid4.y - localHistStart[myShiftedKeys[1]] + sharedHistSum[myShiftedKeys[1]];\n"
 "finalOffset.z = tid4.z - localHistStart[myShiftedKeys[2]] + sharedHistSum[myShiftedKeys[2]];\n"
@@ -0,0 +1,111 @@
+#ifndef __CLPP_TIMER_H__
+#define __CLPP_TIMER_H__
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/// The accumulated time of a scope, in seconds
+struct clppTimerStats
+{
+	string path;				// The names of the enclosing scopes and of the scope : "window/sort/pass"
+	unsigned int depth;			// The number of enclosing scopes
+	size_t count;
+	double totalTime;
+	double minTime;
+	double maxTime;
+};
+
+/// Hierarchical host timers, on std::chrono::steady_clock.
+///
+/// A scope is timed by a clppScopedTimer, or between 'start' and 'stop'. The scopes nest : a scope started
+/// inside another one is accumulated under it, so the same name can be timed in several places (the passes
+/// of the sort of a window, the passes of a sort alone). Each thread accumulates in its own tree, without
+/// lock; the report merges the trees of all the threads, the ones that ended included.
+///
+/// The timers are disabled by default : a disabled timer costs a test.
+///
+/// \version 1.0
+class clppTimer
+{
+public:
+	typedef chrono::steady_clock Clock;
+
+	/// Enable or disable the timers. Set it before starting the timed threads.
+	static void setEnabled(bool enabled) { _enabled = enabled; }
+	static bool isEnabled() { return _enabled; }
+
+	/// Start a scope, inside the current scope of the thread (nothing when disabled)
+	static void start(const char* name);
+
+	/// End the current scope of the thread, returns its time in seconds (0 when disabled)
+	static double stop();
+
+	/// Returns the accumulated times of all the threads, each scope after its enclosing scope.
+	/// The timed threads must be idle.
+	static vector<clppTimerStats> getStats();
+
+	/// Print the accumulated times, in milliseconds
+	static void printStats();
+
+	/// Forget the accumulated times of all the threads
+	static void reset();
+
+private:
+	static bool _enabled;
+};
+
+/// Time the enclosing C++ scope with clppTimer, or up to 'stop'.
+///
+/// A disabled scope costs one test : the clock is not read, unless the scope is created with 'measure'
+/// to get its time from 'stop' whatever the state of the timers.
+///
+/// Ex : clppScopedTimer timer("sort");
+///      clppScopedTimer total("total", true); ... double seconds = total.stop();
+///
+/// \version 1.0
+class clppScopedTimer
+{
+public:
+	clppScopedTimer(const char* name, bool measure = false) : _running(clppTimer::isEnabled()), _measured(measure)
+	{
+		if (_running)
+			clppTimer::start(name);
+		if (_measured)
+			_start = clppTimer::Clock::now();
+	}
+
+	~clppScopedTimer() { stop(); }
+
+	clppScopedTimer(const clppScopedTimer&) = delete;
+	clppScopedTimer& operator=(const clppScopedTimer&) = delete;
+
+	/// End the scope before the end of the C++ scope. Returns the elapsed time in seconds : 0 when the timers
+	/// are disabled and the scope is not created with 'measure', or when the scope is already ended.
+	double stop()
+	{
+		double time = 0;
+		if (_running)
+			time = clppTimer::stop();
+		else if (_measured)
+			time = getElapsedTime();
+
+		_running = _measured = false;
+		return time;
+	}
+
+	/// Returns the time since the start in seconds, for a scope created with 'measure'
+	double getElapsedTime()
+	{
+		return chrono::duration<double>(clppTimer::Clock::now() - _start).count();
+	}
+
+private:
+	bool _running;
+	bool _measured;
+	clppTimer::Clock::time_point _start;
+};
+
+#endif
\ No newline at end of file
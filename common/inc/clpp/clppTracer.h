@@ -0,0 +1,53 @@
+#ifndef __CLPP_TRACER_H__
+#define __CLPP_TRACER_H__
+
+#include <string>
+
+#include "clpp/clppTimer.h"
+
+using namespace std;
+
+class clppProfiler;
+
+/// Timeline of the host and the device, written in the Chrome trace-event format (JSON) : open the file in
+/// chrome://tracing or in Perfetto (ui.perfetto.dev).
+///
+/// The host spans are the scopes of clppTimer, one row per thread : the timers must be enabled too. The device
+/// intervals are the kernels and the transfers of a clppProfiler (enabled), from START to END, moved to the
+/// host clock by a single offset for the whole trace : the gaps between the kernels of a window are the
+/// synchronizations.
+///
+/// The spans are kept until 'reset' : beyond 'setMaxSpans' spans (2^20 by default), the next ones are
+/// counted but not recorded. Call 'reset' (and clppProfiler::reset) between the phases of a long run.
+///
+/// Ex : clppTimer::setEnabled(true);
+///      clppTracer::setEnabled(true);
+///      context->getProfiler()->setEnabled(true);
+///      ...
+///      clppTracer::write("phold.json", context->getProfiler());
+///
+/// \version 1.0
+class clppTracer
+{
+public:
+	/// Enable or disable the recording of the host spans
+	static void setEnabled(bool enabled) { _enabled = enabled; }
+	static bool isEnabled() { return _enabled; }
+
+	/// Record a host span of the current thread (called by clppTimer)
+	static void addSpan(const string& name, clppTimer::Clock::time_point start, clppTimer::Clock::time_point end);
+
+	/// Write the host spans and the commands of 'profiler' (can be 0). Returns false when the file can't be written.
+	static bool write(const string& fileName, clppProfiler* profiler = 0);
+
+	/// Forget the recorded host spans
+	static void reset();
+
+	/// Set the maximum number of kept spans
+	static void setMaxSpans(size_t maxSpans);
+
+private:
+	static bool _enabled;
+};
+
+#endif
\ No newline at end of file
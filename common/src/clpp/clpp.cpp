@@ -2,27 +2,48 @@
 
 #include "clpp/clppScan_Default.h"
 #include "clpp/clppScan_GPU.h"
+#include "clpp/clppScan_Chained.h"
 
 #include "clpp/clppSort_RadixSort.h"
 #include "clpp/clppSort_RadixSortGPU.h"
+#include "clpp/clppSort_CPU.h"
 
-clppScan* clpp::createBestScan(clppContext* context, size_t valueSize, unsigned int maxElements)
+clppScan* clpp::createBestScan(clppContext* context, size_t valueSize, clppIndex maxElements)
 {
+	// Single pass when the device allows it, otherwise the multi-level scans
+	if (clppScan_Chained::isSupported(context))
+		return new clppScan_Chained(context, valueSize, maxElements);
+
 	if (context->isGPU)// && context->Vendor == clppVendor::Vendor_NVidia)
 		return new clppScan_GPU(context, valueSize, maxElements);
 
 	return new clppScan_Default(context, valueSize, maxElements);
 }
 
-clppSort* clpp::createBestSort(clppContext* context, unsigned int maxElements, unsigned int bits)
+clppScan* clpp::createBestScan(clppContext* context, const clppOperator& op, clppIndex maxElements)
+{
+	if (clppScan_Chained::isSupported(context))
+		return new clppScan_Chained(context, op, maxElements);
+
+	if (context->isGPU)
+		return new clppScan_GPU(context, op, maxElements);
+
+	return new clppScan_Default(context, op, maxElements);
+}
+
+clppSort* clpp::createBestSort(clppContext* context, clppIndex maxElements, unsigned int bits)
 {
 	if (context->isGPU)// && context->Vendor == clppVendor::Vendor_NVidia)
 		return new clppSort_RadixSortGPU(context, maxElements, bits, true);
 
+	// On a CPU device, the native sort is faster than the OpenCL kernels
+	if (context->isCPU)
+		return new clppSort_CPU(context, maxElements, bits, true);
+
 	return new clppSort_RadixSort(context, maxElements, bits, true);
 }
 
-clppSort* clpp::createBestSortKV(clppContext* context, unsigned int maxElements, unsigned int bits)
+clppSort* clpp::createBestSortKV(clppContext* context, clppIndex maxElements, unsigned int bits)
 {
 	if (context->isGPU)
 	{
@@ -30,6 +51,8 @@ clppSort* clpp::createBestSortKV(clppContext* context, unsigned int maxElements,
 	}
 
 	// CPU only and small sets
+	if (context->isCPU)
+		return new clppSort_CPU(context, maxElements, bits, false);
 
 	return new clppSort_RadixSort(context, maxElements, bits, false);
 }
@@ -0,0 +1,286 @@
+#include "clpp/clppBufferPool.h"
+#include "clpp/clppProgram.h"
+
+#include <algorithm>
+#include <cstring>
+
+#define MIN_SIZE_CLASS 256
+#define SLAB_SIZE (4 << 20)
+#define MAX_SLAB_CLASS (SLAB_SIZE / 8)
+
+#pragma region Constructor
+
+clppBufferPool::clppBufferPool(clppContext* context)
+{
+	_context = context;
+	memset(&_stats, 0, sizeof(_stats));
+
+	//---- The sub-buffers must start on the base address alignment of the device (given in bits)
+	cl_uint alignBits = 0;
+	clGetDeviceInfo(_context->clDevice, CL_DEVICE_MEM_BASE_ADDR_ALIGN, sizeof(cl_uint), &alignBits, NULL);
+
+	_minSizeClass = MIN_SIZE_CLASS;
+	while (_minSizeClass < alignBits / 8)
+		_minSizeClass <<= 1;
+}
+
+clppBufferPool::~clppBufferPool()
+{
+	//---- All the buffers, even the ones still in use : the context is going away
+	for(map<cl_mem, size_t>::iterator it = _usedBuffers.begin(); it != _usedBuffers.end(); it++)
+		clReleaseMemObject(it->first);
+
+	for(map<size_t, vector<cl_mem> >::iterator it = _freeBuffers.begin(); it != _freeBuffers.end(); it++)
+		for(size_t i = 0; i < it->second.size(); i++)
+			clReleaseMemObject(it->second[i]);
+
+	for(map<size_t, vector<cl_mem> >::iterator it = _freePinnedBuffers.begin(); it != _freePinnedBuffers.end(); it++)
+		for(size_t i = 0; i < it->second.size(); i++)
+			clReleaseMemObject(it->second[i]);
+
+	//---- Then the slabs of the sub-buffers
+	for(map<cl_mem, size_t>::iterator it = _slabUsers.begin(); it != _slabUsers.end(); it++)
+		clReleaseMemObject(it->first);
+}
+
+#pragma endregion
+
+#pragma region acquire / release
+
+cl_mem clppBufferPool::acquire(size_t bytes)
+{
+	size_t sizeClass = getSizeClass(bytes);
+	_stats.acquires++;
+
+	vector<cl_mem>& freeBuffers = _freeBuffers[sizeClass];
+
+	//---- The small classes : a new slab when there is no free sub-buffer
+	if (freeBuffers.empty() && sizeClass <= MAX_SLAB_CLASS)
+		carveSlab(sizeClass);
+
+	cl_mem clBuffer;
+	if (!freeBuffers.empty())
+	{
+		// Reuse a free buffer of the same class
+		clBuffer = freeBuffers.back();
+		freeBuffers.pop_back();
+	}
+	else
+	{
+		// The large classes : a dedicated buffer
+		clBuffer = createBuffer(getMemFlags(), sizeClass);
+	}
+
+	map<cl_mem, cl_mem>::iterator slab = _slabOf.find(clBuffer);
+	if (slab != _slabOf.end())
+		_slabUsers[slab->second]++;
+
+	_usedBuffers[clBuffer] = sizeClass;
+	_stats.inUseBytes += sizeClass;
+	_stats.peakInUseBytes = max(_stats.peakInUseBytes, _stats.inUseBytes);
+
+	return clBuffer;
+}
+
+cl_mem clppBufferPool::acquirePinned(size_t bytes)
+{
+	size_t sizeClass = getSizeClass(bytes);
+	_stats.acquires++;
+
+	//---- Reuse a free pinned buffer of the same class, otherwise a new one
+	vector<cl_mem>& freeBuffers = _freePinnedBuffers[sizeClass];
+
+	cl_mem clBuffer;
+	if (!freeBuffers.empty())
+	{
+		clBuffer = freeBuffers.back();
+		freeBuffers.pop_back();
+	}
+	else
+	{
+		clBuffer = createBuffer(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, sizeClass);
+		_pinnedBuffers.insert(clBuffer);
+		_stats.pinnedBytes += sizeClass;
+	}
+
+	_usedBuffers[clBuffer] = sizeClass;
+	_stats.inUseBytes += sizeClass;
+	_stats.peakInUseBytes = max(_stats.peakInUseBytes, _stats.inUseBytes);
+
+	return clBuffer;
+}
+
+cl_mem clppBufferPool::resizePinned(cl_mem clBuffer, size_t bytes)
+{
+	if (clBuffer)
+	{
+		map<cl_mem, size_t>::iterator used = _usedBuffers.find(clBuffer);
+		assert(used != _usedBuffers.end());
+		if (used != _usedBuffers.end() && used->second >= bytes)
+			return clBuffer;
+
+		release(clBuffer);
+	}
+
+	return acquirePinned(bytes);
+}
+
+void clppBufferPool::release(cl_mem clBuffer)
+{
+	if (!clBuffer)
+		return;
+
+	map<cl_mem, size_t>::iterator used = _usedBuffers.find(clBuffer);
+	assert(used != _usedBuffers.end());
+	if (used == _usedBuffers.end())
+		return;
+
+	size_t sizeClass = used->second;
+	_usedBuffers.erase(used);
+	_stats.inUseBytes -= sizeClass;
+
+	if (_pinnedBuffers.count(clBuffer))
+	{
+		_freePinnedBuffers[sizeClass].push_back(clBuffer);
+		return;
+	}
+
+	map<cl_mem, cl_mem>::iterator slab = _slabOf.find(clBuffer);
+	if (slab != _slabOf.end())
+		_slabUsers[slab->second]--;
+
+	_freeBuffers[sizeClass].push_back(clBuffer);
+}
+
+void clppBufferPool::carveSlab(size_t sizeClass)
+{
+	cl_mem slab = createBuffer(getMemFlags(), SLAB_SIZE);
+	_slabUsers[slab] = 0;
+
+	//---- Equal sub-buffers : the size classes are powers of 2, so they all start on the alignment
+	vector<cl_mem>& freeBuffers = _freeBuffers[sizeClass];
+	for(size_t offset = 0; offset + sizeClass <= SLAB_SIZE; offset += sizeClass)
+	{
+		cl_int clStatus;
+		cl_buffer_region region = { offset, sizeClass };
+		cl_mem clBuffer = clCreateSubBuffer(slab, CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &region, &clStatus);
+		clppProgram::checkCLStatus(clStatus);
+
+		_slabOf[clBuffer] = slab;
+		freeBuffers.push_back(clBuffer);
+	}
+}
+
+cl_mem clppBufferPool::createBuffer(cl_mem_flags flags, size_t sizeClass)
+{
+	cl_int clStatus;
+	cl_mem clBuffer = clCreateBuffer(_context->clContext, flags, sizeClass, NULL, &clStatus);
+	clppProgram::checkCLStatus(clStatus);
+
+	_stats.deviceAllocations++;
+	_stats.deviceBytes += sizeClass;
+	_stats.peakDeviceBytes = max(_stats.peakDeviceBytes, _stats.deviceBytes);
+
+	return clBuffer;
+}
+
+void clppBufferPool::trim()
+{
+	for(map<size_t, vector<cl_mem> >::iterator it = _freeBuffers.begin(); it != _freeBuffers.end(); it++)
+	{
+		vector<cl_mem> kept;
+		for(size_t i = 0; i < it->second.size(); i++)
+		{
+			cl_mem clBuffer = it->second[i];
+			map<cl_mem, cl_mem>::iterator slab = _slabOf.find(clBuffer);
+
+			if (slab == _slabOf.end())
+			{
+				// A dedicated buffer
+				clReleaseMemObject(clBuffer);
+				_stats.deviceBytes -= it->first;
+			}
+			else if (_slabUsers[slab->second] == 0)
+			{
+				// A sub-buffer of an unused slab
+				clReleaseMemObject(clBuffer);
+				_slabOf.erase(slab);
+			}
+			else
+				kept.push_back(clBuffer);
+		}
+
+		it->second.swap(kept);
+	}
+
+	//---- The free pinned buffers
+	for(map<size_t, vector<cl_mem> >::iterator it = _freePinnedBuffers.begin(); it != _freePinnedBuffers.end(); it++)
+	{
+		for(size_t i = 0; i < it->second.size(); i++)
+		{
+			clReleaseMemObject(it->second[i]);
+			_pinnedBuffers.erase(it->second[i]);
+			_stats.deviceBytes -= it->first;
+			_stats.pinnedBytes -= it->first;
+		}
+
+		it->second.clear();
+	}
+
+	//---- The unused slabs
+	for(map<cl_mem, size_t>::iterator it = _slabUsers.begin(); it != _slabUsers.end();)
+	{
+		if (it->second == 0)
+		{
+			clReleaseMemObject(it->first);
+			_stats.deviceBytes -= SLAB_SIZE;
+			_slabUsers.erase(it++);
+		}
+		else
+			it++;
+	}
+}
+
+cl_mem_flags clppBufferPool::getMemFlags()
+{
+	//---- In the host memory, so the host accesses them by mapping (clppMappedBuffer) without copy
+	if (_context->isHostUnified)
+		return CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR;
+
+	return CL_MEM_READ_WRITE;
+}
+
+#pragma endregion
+
+#pragma region Stats
+
+void clppBufferPool::resetPeaks()
+{
+	_stats.peakInUseBytes = _stats.inUseBytes;
+	_stats.peakDeviceBytes = _stats.deviceBytes;
+}
+
+void clppBufferPool::printStats()
+{
+	cout << "Buffer pool : " << _stats.inUseBytes / 1024 << " KB in use (peak " << _stats.peakInUseBytes / 1024 << " KB), "
+		<< _stats.deviceBytes / 1024 << " KB on the device (peak " << _stats.peakDeviceBytes / 1024 << " KB, " << _stats.pinnedBytes / 1024 << " KB pinned), "
+		<< _stats.acquires << " acquires, " << _stats.deviceAllocations << " device allocations" << endl;
+}
+
+size_t clppBufferPool::getSizeClass(size_t bytes)
+{
+	size_t sizeClass = _minSizeClass;
+	while (sizeClass < bytes)
+		sizeClass <<= 1;
+
+	//---- Above the slab classes, 8 classes per power of 2 : at most 12.5% of waste
+	if (sizeClass > MAX_SLAB_CLASS)
+	{
+		size_t step = sizeClass / 16;
+		sizeClass = ((bytes + step - 1) / step) * step;
+	}
+
+	return sizeClass;
+}
+
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,115 @@
+//------------------------------------------------------------
+// Purpose :
+// ---------
+// Stream compaction : write the selected elements of a data set, in order, into a dense buffer.
+//
+// Algorithm :
+// -----------
+// 1) Each element gets a 0/1 flag : a byte flag computed by another kernel, or a predicate on the value.
+// 2) An exclusive scan of the flags gives the destination of each selected element.
+// 3) Each selected element is written at its destination, and the last work-item writes the count.
+//
+// When there is no value buffer, the index of each selected element is written instead (a list of
+// the active items, to launch the next kernel only on them).
+//
+// The host defines :
+// VALUE_WORDS					The size of a value in 32 bits words
+// PREDICATE(X), T				The predicate mode : an expression of the value X, of type T
+// INDEX_T						The index type of the data set (uint, or ulong beyond 2^32 elements)
+//
+// References :
+// ------------
+// Parallel Prefix Sum (Scan) with CUDA. Mark Harris, Shubhabrata Sengupta, John D. Owens. GPU Gems 3.
+//------------------------------------------------------------
+
+#pragma OPENCL EXTENSION cl_amd_printf : enable
+
+#if VALUE_WORDS == 1
+#define V uint
+#elif VALUE_WORDS == 2
+#define V uint2
+#elif VALUE_WORDS == 4
+#define V uint4
+#endif
+
+//------------------------------------------------------------
+// isSelected
+//
+// Purpose : The flag of the element 'i'.
+//------------------------------------------------------------
+
+inline INDEX_T isSelected(__global const uint* values, __global const uchar* flags, const INDEX_T i)
+{
+#ifdef PREDICATE
+	T X = ((__global const T*)values)[i];
+	return (PREDICATE(X)) ? 1 : 0;
+#else
+	return (flags[i] != 0) ? 1 : 0;
+#endif
+}
+
+//------------------------------------------------------------
+// kernel__compactFlags
+//
+// Purpose : Write the 0/1 flag of each element, to be scanned.
+//------------------------------------------------------------
+
+__kernel
+void kernel__compactFlags(
+	__global const uint* values,
+	__global const uchar* flags,
+	__global INDEX_T* indices,
+	const INDEX_T N)
+{
+	const INDEX_T gid = get_global_id(0);
+	if (gid >= N)
+		return;
+
+	indices[gid] = isSelected(values, flags, gid);
+}
+
+//------------------------------------------------------------
+// kernel__compactScatter
+//
+// Purpose : Write each selected element at its scanned destination, and the count.
+//------------------------------------------------------------
+
+__kernel
+void kernel__compactScatter(
+	__global const uint* values,
+	__global const uchar* flags,
+	__global const INDEX_T* indices,
+	__global uint* output,
+	__global INDEX_T* count,
+	const INDEX_T N,
+	const uint outputIndices)
+{
+	const INDEX_T gid = get_global_id(0);
+	if (gid >= N)
+		return;
+
+	const INDEX_T selected = isSelected(values, flags, gid);
+	const INDEX_T dst = indices[gid];
+
+	if (gid == N - 1)
+		count[0] = dst + selected;
+
+	if (!selected)
+		return;
+
+	if (outputIndices)
+	{
+		((__global INDEX_T*)output)[dst] = gid;
+		return;
+	}
+
+#ifdef V
+	((__global V*)output)[dst] = ((__global const V*)values)[gid];
+#else
+	__global const uint* from = values + gid * VALUE_WORDS;
+	__global uint* to = output + dst * VALUE_WORDS;
+
+	for(uint i = 0; i < VALUE_WORDS; i++)
+		to[i] = from[i];
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include "clpp/clppCompact.h"
+#include "clpp/clppCompact_CLKernel.h"
+#include "clpp/clpp.h"
+#include "clpp/clppBufferPool.h"
+#include "clpp/clppProfiler.h"
+
+#pragma region Constructor
+
+clppCompact::clppCompact(clppContext* context, size_t valueSize, clppIndex maxElements)
+{
+	_valueSize = valueSize;
+	_predicate = "";
+	_context = context;
+
+	initialize(maxElements);
+}
+
+clppCompact::clppCompact(clppContext* context, clppDataType type, string predicate, clppIndex maxElements)
+{
+	_operator = clppOperator(type);
+	_valueSize = _operator.getValueSize();
+	_predicate = predicate;
+	_context = context;
+
+	initialize(maxElements);
+}
+
+void clppCompact::initialize(clppIndex maxElements)
+{
+	_values = 0;
+	_datasetSize = 0;
+	_clBuffer_values = 0;
+	_clBuffer_flags = 0;
+	_is_clBuffersOwner = false;
+	_clBuffer_indices = 0;
+	_clBuffer_output = 0;
+	_clBuffer_count = 0;
+	_workgroupSize = 128;
+	_scan = 0;
+
+	//---- Compilation (specialized for the value size and the predicate)
+	if (!compile(_context, clCode_clppCompact))
+		return;
+
+	//---- Prepare all the kernels
+	_kernel_Flags = clppKernelLauncher<cl_mem, cl_mem, cl_mem, clppIndex>(_context, getKernel("kernel__compactFlags"));
+
+	_kernel_Scatter = clppKernelLauncher<cl_mem, cl_mem, cl_mem, cl_mem, cl_mem, clppIndex, unsigned int>(_context, getKernel("kernel__compactScatter"));
+
+	//---- Prepare all the buffers
+	_clBuffer_indices = _context->getBufferPool()->acquire(sizeof(clppIndex) * maxElements);
+
+	// Large enough for the values, or for the indices when there is no value buffer
+	_clBuffer_output = _context->getBufferPool()->acquire(max(_valueSize, sizeof(clppIndex)) * maxElements);
+
+	_clBuffer_count = _context->getBufferPool()->acquire(sizeof(clppIndex));
+
+	//---- The scan of the flags
+	_scan = clpp::createBestScan(_context, clppOperator(clppDataType_Index), maxElements);
+}
+
+clppCompact::~clppCompact()
+{
+	if (_is_clBuffersOwner && _clBuffer_values)
+		_context->getBufferPool()->release(_clBuffer_values);
+
+	if (_clBuffer_indices)
+		_context->getBufferPool()->release(_clBuffer_indices);
+
+	if (_clBuffer_output)
+		_context->getBufferPool()->release(_clBuffer_output);
+
+	if (_clBuffer_count)
+		_context->getBufferPool()->release(_clBuffer_count);
+
+	delete _scan;
+}
+
+#pragma endregion
+
+#pragma region compilePreprocess
+
+string clppCompact::compilePreprocess(string kernel)
+{
+	ostringstream source;
+
+	source << "#define VALUE_WORDS " << (_valueSize / sizeof(cl_uint)) << endl;
+
+	if (_predicate.length() > 0)
+	{
+		source << _operator.getDefines();
+		source << "#define PREDICATE(X) (" << _predicate << ")" << endl;
+	}
+
+	return clppProgram::compilePreprocess(source.str() + kernel);
+}
+
+#pragma endregion
+
+#pragma region compact
+
+void clppCompact::compact()
+{
+	cl_int clStatus;
+
+	clppIndex N = _datasetSize;
+	if (N == 0)
+	{
+		static const clppIndex zero = 0;
+		clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_count, CL_FALSE, 0, sizeof(clppIndex), &zero, 0, NULL, NULL);
+		checkCLStatus(clStatus);
+		return;
+	}
+
+	size_t global = toMultipleOf(N, _workgroupSize);
+
+	//---- 1) The flags
+	clStatus = _kernel_Flags.launch(global, _workgroupSize, _clBuffer_values, _clBuffer_flags, _clBuffer_indices, N);
+	checkCLStatus(clStatus);
+
+	//---- 2) The destinations (exclusive scan, in place)
+	_scan->pushCLDatas(_clBuffer_indices, _datasetSize);
+	_scan->scan();
+
+	//---- 3) The selected elements and the count
+	unsigned int outputIndices = (_clBuffer_values == 0) ? 1 : 0;
+
+	clStatus = _kernel_Scatter.launch(global, _workgroupSize, _clBuffer_values, _clBuffer_flags, _clBuffer_indices, _clBuffer_output, _clBuffer_count, N, outputIndices);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
+
+#pragma region pushDatas
+
+void clppCompact::pushDatas(void* values, size_t datasetSize)
+{
+	cl_int clStatus;
+
+	//---- Store some values
+	_values = values;
+	_datasetSize = datasetSize;
+
+	//---- Copy on the device, through a pinned buffer of the buffer pool
+	if (!_is_clBuffersOwner)
+		_clBuffer_values = 0;
+
+	_clBuffer_values = _context->getBufferPool()->resizePinned(_clBuffer_values, _valueSize * _datasetSize);
+	_is_clBuffersOwner = true;
+
+	clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_values, CL_FALSE, 0, _valueSize * _datasetSize, _values, 0, 0, 0);
+	checkCLStatus(clStatus);
+}
+
+void clppCompact::pushCLDatas(cl_mem clBuffer_values, size_t datasetSize)
+{
+	if (_is_clBuffersOwner && _clBuffer_values)
+		_context->getBufferPool()->release(_clBuffer_values);
+
+	_is_clBuffersOwner = false;
+
+	_values = 0;
+	_clBuffer_values = clBuffer_values;
+	_datasetSize = datasetSize;
+}
+
+void clppCompact::pushCLFlags(cl_mem clBuffer_flags)
+{
+	_clBuffer_flags = clBuffer_flags;
+}
+
+#pragma endregion
+
+#pragma region popDatas
+
+clppIndex clppCompact::popCount()
+{
+	clppIndex count = 0;
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_count, CL_TRUE, 0, sizeof(clppIndex), &count, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+
+	return count;
+}
+
+void clppCompact::popDatas(void* dataSet)
+{
+	clppIndex count = popCount();
+	if (count == 0)
+		return;
+
+	size_t elementSize = (_clBuffer_values == 0) ? sizeof(clppIndex) : _valueSize;
+
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_output, CL_TRUE, 0, elementSize * count, dataSet, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
\ No newline at end of file
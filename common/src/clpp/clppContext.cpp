@@ -1,4 +1,6 @@
 #include "clpp/clppContext.h"
+#include "clpp/clppBufferPool.h"
+#include "clpp/clppProfiler.h"
 
 #include<assert.h>
 #include <iostream>
@@ -7,6 +9,18 @@
 
 using namespace std;
 
+clppContext::clppContext()
+{
+	_bufferPool = 0;
+	_profiler = 0;
+}
+
+clppContext::~clppContext()
+{
+	delete _bufferPool;
+	delete _profiler;
+}
+
 void clppContext::setup()
 {
 	setup(0, 0);
@@ -14,7 +28,7 @@ void clppContext::setup()
 
 void clppContext::setup(cl_platform_id platform, cl_device_id device, cl_context context, cl_command_queue queue)
 {
-	isGPU = isCPU = false;
+	isGPU = isCPU = isHostUnified = false;
 	Vendor = Vendor_Unknown;
 
 	cl_int clStatus;
@@ -45,6 +59,11 @@ void clppContext::setup(cl_platform_id platform, cl_device_id device, cl_context
 	if (infoType & CL_DEVICE_TYPE_GPU)
 		isGPU = true;
 
+	// The device works in the host memory : the buffers are mapped instead of copied
+	cl_bool hostUnified = CL_FALSE;
+	clGetDeviceInfo(clDevice, CL_DEVICE_HOST_UNIFIED_MEMORY, sizeof(hostUnified), &hostUnified, NULL);
+	isHostUnified = isCPU || hostUnified;
+
 	//---- Context
 	clContext = context;
 
@@ -54,7 +73,7 @@ void clppContext::setup(cl_platform_id platform, cl_device_id device, cl_context
 
 void clppContext::setup(unsigned int platformId, unsigned int deviceId)
 {
-	isGPU = isCPU = false;
+	isGPU = isCPU = isHostUnified = false;
 	Vendor = Vendor_Unknown;
 
 	cl_int clStatus;
@@ -106,6 +125,11 @@ void clppContext::setup(unsigned int platformId, unsigned int deviceId)
 	if (infoType & CL_DEVICE_TYPE_GPU)
 		isGPU = true;
 
+	// The device works in the host memory : the buffers are mapped instead of copied
+	cl_bool hostUnified = CL_FALSE;
+	clGetDeviceInfo(clDevice, CL_DEVICE_HOST_UNIFIED_MEMORY, sizeof(hostUnified), &hostUnified, NULL);
+	isHostUnified = isCPU || hostUnified;
+
 	//---- Context
 	clContext = clCreateContext(0, 1, &clDevice, NULL, NULL, &clStatus);
 	assert(clStatus == CL_SUCCESS);
@@ -191,4 +215,20 @@ void clppContext::printInformation()
 
 	cout << "OpenCL Platform : " << platformName << endl;
 	cout << "OpenCL Device   : " << deviceName << endl << endl<< endl;
+}
+
+clppBufferPool* clppContext::getBufferPool()
+{
+	if (!_bufferPool)
+		_bufferPool = new clppBufferPool(this);
+
+	return _bufferPool;
+}
+
+clppProfiler* clppContext::getProfiler()
+{
+	if (!_profiler)
+		_profiler = new clppProfiler(this);
+
+	return _profiler;
 }
\ No newline at end of file
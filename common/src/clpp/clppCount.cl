@@ -1,48 +1,139 @@
-#define T int
+//------------------------------------------------------------
+// Purpose :
+// ---------
+// Count the occurrences of each key in a data set (a histogram with one bin per key).
+//
+// Algorithm :
+// -----------
+// 1) A few work-groups per compute unit : each work-group counts its elements (grid-stride loop) with
+//    atomics on counters in local memory, then writes its counters, bin-major : blocks[bin * groups + group].
+//    When the counters do not fit in local memory, each work-group counts in its row of a global buffer.
+// 2) An exclusive scan of the blocks : blocks[bin * groups + group] is then the first position of the
+//    elements of 'bin' counted by 'group', as in a counting sort.
+// 3) The count of each bin is the difference of two consecutive bins in the scanned blocks.
+//
+// The bin of a value is the value itself (the values outside [0, COUNTINGS[ are not counted), or the
+// index of the value in a table of keys. The table is sorted by the host, with the bin of each key : it is
+// searched linearly, or by a binary search for many keys.
+//
+// The host defines :
+// T						The data type of the values (uint or ulong)
+// COUNTINGS				The number of bins
+// KEYS_BINARY_SEARCH		The keys are found by a binary search
+// GLOBAL_COUNTERS			The counters and the keys are in global memory
+// INDEX_T					The index type of the data set (uint, or ulong beyond 2^32 elements)
+//------------------------------------------------------------
 
-#define KEY_VALUE_1 1
-#define KEY_VALUE_2 2
-#define KEY_VALUE_3 4
-#define KEY_VALUE_4 8
-#define KEY_VALUE_5 16
+#pragma OPENCL EXTENSION cl_amd_printf : enable
+
+//------------------------------------------------------------
+// kernel__count
+//
+// Purpose : 1) Count the elements of each work-group in local memory.
+//------------------------------------------------------------
 
 __kernel
-void kernel__Count(
-	__global T* dataSet,
-	__global int* countingBlocks,
-	uint countings,
-	uint valuesPerWorkgroup,
-	uint datasetSize
-)
+void kernel__count(
+	__global const T* data,
+	__global const T* keys,
+	__global const uint* keyBins,
+	__global uint* groupCounters,
+	__global INDEX_T* blocks,
+	const INDEX_T N,
+	const uint useKeys)
 {
-	size_t gid = get_global_id(0);
-	
-	if (gid >= datasetSize)
-		return;
-		
-	uint blockOffset = countings * get_group_id(0);
-	uint valuesOffset = get_group_id(0);
-	
-	// Each workgroup will count 'valuesPerWorkgroup' elements
-	for(uint i = 0; i < valuesPerWorkgroup; i++)
+	const uint lid = get_local_id(0);
+	const uint lsz = get_local_size(0);
+	const INDEX_T gid = get_global_id(0);
+	const INDEX_T gsz = get_global_size(0);
+	const uint groups = get_num_groups(0);
+
+#ifdef GLOBAL_COUNTERS
+	__global uint* counters = groupCounters + get_group_id(0) * COUNTINGS;
+	__global const T* binKeys = keys;
+	__global const uint* binOfKey = keyBins;
+
+	for(uint b = lid; b < COUNTINGS; b += lsz)
+		counters[b] = 0;
+	barrier(CLK_GLOBAL_MEM_FENCE);
+#else
+	__local uint counters[COUNTINGS];
+	__local T binKeys[COUNTINGS];
+	__local uint binOfKey[COUNTINGS];
+
+	for(uint b = lid; b < COUNTINGS; b += lsz)
 	{
-		switch(dataSet[valuesOffset + i])
+		counters[b] = 0;
+		if (useKeys)
 		{
-			case KEY_VALUE_1:
-				countingBlocks[blockOffset]++;
-				break;
-			case KEY_VALUE_2:
-				countingBlocks[blockOffset+1]++;
-				break;
-			case KEY_VALUE_3:
-				countingBlocks[blockOffset+2]++;
-				break;
-			case KEY_VALUE_4:
-				countingBlocks[blockOffset+3]++;
-				break;
-			case KEY_VALUE_5:
-				countingBlocks[blockOffset+4]++;
-				break;
+			binKeys[b] = keys[b];
+			binOfKey[b] = keyBins[b];
 		}
 	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+#endif
+
+	for(INDEX_T i = gid; i < N; i += gsz)
+	{
+		const T value = data[i];
+		uint bin = COUNTINGS;
+
+		if (useKeys)
+		{
+#ifdef KEYS_BINARY_SEARCH
+			uint first = 0;
+			uint last = COUNTINGS;
+			while (first < last)
+			{
+				const uint middle = (first + last) >> 1;
+				if (binKeys[middle] < value)
+					first = middle + 1;
+				else
+					last = middle;
+			}
+			if (first < COUNTINGS && binKeys[first] == value)
+				bin = binOfKey[first];
+#else
+			for(uint b = 0; b < COUNTINGS; b++)
+				if (binKeys[b] == value) { bin = binOfKey[b]; break; }
+#endif
+		}
+		else if (value < COUNTINGS)
+			bin = (uint)value;
+
+		if (bin < COUNTINGS)
+			atomic_inc(&counters[bin]);
+	}
+
+#ifdef GLOBAL_COUNTERS
+	barrier(CLK_GLOBAL_MEM_FENCE);
+#else
+	barrier(CLK_LOCAL_MEM_FENCE);
+#endif
+
+	for(uint b = lid; b < COUNTINGS; b += lsz)
+		blocks[b * groups + get_group_id(0)] = counters[b];
+
+	// The last block is the total after the scan
+	if (gid == 0)
+		blocks[COUNTINGS * groups] = 0;
+}
+
+//------------------------------------------------------------
+// kernel__countTotals
+//
+// Purpose : 3) The count of each bin, from the scanned blocks.
+//------------------------------------------------------------
+
+__kernel
+void kernel__countTotals(
+	__global const INDEX_T* blocks,
+	__global INDEX_T* countings,
+	const uint groups)
+{
+	const uint b = get_global_id(0);
+	if (b >= COUNTINGS)
+		return;
+
+	countings[b] = blocks[(b + 1) * groups] - blocks[b * groups];
 }
\ No newline at end of file
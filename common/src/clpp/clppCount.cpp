@@ -1,11 +1,19 @@
 #include "clpp/clppCount.h"
-//#include "clpp/clppCount_CLKernel.h"
+#include "clpp/clppCount_CLKernel.h"
 #include "clpp/clpp.h"
+#include "clpp/clppBufferPool.h"
+#include "clpp/clppProfiler.h"
+
+#include <algorithm>
+#include <vector>
+
+// Beyond this number of keys, the bin of a key is found by a binary search
+#define KEYS_LINEAR_SEARCH_MAX 16
 
 #pragma region Constructor
 
-clppCount::clppCount(clppContext* context, size_t valueSize, unsigned int countings, unsigned int maxElements) :
-	clppProgram() 
+clppCount::clppCount(clppContext* context, size_t valueSize, unsigned int countings, clppIndex maxElements) :
+	clppProgram()
 {
 	_values = 0;
 	_context = context;
@@ -13,53 +21,93 @@ clppCount::clppCount(clppContext* context, size_t valueSize, unsigned int counti
 	_countings = countings;
 	_datasetSize = 0;
 	_clBuffer_values = 0;
-	_workgroupSize = 0;
+	_workgroupSize = 256;
+	_workgroups = 1;
 	_is_clBuffersOwner = false;
+	_clBuffer_keys = 0;
+	_clBuffer_keyBins = 0;
+	_useKeys = false;
+	_clBuffer_counters = 0;
 	_clBuffer_CountingBlocks = 0;
-	_countingsBuffer = 0;
 	_clBuffer_Countings = 0;
+	_scan = 0;
 
-	//if (!compile(context, clCode_clppScan_Default))
-	//	return;
+	//---- The counters and the keys are in local memory when they fit (half of the local memory)
+	cl_ulong localMemory = 0;
+	clGetDeviceInfo(context->clDevice, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(cl_ulong), &localMemory, NULL);
+	_globalCounters = ((cl_ulong)_countings * (2 * sizeof(cl_uint) + _valueSize) > localMemory / 2);
 
-	if (!compile(context, string("clppCount.cl")))
+	if (!compile(context, clCode_clppCount))
 		return;
 
 	//---- Prepare all the kernels
-	cl_int clStatus;
+	_kernel_Count = getKernel("kernel__count");
 
-	_kernel_Count = clCreateKernel(_clProgram, "kernel__Count", &clStatus);
-	checkCLStatus(clStatus);
+	_kernel_Totals = getKernel("kernel__countTotals");
+
+	//---- A few work-groups per compute unit : the fewer blocks, the smaller the scan
+	cl_uint computeUnits = 1;
+	clGetDeviceInfo(context->clDevice, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(cl_uint), &computeUnits, NULL);
+	_workgroups = max((size_t)computeUnits * 4, (size_t)1);
 
-	//---- Get the workgroup size
-	clGetKernelWorkGroupInfo(_kernel_Count, _context->clDevice, CL_KERNEL_WORK_GROUP_SIZE, sizeof(size_t), &_workgroupSize, 0);
-	//_workgroupSize = 128;
-	//_workgroupSize = 256;
-	//_workgroupSize = 512;
-	//clGetKernelWorkGroupInfo(_kernel_Scan, _context->clDevice, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE, sizeof(size_t), &_workgroupSize, 0);
+	//---- Prepare all the buffers
+	unsigned int blocksCount = _countings * _workgroups + 1;
 
-	string scanExpression = "#define OPERATOR_APPLY(DATA,INDEX1,INDEX2) DATA[INDEX1]+DATA[INDEX2]";
+	_clBuffer_CountingBlocks = _context->getBufferPool()->acquire(blocksCount * sizeof(clppIndex));
 
-//#define T int
-//#define OPERATOR_APPLY(A,B) A+B
-//#define OPERATOR_IDENTITY 0
+	_clBuffer_Countings = _context->getBufferPool()->acquire(_countings * sizeof(clppIndex));
 
-	_scan = clpp::createBestScan(context, sizeof(int), maxElements);
+	_clBuffer_keys = _context->getBufferPool()->acquire(_countings * _valueSize);
+
+	_clBuffer_keyBins = _context->getBufferPool()->acquire(_countings * sizeof(cl_uint));
+
+	if (_globalCounters)
+		_clBuffer_counters = _context->getBufferPool()->acquire(_countings * _workgroups * sizeof(cl_uint));
+
+	_scan = clpp::createBestScan(context, clppOperator(clppDataType_Index), blocksCount);
 }
 
 clppCount::~clppCount()
 {
 	if (_is_clBuffersOwner && _clBuffer_values)
-		clReleaseMemObject(_clBuffer_values);
+		_context->getBufferPool()->release(_clBuffer_values);
 
 	if (_clBuffer_CountingBlocks)
-		clReleaseMemObject(_clBuffer_CountingBlocks);
+		_context->getBufferPool()->release(_clBuffer_CountingBlocks);
 
-	if (_clBuffer_CountingBlocks)
-	{
-		clReleaseMemObject(_clBuffer_Countings);
-		free(_countingsBuffer);
-	}
+	if (_clBuffer_Countings)
+		_context->getBufferPool()->release(_clBuffer_Countings);
+
+	if (_clBuffer_keys)
+		_context->getBufferPool()->release(_clBuffer_keys);
+
+	if (_clBuffer_keyBins)
+		_context->getBufferPool()->release(_clBuffer_keyBins);
+
+	if (_clBuffer_counters)
+		_context->getBufferPool()->release(_clBuffer_counters);
+
+	delete _scan;
+}
+
+#pragma endregion
+
+#pragma region compilePreprocess
+
+string clppCount::compilePreprocess(string kernel)
+{
+	ostringstream source;
+
+	source << "#define T " << ((_valueSize == sizeof(cl_ulong)) ? "ulong" : "uint") << endl;
+	source << "#define COUNTINGS " << _countings << endl;
+
+	if (_countings > KEYS_LINEAR_SEARCH_MAX)
+		source << "#define KEYS_BINARY_SEARCH" << endl;
+
+	if (_globalCounters)
+		source << "#define GLOBAL_COUNTERS" << endl;
+
+	return clppProgram::compilePreprocess(source.str() + kernel);
 }
 
 #pragma endregion
@@ -70,117 +118,129 @@ void clppCount::count()
 {
 	cl_int clStatus;
 
-	//---- Local count
-	unsigned int valuesPerWorkgroup = _datasetSize / _workgroupSize;
-	size_t globalWorkSize = {toMultipleOf(_datasetSize, _workgroupSize)};
+	//---- 1) Local count, each work-item counts at least 16 elements
+	clppIndex N = _datasetSize;
+	size_t itemsPerWorkgroup = _workgroupSize * 16;
+	unsigned int workgroups = (unsigned int)min(_workgroups, max((N + itemsPerWorkgroup - 1) / itemsPerWorkgroup, (size_t)1));
+	unsigned int useKeys = _useKeys ? 1 : 0;
+
+	size_t globalWorkSize = {workgroups * _workgroupSize};
 	size_t localWorkSize = {_workgroupSize};
 
-	clStatus = clSetKernelArg(_kernel_Count, 0, sizeof(cl_mem), &_clBuffer_values);
-	clStatus |= clSetKernelArg(_kernel_Count, 1, sizeof(cl_mem), &_clBuffer_CountingBlocks);
-	clStatus |= clSetKernelArg(_kernel_Count, 2, sizeof(int), &_countings);
-	clStatus |= clSetKernelArg(_kernel_Count, 3, sizeof(int), &valuesPerWorkgroup);
-	clStatus |= clSetKernelArg(_kernel_Count, 4, sizeof(int), &_datasetSize);
+	clStatus  = clSetKernelArg(_kernel_Count, 0, sizeof(cl_mem), &_clBuffer_values);
+	clStatus |= clSetKernelArg(_kernel_Count, 1, sizeof(cl_mem), &_clBuffer_keys);
+	clStatus |= clSetKernelArg(_kernel_Count, 2, sizeof(cl_mem), &_clBuffer_keyBins);
+	clStatus |= clSetKernelArg(_kernel_Count, 3, sizeof(cl_mem), &_clBuffer_counters);
+	clStatus |= clSetKernelArg(_kernel_Count, 4, sizeof(cl_mem), &_clBuffer_CountingBlocks);
+	clStatus |= clSetKernelArg(_kernel_Count, 5, sizeof(clppIndex), &N);
+	clStatus |= clSetKernelArg(_kernel_Count, 6, sizeof(unsigned int), &useKeys);
 
-	clStatus |= clEnqueueNDRangeKernel(_context->clQueue, _kernel_Count, 1, NULL, &globalWorkSize, &localWorkSize, 0, NULL, NULL);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Count, 1, NULL, &globalWorkSize, &localWorkSize, 0, NULL, NULL);
 	checkCLStatus(clStatus);
 
-	//---- Scan to retreive the totals
-	_scan->pushCLDatas(_clBuffer_CountingBlocks, globalWorkSize);
+	//---- 2) Scan to retreive the offsets
+	_scan->pushCLDatas(_clBuffer_CountingBlocks, _countings * workgroups + 1);
 	_scan->scan();
+
+	//---- 3) The totals
+	globalWorkSize = toMultipleOf(_countings, _workgroupSize);
+
+	clStatus  = clSetKernelArg(_kernel_Totals, 0, sizeof(cl_mem), &_clBuffer_CountingBlocks);
+	clStatus |= clSetKernelArg(_kernel_Totals, 1, sizeof(cl_mem), &_clBuffer_Countings);
+	clStatus |= clSetKernelArg(_kernel_Totals, 2, sizeof(unsigned int), &workgroups);
+
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Totals, 1, NULL, &globalWorkSize, &localWorkSize, 0, NULL, NULL);
+	checkCLStatus(clStatus);
 }
 
 #pragma endregion
 
 #pragma region pushDatas
 
-void clppCount::pushDatas(void* values, size_t datasetSize)
+// Sort the keys, with the bin of each key : its index in 'keys'. Equal keys keep the first bin.
+template<typename T>
+static void sortKeys(const T* keys, unsigned int count, vector<T>& sortedKeys, vector<unsigned int>& bins)
 {
-	cl_int clStatus;
-
-	//---- Store some values
-	_values = values;
-	bool reallocate = datasetSize > _datasetSize || !_is_clBuffersOwner;
-	bool recompute =  datasetSize != _datasetSize;
-	_datasetSize = datasetSize;
-
-	//---- Allocate the results buffer
-	if (!_countingsBuffer)
+	vector<pair<T, unsigned int> > sorted(count);
+	for(unsigned int i = 0; i < count; i++)
+		sorted[i] = make_pair(keys[i], i);
+	sort(sorted.begin(), sorted.end());
+
+	sortedKeys.resize(count);
+	bins.resize(count);
+	for(unsigned int i = 0; i < count; i++)
 	{
-		_countingsBuffer = (unsigned int*)malloc(_countings * sizeof(int));
-		_clBuffer_Countings  = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, _countings * sizeof(int), 0, &clStatus);
+		sortedKeys[i] = sorted[i].first;
+		bins[i] = sorted[i].second;
 	}
+}
 
-	//---- Compute the number of temporary blocks
-	if (recompute)
-	{
-		int workgroupsCount = (_datasetSize + _workgroupSize-1) / _workgroupSize;
-		int blocksCount = _countings * workgroupsCount;
-
-		if (_clBuffer_CountingBlocks)
-			clReleaseMemObject(_clBuffer_CountingBlocks);
+void clppCount::setKeys(void* keys)
+{
+	_useKeys = (keys != 0);
+	if (!_useKeys || _countings == 0)
+		return;
 
-		_clBuffer_CountingBlocks  = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, blocksCount * sizeof(int), NULL, &clStatus);
-	}
+	vector<unsigned int> bins;
+	cl_int clStatus;
 
-	//---- Copy on the device
-	if (reallocate)
+	if (_valueSize == sizeof(cl_ulong))
 	{
-		//---- Release
-		if (_clBuffer_values)
-			clReleaseMemObject(_clBuffer_values);
-
-		_clBuffer_values  = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, _valueSize * _datasetSize, _values, &clStatus);
-		_is_clBuffersOwner = true;
-		checkCLStatus(clStatus);
+		vector<unsigned long long> sortedKeys;
+		sortKeys((const unsigned long long*)keys, _countings, sortedKeys, bins);
+		clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_keys, CL_TRUE, 0, _countings * _valueSize, &sortedKeys[0], 0, 0, 0);
 	}
 	else
-		// Just resend
-		clEnqueueWriteBuffer(_context->clQueue, _clBuffer_values, CL_FALSE, 0, _valueSize * _datasetSize, _values, 0, 0, 0);
+	{
+		vector<unsigned int> sortedKeys;
+		sortKeys((const unsigned int*)keys, _countings, sortedKeys, bins);
+		clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_keys, CL_TRUE, 0, _countings * _valueSize, &sortedKeys[0], 0, 0, 0);
+	}
+
+	clStatus |= _context->getProfiler()->enqueueWriteBuffer(_clBuffer_keyBins, CL_TRUE, 0, _countings * sizeof(cl_uint), &bins[0], 0, 0, 0);
+	checkCLStatus(clStatus);
 }
 
-void clppCount::pushCLDatas(cl_mem clBuffer_values, size_t datasetSize)
+void clppCount::pushDatas(void* values, size_t datasetSize)
 {
 	cl_int clStatus;
 
-	_values = 0;
-	_clBuffer_values = clBuffer_values;
-	bool recompute =  datasetSize != _datasetSize;
+	//---- Store some values
+	_values = values;
 	_datasetSize = datasetSize;
 
-	//---- Allocate the results buffer
-	if (!_countingsBuffer)
-	{
-		_countingsBuffer = (unsigned int*)malloc(_countings * sizeof(int));
-		_clBuffer_Countings  = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, _countings * sizeof(int), 0, &clStatus);
-	}
+	//---- Copy on the device, through a pinned buffer of the buffer pool
+	if (!_is_clBuffersOwner)
+		_clBuffer_values = 0;
 
-	//---- Compute the number of needed blocks
-	if (recompute)
-	{
-		int blocksCount = _countings * (_datasetSize + _workgroupSize-1) / _workgroupSize;
+	_clBuffer_values = _context->getBufferPool()->resizePinned(_clBuffer_values, _valueSize * _datasetSize);
+	_is_clBuffersOwner = true;
 
-		if (_clBuffer_CountingBlocks)
-			clReleaseMemObject(_clBuffer_CountingBlocks);
+	clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_values, CL_FALSE, 0, _valueSize * _datasetSize, _values, 0, 0, 0);
+	checkCLStatus(clStatus);
+}
 
-		_clBuffer_CountingBlocks  = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, blocksCount * sizeof(int), 0, &clStatus);
-	}
+void clppCount::pushCLDatas(cl_mem clBuffer_values, size_t datasetSize)
+{
+	_values = 0;
+
+	//---- Give back the buffer of 'pushDatas'
+	if (_is_clBuffersOwner && _clBuffer_values)
+		_context->getBufferPool()->release(_clBuffer_values);
 
 	_is_clBuffersOwner = false;
+
+	_clBuffer_values = clBuffer_values;
+	_datasetSize = datasetSize;
 }
 
 #pragma endregion
 
 #pragma region popDatas
 
-void clppCount::popDatas()
-{
-	cl_int clStatus = clEnqueueReadBuffer(_context->clQueue, _clBuffer_values, CL_TRUE, 0, _valueSize * _datasetSize, _values, 0, NULL, NULL);
-	checkCLStatus(clStatus);
-}
-
-void clppCount::popDatas(void* dataSet)
+void clppCount::popDatas(clppIndex* countings)
 {
-	cl_int clStatus = clEnqueueReadBuffer(_context->clQueue, _clBuffer_values, CL_TRUE, 0, _valueSize * _datasetSize, dataSet, 0, NULL, NULL);
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_Countings, CL_TRUE, 0, _countings * sizeof(clppIndex), countings, 0, NULL, NULL);
 	checkCLStatus(clStatus);
 }
 
@@ -0,0 +1,107 @@
+//------------------------------------------------------------
+// Purpose :
+// ---------
+// Histogram of a data set, with a configurable bin function (integer key, float range, bit-field or custom).
+//
+// Algorithm :
+// -----------
+// 1) A few work-groups per compute unit : each work-group builds a private histogram of its elements
+//    (grid-stride loop) with atomics in local memory, then writes it to its row of the partial histograms.
+//    When the bins do not fit in local memory, the atomics are done directly on the row in global memory.
+// 2) The merge : each bin sums its column of the partial histograms.
+//
+// The host defines :
+// T						The data type of the values
+// BINS						The number of bins
+// BIN(X)					The bin of the value X (the bins outside [0, BINS[ are not counted). It can use the
+//							kernel arguments 'rangeMin', 'rangeScale' and 'shift'.
+// GLOBAL_BINS				The private histograms are in global memory
+//------------------------------------------------------------
+
+#pragma OPENCL EXTENSION cl_amd_printf : enable
+
+//------------------------------------------------------------
+// kernel__histogram
+//
+// Purpose : 1) The private histogram of each work-group.
+//------------------------------------------------------------
+
+__kernel
+void kernel__histogram(
+	__global const T* data,
+	__global uint* partials,
+	const uint N,
+	const float rangeMin,
+	const float rangeScale,
+	const uint shift)
+{
+	const uint lid = get_local_id(0);
+	const uint lsz = get_local_size(0);
+	const uint gid = get_global_id(0);
+	const uint gsz = get_global_size(0);
+
+#ifdef GLOBAL_BINS
+	__global uint* bins = partials + get_group_id(0) * BINS;
+#else
+	__local uint bins[BINS];
+
+	for(uint b = lid; b < BINS; b += lsz)
+		bins[b] = 0;
+	barrier(CLK_LOCAL_MEM_FENCE);
+#endif
+
+	for(uint i = gid; i < N; i += gsz)
+	{
+		const T X = data[i];
+		const uint bin = BIN(X);
+
+		if (bin < BINS)
+			atomic_inc(&bins[bin]);
+	}
+
+#ifndef GLOBAL_BINS
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for(uint b = lid; b < BINS; b += lsz)
+		partials[get_group_id(0) * BINS + b] = bins[b];
+#endif
+}
+
+//------------------------------------------------------------
+// kernel__histogramClear
+//
+// Purpose : Clear the partial histograms (only when they are updated in global memory).
+//------------------------------------------------------------
+
+__kernel
+void kernel__histogramClear(
+	__global uint* partials,
+	const uint count)
+{
+	const uint gid = get_global_id(0);
+	if (gid < count)
+		partials[gid] = 0;
+}
+
+//------------------------------------------------------------
+// kernel__histogramMerge
+//
+// Purpose : 2) Sum the partial histograms.
+//------------------------------------------------------------
+
+__kernel
+void kernel__histogramMerge(
+	__global const uint* partials,
+	__global uint* histogram,
+	const uint groups)
+{
+	const uint b = get_global_id(0);
+	if (b >= BINS)
+		return;
+
+	uint sum = 0;
+	for(uint g = 0; g < groups; g++)
+		sum += partials[g * BINS + b];
+
+	histogram[b] = sum;
+}
\ No newline at end of file
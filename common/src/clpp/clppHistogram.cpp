@@ -0,0 +1,223 @@
+#include "clpp/clppHistogram.h"
+#include "clpp/clppHistogram_CLKernel.h"
+#include "clpp/clppBufferPool.h"
+#include "clpp/clppProfiler.h"
+
+#include <algorithm>
+
+#pragma region Constructor
+
+clppHistogram::clppHistogram(clppContext* context, clppDataType type, unsigned int bins, clppHistogramBinning binning, unsigned int maxElements)
+{
+	_context = context;
+	_operator = clppOperator(type);
+	_bins = bins;
+
+	switch (binning)
+	{
+	case clppHistogram_Range:
+		_binFunction = "(((X) >= rangeMin) ? (uint)fmin((float)((X) - rangeMin) * rangeScale, (float)BINS) : BINS)";
+		break;
+	case clppHistogram_BitField:
+		// The mask of the bit-field
+		assert(bins > 0 && (bins & (bins - 1)) == 0);
+		_binFunction = "((uint)((X) >> shift) & (BINS - 1))";
+		break;
+	default:
+		_binFunction = "(((X) < (T)BINS) ? (uint)(X) : BINS)";
+		break;
+	}
+
+	initialize();
+}
+
+clppHistogram::clppHistogram(clppContext* context, clppDataType type, unsigned int bins, string binFunction, unsigned int maxElements)
+{
+	_context = context;
+	_operator = clppOperator(type);
+	_bins = bins;
+	_binFunction = binFunction;
+
+	initialize();
+}
+
+void clppHistogram::initialize()
+{
+	_rangeMin = 0.0f;
+	_rangeScale = 1.0f;
+	_shift = 0;
+	_dataSet = 0;
+	_datasetSize = 0;
+	_clBuffer_dataSet = 0;
+	_is_clBuffersOwner = false;
+	_clBuffer_partials = 0;
+	_clBuffer_histogram = 0;
+	_workgroupSize = 256;
+
+	//---- The private histograms are in local memory when they fit (half of the local memory)
+	cl_ulong localMemory = 0;
+	clGetDeviceInfo(_context->clDevice, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(cl_ulong), &localMemory, NULL);
+	_globalBins = (_bins * sizeof(cl_uint) > localMemory / 2);
+
+	if (!compile(_context, clCode_clppHistogram))
+		return;
+
+	//---- Prepare all the kernels
+	_kernel_Histogram = getKernel("kernel__histogram");
+
+	_kernel_Clear = getKernel("kernel__histogramClear");
+
+	_kernel_Merge = getKernel("kernel__histogramMerge");
+
+	//---- A few work-groups per compute unit : the fewer private histograms, the faster the merge
+	cl_uint computeUnits = 1;
+	clGetDeviceInfo(_context->clDevice, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(cl_uint), &computeUnits, NULL);
+	_maxWorkgroups = max((size_t)computeUnits * 4, (size_t)1);
+
+	//---- Prepare all the buffers
+	_clBuffer_partials = _context->getBufferPool()->acquire(sizeof(cl_uint) * _bins * _maxWorkgroups);
+
+	_clBuffer_histogram = _context->getBufferPool()->acquire(sizeof(cl_uint) * _bins);
+}
+
+clppHistogram::~clppHistogram()
+{
+	if (_is_clBuffersOwner && _clBuffer_dataSet)
+		_context->getBufferPool()->release(_clBuffer_dataSet);
+
+	if (_clBuffer_partials)
+		_context->getBufferPool()->release(_clBuffer_partials);
+
+	if (_clBuffer_histogram)
+		_context->getBufferPool()->release(_clBuffer_histogram);
+}
+
+#pragma endregion
+
+#pragma region compilePreprocess
+
+string clppHistogram::compilePreprocess(string kernel)
+{
+	ostringstream source;
+
+	if (_operator.type == clppDataType_Double)
+		source << "#pragma OPENCL EXTENSION cl_khr_fp64 : enable" << endl;
+
+	source << "#define T " << _operator.getTypeName() << endl;
+	source << "#define BINS " << _bins << "u" << endl;
+	source << "#define BIN(X) (" << _binFunction << ")" << endl;
+
+	if (_globalBins)
+		source << "#define GLOBAL_BINS" << endl;
+
+	return clppProgram::compilePreprocess(source.str() + kernel);
+}
+
+#pragma endregion
+
+#pragma region Bins
+
+void clppHistogram::setRange(float minValue, float maxValue)
+{
+	_rangeMin = minValue;
+	_rangeScale = (maxValue > minValue) ? _bins / (maxValue - minValue) : 0.0f;
+}
+
+void clppHistogram::setBitField(unsigned int shift)
+{
+	_shift = shift;
+}
+
+#pragma endregion
+
+#pragma region histogram
+
+void clppHistogram::histogram()
+{
+	cl_int clStatus;
+
+	unsigned int N = _datasetSize;
+
+	//---- 1) The private histograms, each work-item counts at least 16 elements
+	size_t itemsPerWorkgroup = _workgroupSize * 16;
+	unsigned int workgroups = (unsigned int)min(_maxWorkgroups, max((N + itemsPerWorkgroup - 1) / itemsPerWorkgroup, (size_t)1));
+
+	size_t local[1] = {_workgroupSize};
+	size_t global[1] = {workgroups * _workgroupSize};
+
+	if (_globalBins)
+	{
+		unsigned int count = workgroups * _bins;
+		size_t globalClear[1] = {toMultipleOf(count, _workgroupSize)};
+
+		clStatus  = clSetKernelArg(_kernel_Clear, 0, sizeof(cl_mem), (const void*)&_clBuffer_partials);
+		clStatus |= clSetKernelArg(_kernel_Clear, 1, sizeof(unsigned int), (const void*)&count);
+		clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Clear, 1, NULL, globalClear, local, 0, NULL, NULL);
+		checkCLStatus(clStatus);
+	}
+
+	clStatus  = clSetKernelArg(_kernel_Histogram, 0, sizeof(cl_mem), (const void*)&_clBuffer_dataSet);
+	clStatus |= clSetKernelArg(_kernel_Histogram, 1, sizeof(cl_mem), (const void*)&_clBuffer_partials);
+	clStatus |= clSetKernelArg(_kernel_Histogram, 2, sizeof(unsigned int), (const void*)&N);
+	clStatus |= clSetKernelArg(_kernel_Histogram, 3, sizeof(float), (const void*)&_rangeMin);
+	clStatus |= clSetKernelArg(_kernel_Histogram, 4, sizeof(float), (const void*)&_rangeScale);
+	clStatus |= clSetKernelArg(_kernel_Histogram, 5, sizeof(unsigned int), (const void*)&_shift);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Histogram, 1, NULL, global, local, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+
+	//---- 2) The merge
+	size_t globalMerge[1] = {toMultipleOf(_bins, _workgroupSize)};
+
+	clStatus  = clSetKernelArg(_kernel_Merge, 0, sizeof(cl_mem), (const void*)&_clBuffer_partials);
+	clStatus |= clSetKernelArg(_kernel_Merge, 1, sizeof(cl_mem), (const void*)&_clBuffer_histogram);
+	clStatus |= clSetKernelArg(_kernel_Merge, 2, sizeof(unsigned int), (const void*)&workgroups);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Merge, 1, NULL, globalMerge, local, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
+
+#pragma region pushDatas
+
+void clppHistogram::pushDatas(void* dataSet, size_t datasetSize)
+{
+	cl_int clStatus;
+
+	//---- Store some values
+	_dataSet = dataSet;
+	_datasetSize = datasetSize;
+
+	//---- Copy on the device, through a pinned buffer of the buffer pool
+	if (!_is_clBuffersOwner)
+		_clBuffer_dataSet = 0;
+
+	_clBuffer_dataSet = _context->getBufferPool()->resizePinned(_clBuffer_dataSet, _operator.getValueSize() * _datasetSize);
+	_is_clBuffersOwner = true;
+
+	clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_dataSet, CL_FALSE, 0, _operator.getValueSize() * _datasetSize, _dataSet, 0, 0, 0);
+	checkCLStatus(clStatus);
+}
+
+void clppHistogram::pushCLDatas(cl_mem clBuffer_dataSet, size_t datasetSize)
+{
+	if (_is_clBuffersOwner && _clBuffer_dataSet)
+		_context->getBufferPool()->release(_clBuffer_dataSet);
+
+	_is_clBuffersOwner = false;
+
+	_dataSet = 0;
+	_clBuffer_dataSet = clBuffer_dataSet;
+	_datasetSize = datasetSize;
+}
+
+#pragma endregion
+
+#pragma region popDatas
+
+void clppHistogram::popDatas(unsigned int* histogram)
+{
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_histogram, CL_TRUE, 0, sizeof(cl_uint) * _bins, histogram, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
\ No newline at end of file
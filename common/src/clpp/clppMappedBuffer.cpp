@@ -0,0 +1,46 @@
+#include "clpp/clppMappedBuffer.h"
+#include "clpp/clppProgram.h"
+#include "clpp/clppProfiler.h"
+
+#pragma region Constructor
+
+clppMappedBuffer::clppMappedBuffer(clppContext* context, cl_mem clBuffer, size_t bytes, cl_map_flags flags, size_t offset)
+{
+	_context = context;
+	_clBuffer = clBuffer;
+	_bytes = bytes;
+	_offset = offset;
+	_flags = flags;
+	_mapped = _context->isHostUnified;
+
+	cl_int clStatus;
+	if (_mapped)
+	{
+		//---- The device memory is the host memory : no copy
+		_data = _context->getProfiler()->enqueueMapBuffer(_clBuffer, CL_TRUE, _flags, _offset, _bytes, 0, NULL, NULL, &clStatus);
+		clppProgram::checkCLStatus(clStatus);
+	}
+	else
+	{
+		//---- Fallback : a host copy
+		_copy.resize(_bytes);
+		_data = _bytes ? &_copy[0] : NULL;
+
+		if ((_flags & CL_MAP_READ) && _bytes)
+		{
+			clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer, CL_TRUE, _offset, _bytes, _data, 0, NULL, NULL);
+			clppProgram::checkCLStatus(clStatus);
+		}
+	}
+}
+
+clppMappedBuffer::~clppMappedBuffer()
+{
+	// No exception from a destructor : the errors are only reported by the next calls on the queue
+	if (_mapped)
+		_context->getProfiler()->enqueueUnmapMemObject(_clBuffer, _data, 0, NULL, NULL);
+	else if ((_flags & CL_MAP_WRITE) && _bytes)
+		_context->getProfiler()->enqueueWriteBuffer(_clBuffer, CL_TRUE, _offset, _bytes, _data, 0, NULL, NULL);
+}
+
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,157 @@
+//------------------------------------------------------------
+// Purpose :
+// ---------
+// Merge two sorted runs (keys or key-values) into a single sorted run.
+//
+// Algorithm :
+// -----------
+// Merge path : the output is cut into tiles of TILE_SIZE elements. The k-th output element lies on the
+// k-th cross diagonal of the (A x B) merge matrix, so a binary search on that diagonal gives the number
+// of elements coming from A and from B for any output position.
+//
+// 1) kernel__mergePartition : one binary search in global memory per tile boundary.
+// 2) kernel__mergeTile : each work-group loads its A and B ranges in local memory, each work-item
+//    searches its own diagonal in local memory and merges ITEMS_PER_WORKITEM elements sequentially.
+//
+// The merge is stable : on equal keys, the elements of A come first.
+//
+// References :
+// ------------
+// Merge Path - Parallel Merging Made Simple. Saher Odeh, Oded Green, Zahi Mwassi, Oz Shmueli, Yitzhak Birk.
+// GPU merge path: a GPU merging algorithm. Oded Green, Robert McColl, David A. Bader.
+//------------------------------------------------------------
+
+#pragma OPENCL EXTENSION cl_amd_printf : enable
+
+#define TILE_SIZE (WORKGROUP_SIZE * ITEMS_PER_WORKITEM)
+
+#ifdef KEYS_ONLY
+#define KEY(DATA) (DATA)
+#else
+#define KEY(DATA) (DATA.x)
+#endif
+
+//------------------------------------------------------------
+// mergePathSearch
+//
+// Purpose : Returns the number of elements of A among the 'diagonal' first merged elements.
+//------------------------------------------------------------
+
+inline
+uint mergePathSearch_global(__global const KV_TYPE* A, uint sizeA, __global const KV_TYPE* B, uint sizeB, uint diagonal)
+{
+	uint low = (diagonal > sizeB) ? diagonal - sizeB : 0;
+	uint high = min(diagonal, sizeA);
+
+	while (low < high)
+	{
+		uint mid = (low + high) >> 1;
+		if (KEY(A[mid]) <= KEY(B[diagonal - 1 - mid]))
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+inline
+uint mergePathSearch_local(__local const KV_TYPE* A, uint sizeA, __local const KV_TYPE* B, uint sizeB, uint diagonal)
+{
+	uint low = (diagonal > sizeB) ? diagonal - sizeB : 0;
+	uint high = min(diagonal, sizeA);
+
+	while (low < high)
+	{
+		uint mid = (low + high) >> 1;
+		if (KEY(A[mid]) <= KEY(B[diagonal - 1 - mid]))
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+//------------------------------------------------------------
+// kernel__mergePartition
+//
+// Purpose : Find where each tile starts in A. 'partitions' has (tiles + 1) entries.
+//------------------------------------------------------------
+
+__kernel
+void kernel__mergePartition(
+	__global const KV_TYPE* A,
+	const uint sizeA,
+	__global const KV_TYPE* B,
+	const uint sizeB,
+	__global uint* partitions,
+	const uint partitionsCount)
+{
+	const uint gid = get_global_id(0);
+	if (gid >= partitionsCount)
+		return;
+
+	uint diagonal = min(gid * TILE_SIZE, sizeA + sizeB);
+	partitions[gid] = mergePathSearch_global(A, sizeA, B, sizeB, diagonal);
+}
+
+//------------------------------------------------------------
+// kernel__mergeTile
+//
+// Purpose : Merge the TILE_SIZE output elements of a work-group.
+//------------------------------------------------------------
+
+__kernel
+void kernel__mergeTile(
+	__global const KV_TYPE* A,
+	const uint sizeA,
+	__global const KV_TYPE* B,
+	const uint sizeB,
+	__global KV_TYPE* dataOut,
+	__global const uint* partitions)
+{
+	const uint tid = get_local_id(0);
+	const uint groupId = get_group_id(0);
+
+	__local KV_TYPE localData[TILE_SIZE];
+
+	//---- The ranges of A and B merged by this tile
+	const uint diagonal0 = groupId * TILE_SIZE;
+	const uint diagonal1 = min(diagonal0 + TILE_SIZE, sizeA + sizeB);
+	const uint a0 = partitions[groupId];
+	const uint a1 = partitions[groupId + 1];
+	const uint b0 = diagonal0 - a0;
+	const uint b1 = diagonal1 - a1;
+	const uint countA = a1 - a0;
+	const uint countB = b1 - b0;
+
+	//---- Load A then B in local memory
+	for(uint i = tid; i < countA; i += WORKGROUP_SIZE)
+		localData[i] = A[a0 + i];
+	for(uint i = tid; i < countB; i += WORKGROUP_SIZE)
+		localData[countA + i] = B[b0 + i];
+
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	__local const KV_TYPE* localA = localData;
+	__local const KV_TYPE* localB = localData + countA;
+
+	//---- Each work-item merges ITEMS_PER_WORKITEM elements from its own diagonal
+	const uint count = countA + countB;
+	const uint diagonal = min(tid * ITEMS_PER_WORKITEM, count);
+	uint i = mergePathSearch_local(localA, countA, localB, countB, diagonal);
+	uint j = diagonal - i;
+
+	__global KV_TYPE* output = dataOut + diagonal0 + diagonal;
+
+	#pragma unroll
+	for(uint k = 0; k < ITEMS_PER_WORKITEM; k++)
+	{
+		if (diagonal + k >= count)
+			break;
+
+		bool takeA = (j >= countB) || (i < countA && KEY(localA[i]) <= KEY(localB[j]));
+		output[k] = takeA ? localA[i++] : localB[j++];
+	}
+}
\ No newline at end of file
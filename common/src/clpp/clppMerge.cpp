@@ -0,0 +1,129 @@
+#include "clpp/clppMerge.h"
+#include "clpp/clppMerge_CLKernel.h"
+#include "clpp/clpp.h"
+#include "clpp/clppBufferPool.h"
+#include "clpp/clppProfiler.h"
+
+#pragma region Constructor
+
+clppMerge::clppMerge(clppContext* context, unsigned int maxElements, unsigned int bits, bool keysOnly)
+{
+	_keysOnly = keysOnly;
+	_workgroupSize = 128;
+	_itemsPerWorkitem = 4;
+	_clBuffer_partitions = 0;
+	_partitionsSize = 0;
+	_sort = 0;
+
+	if (!compile(context, clCode_clppMerge))
+		return;
+
+	//---- Prepare all the kernels
+	_kernel_MergePartition = getKernel("kernel__mergePartition");
+
+	_kernel_MergeTile = getKernel("kernel__mergeTile");
+
+	//---- Prepare all the buffers
+	size_t tileSize = _workgroupSize * _itemsPerWorkitem;
+	_partitionsSize = (maxElements + tileSize - 1) / tileSize + 1;
+	_clBuffer_partitions = _context->getBufferPool()->acquire(sizeof(cl_uint) * _partitionsSize);
+
+	//---- The sort of the modified elements
+	_sort = keysOnly ? clpp::createBestSort(context, maxElements, bits) : clpp::createBestSortKV(context, maxElements, bits);
+}
+
+clppMerge::~clppMerge()
+{
+	if (_clBuffer_partitions)
+		_context->getBufferPool()->release(_clBuffer_partitions);
+
+	delete _sort;
+}
+
+#pragma endregion
+
+#pragma region compilePreprocess
+
+string clppMerge::compilePreprocess(string kernel)
+{
+	ostringstream source;
+
+	source << "#define WORKGROUP_SIZE " << _workgroupSize << endl;
+	source << "#define ITEMS_PER_WORKITEM " << _itemsPerWorkitem << endl;
+	source << (_keysOnly ? "#define KV_TYPE uint" : "#define KV_TYPE uint2") << endl;
+
+	if (_keysOnly)
+		source << "#define KEYS_ONLY 1" << endl;
+
+	return clppProgram::compilePreprocess(source.str() + kernel);
+}
+
+#pragma endregion
+
+#pragma region merge
+
+void clppMerge::merge(cl_mem clBuffer_runA, size_t sizeA, cl_mem clBuffer_runB, size_t sizeB, cl_mem clBuffer_dataSetOut)
+{
+	cl_int clStatus;
+
+	unsigned int N = sizeA + sizeB;
+	if (N == 0)
+		return;
+
+	unsigned int uSizeA = sizeA;
+	unsigned int uSizeB = sizeB;
+	size_t tileSize = _workgroupSize * _itemsPerWorkitem;
+	unsigned int tiles = (N + tileSize - 1) / tileSize;
+	unsigned int partitionsCount = tiles + 1;
+
+	//---- The partitions buffer grows with the data set
+	if (partitionsCount > _partitionsSize)
+	{
+		_context->getBufferPool()->release(_clBuffer_partitions);
+		_clBuffer_partitions = _context->getBufferPool()->acquire(sizeof(cl_uint) * partitionsCount);
+		_partitionsSize = partitionsCount;
+	}
+
+	//---- 1) Tile boundaries
+	size_t localPartition[1] = {64};
+	size_t globalPartition[1] = {toMultipleOf(partitionsCount, localPartition[0])};
+
+	clStatus  = clSetKernelArg(_kernel_MergePartition, 0, sizeof(cl_mem), (const void*)&clBuffer_runA);
+	clStatus |= clSetKernelArg(_kernel_MergePartition, 1, sizeof(unsigned int), (const void*)&uSizeA);
+	clStatus |= clSetKernelArg(_kernel_MergePartition, 2, sizeof(cl_mem), (const void*)&clBuffer_runB);
+	clStatus |= clSetKernelArg(_kernel_MergePartition, 3, sizeof(unsigned int), (const void*)&uSizeB);
+	clStatus |= clSetKernelArg(_kernel_MergePartition, 4, sizeof(cl_mem), (const void*)&_clBuffer_partitions);
+	clStatus |= clSetKernelArg(_kernel_MergePartition, 5, sizeof(unsigned int), (const void*)&partitionsCount);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_MergePartition, 1, NULL, globalPartition, localPartition, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+
+	//---- 2) Merge each tile
+	size_t local[1] = {_workgroupSize};
+	size_t global[1] = {tiles * _workgroupSize};
+
+	clStatus  = clSetKernelArg(_kernel_MergeTile, 0, sizeof(cl_mem), (const void*)&clBuffer_runA);
+	clStatus |= clSetKernelArg(_kernel_MergeTile, 1, sizeof(unsigned int), (const void*)&uSizeA);
+	clStatus |= clSetKernelArg(_kernel_MergeTile, 2, sizeof(cl_mem), (const void*)&clBuffer_runB);
+	clStatus |= clSetKernelArg(_kernel_MergeTile, 3, sizeof(unsigned int), (const void*)&uSizeB);
+	clStatus |= clSetKernelArg(_kernel_MergeTile, 4, sizeof(cl_mem), (const void*)&clBuffer_dataSetOut);
+	clStatus |= clSetKernelArg(_kernel_MergeTile, 5, sizeof(cl_mem), (const void*)&_clBuffer_partitions);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_MergeTile, 1, NULL, global, local, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+void clppMerge::sortAndMerge(cl_mem clBuffer_sorted, size_t sortedSize, cl_mem clBuffer_updates, size_t updatesSize, cl_mem clBuffer_dataSetOut)
+{
+	//---- Sort only the modified elements
+	cl_mem sortedUpdates = clBuffer_updates;
+	if (updatesSize > 1)
+	{
+		_sort->pushCLDatas(clBuffer_updates, updatesSize);
+		_sort->sort();
+		sortedUpdates = _sort->getCLResultBuffer();
+	}
+
+	//---- Then a single merge pass with the untouched run
+	merge(clBuffer_sorted, sortedSize, sortedUpdates, updatesSize, clBuffer_dataSetOut);
+}
+
+#pragma endregion
\ No newline at end of file
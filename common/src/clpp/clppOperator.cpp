@@ -0,0 +1,96 @@
+#include "clpp/clppOperator.h"
+
+#if defined (__APPLE__) || defined(MACOSX)
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+#pragma region Constructor
+
+clppOperator::clppOperator(clppDataType type, clppOperatorKind kind)
+{
+	this->type = type;
+	this->kind = kind;
+
+	bool isFloat = (type == clppDataType_Float || type == clppDataType_Double);
+
+	switch (kind)
+	{
+	case clppOperator_Min:
+		apply = isFloat ? "fmin((A), (B))" : "min((A), (B))";
+		break;
+	case clppOperator_Max:
+		apply = isFloat ? "fmax((A), (B))" : "max((A), (B))";
+		break;
+	default:
+		apply = "((A) + (B))";
+		break;
+	}
+
+	//---- The identity of each operator, for each type
+	const char* identities[6][3] = {
+		// Sum					Min										Max
+		{ "0",					"INT_MAX",								"INT_MIN" },			// int
+		{ "0",					"UINT_MAX",								"0" },					// uint
+		{ "0.0f",				"INFINITY",								"(-INFINITY)" },		// float
+		{ "(uint2)(0, 0)",		"(uint2)(UINT_MAX, UINT_MAX)",			"(uint2)(0, 0)" },		// uint2
+		{ "0",					"ULONG_MAX",							"0" },					// ulong
+		{ "0.0",				"INFINITY",								"(-INFINITY)" },		// double
+	};
+
+	identity = identities[type][(kind == clppOperator_Custom) ? 0 : kind];
+}
+
+clppOperator::clppOperator(clppDataType type, string apply, string identity)
+{
+	this->type = type;
+	this->kind = clppOperator_Custom;
+	this->apply = apply;
+	this->identity = identity;
+}
+
+#pragma endregion
+
+#pragma region Type
+
+size_t clppOperator::getValueSize() const
+{
+	switch (type)
+	{
+	case clppDataType_Int: return sizeof(cl_int);
+	case clppDataType_Float: return sizeof(cl_float);
+	case clppDataType_UInt2: return sizeof(cl_uint2);
+	case clppDataType_ULong: return sizeof(cl_ulong);
+	case clppDataType_Double: return sizeof(cl_double);
+	default: return sizeof(cl_uint);
+	}
+}
+
+string clppOperator::getTypeName() const
+{
+	switch (type)
+	{
+	case clppDataType_Int: return "int";
+	case clppDataType_Float: return "float";
+	case clppDataType_UInt2: return "uint2";
+	case clppDataType_ULong: return "ulong";
+	case clppDataType_Double: return "double";
+	default: return "uint";
+	}
+}
+
+string clppOperator::getDefines() const
+{
+	string source = "";
+	if (type == clppDataType_Double)
+		source += "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n";
+
+	source += "#define T " + getTypeName() + "\n";
+	source += "#define OPERATOR_APPLY(A,B) " + apply + "\n";
+	source += "#define OPERATOR_IDENTITY " + identity + "\n";
+
+	return source;
+}
+
+#pragma endregion
\ No newline at end of file
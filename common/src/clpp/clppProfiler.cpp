@@ -0,0 +1,261 @@
+#include "clpp/clppProfiler.h"
+#include "clpp/clppProgram.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+
+// The completed events are collected every COLLECT_INTERVAL profiled commands, to bound the number of live events
+#define COLLECT_INTERVAL 256
+
+#pragma region Constructor
+
+clppProfiler::clppProfiler(clppContext* context)
+{
+	_context = context;
+	_enabled = false;
+	_firstPending = 0;
+	_maxRecords = 1 << 20;
+	_droppedCount = 0;
+}
+
+clppProfiler::~clppProfiler()
+{
+	for(size_t i = _firstPending; i < _pending.size(); i++)
+		clReleaseEvent(_pending[i].event);
+}
+
+#pragma endregion
+
+#pragma region setEnabled
+
+void clppProfiler::setEnabled(bool enabled)
+{
+	if (enabled)
+	{
+		//---- The timestamps are only available on a profiling queue
+		cl_command_queue_properties properties = 0;
+		clGetCommandQueueInfo(_context->clQueue, CL_QUEUE_PROPERTIES, sizeof(properties), &properties, NULL);
+		if (!(properties & CL_QUEUE_PROFILING_ENABLE))
+		{
+			cout << "Profiler : the queue is not created with CL_QUEUE_PROFILING_ENABLE, the profiling stays disabled" << endl;
+			return;
+		}
+	}
+
+	_enabled = enabled;
+}
+
+#pragma endregion
+
+#pragma region enqueue / record
+
+cl_int clppProfiler::addEvent(cl_int clStatus, size_t name, cl_ulong hostQueued, cl_event profileEvent, cl_event* event)
+{
+	if (clStatus != CL_SUCCESS)
+		return clStatus;
+
+	// The caller and the profiler each hold a reference on the event
+	if (event)
+	{
+		*event = profileEvent;
+		clRetainEvent(profileEvent);
+	}
+
+	PendingCommand command = { name, profileEvent, hostQueued };
+	_pending.push_back(command);
+	if ((_pending.size() - _firstPending) % COLLECT_INTERVAL == 0)
+		collectCompleted(false);
+
+	return CL_SUCCESS;
+}
+
+void clppProfiler::record(const string& name, cl_event event)
+{
+	if (!_enabled || !event)
+		return;
+
+	clRetainEvent(event);
+	PendingCommand command = { getNameId(name), event, getHostTime() };
+	_pending.push_back(command);
+	if ((_pending.size() - _firstPending) % COLLECT_INTERVAL == 0)
+		collectCompleted(false);
+}
+
+size_t clppProfiler::getKernelName(cl_kernel kernel)
+{
+	//---- Once per kernel
+	map<cl_kernel, size_t>::iterator it = _kernelNames.find(kernel);
+	if (it != _kernelNames.end())
+		return it->second;
+
+	size_t nameSize = 0;
+	clGetKernelInfo(kernel, CL_KERNEL_FUNCTION_NAME, 0, NULL, &nameSize);
+	string name(nameSize, '\0');
+	clGetKernelInfo(kernel, CL_KERNEL_FUNCTION_NAME, nameSize, &name[0], NULL);
+	name.resize(strlen(name.c_str()));
+
+	size_t nameId = getNameId(name);
+	_kernelNames[kernel] = nameId;
+	return nameId;
+}
+
+cl_ulong clppProfiler::getHostTime()
+{
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+size_t clppProfiler::getNameId(const string& name)
+{
+	map<string, size_t>::iterator it = _nameIds.find(name);
+	if (it != _nameIds.end())
+		return it->second;
+
+	_names.push_back(name);
+	_nameIds[name] = _names.size() - 1;
+	return _names.size() - 1;
+}
+
+#pragma endregion
+
+#pragma region collect
+
+void clppProfiler::collect()
+{
+	collectCompleted(true);
+}
+
+void clppProfiler::collectCompleted(bool wait)
+{
+	for(; _firstPending < _pending.size(); _firstPending++)
+	{
+		cl_event event = _pending[_firstPending].event;
+
+		if (wait)
+			clWaitForEvents(1, &event);
+		else
+		{
+			// The queue is in order : stop at the first command not complete
+			cl_int status;
+			clGetEventInfo(event, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(status), &status, NULL);
+			if (status != CL_COMPLETE)
+				break;
+		}
+
+		if (_records.size() < _maxRecords)
+		{
+			clppProfileRecord record;
+			record.name = _pending[_firstPending].name;
+			record.hostQueued = _pending[_firstPending].hostQueued;
+			clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_QUEUED, sizeof(cl_ulong), &record.queued, NULL);
+			clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_SUBMIT, sizeof(cl_ulong), &record.submit, NULL);
+			clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &record.start, NULL);
+			clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &record.end, NULL);
+			_records.push_back(record);
+		}
+		else
+			_droppedCount++;
+
+		clReleaseEvent(event);
+	}
+
+	//---- Drop the collected events : the newest command is often still running during a busy run, so the
+	// collected prefix is erased once it is the larger part, to keep the pending commands bounded
+	if (_firstPending == _pending.size())
+	{
+		_pending.clear();
+		_firstPending = 0;
+	}
+	else if (_firstPending > _pending.size() / 2)
+	{
+		_pending.erase(_pending.begin(), _pending.begin() + _firstPending);
+		_firstPending = 0;
+	}
+}
+
+const vector<clppProfileRecord>& clppProfiler::getRecords()
+{
+	collect();
+	return _records;
+}
+
+void clppProfiler::reset()
+{
+	collect();
+	_records.clear();
+	_droppedCount = 0;
+}
+
+#pragma endregion
+
+#pragma region Stats
+
+static bool compareTotalTime(const clppKernelStats& a, const clppKernelStats& b)
+{
+	return a.totalTime > b.totalTime;
+}
+
+vector<clppKernelStats> clppProfiler::getStats()
+{
+	collect();
+
+	//---- The execution times and the overheads of each name
+	vector<vector<double> > times(_names.size());
+	vector<double> overheads(_names.size(), 0);
+	for(size_t i = 0; i < _records.size(); i++)
+	{
+		const clppProfileRecord& record = _records[i];
+		times[record.name].push_back((record.end - record.start) * 1e-3);
+		overheads[record.name] += (record.start - record.queued) * 1e-3;
+	}
+
+	vector<clppKernelStats> stats;
+	for(size_t name = 0; name < _names.size(); name++)
+	{
+		vector<double>& t = times[name];
+		if (t.empty())
+			continue;
+
+		sort(t.begin(), t.end());
+
+		clppKernelStats s;
+		s.name = _names[name];
+		s.count = t.size();
+		s.totalTime = 0;
+		for(size_t i = 0; i < t.size(); i++)
+			s.totalTime += t[i];
+		s.meanTime = s.totalTime / t.size();
+
+		// Nearest rank
+		s.p50Time = t[(t.size() * 50 + 99) / 100 - 1];
+		s.p99Time = t[(t.size() * 99 + 99) / 100 - 1];
+		s.meanOverhead = overheads[name] / t.size();
+
+		stats.push_back(s);
+	}
+
+	sort(stats.begin(), stats.end(), compareTotalTime);
+	return stats;
+}
+
+void clppProfiler::printStats()
+{
+	vector<clppKernelStats> stats = getStats();
+
+	cout << "Kernel profile (us) :" << endl;
+	cout << left << setw(40) << "kernel" << right << setw(10) << "count" << setw(14) << "total" << setw(12) << "mean"
+		<< setw(12) << "p50" << setw(12) << "p99" << setw(12) << "overhead" << endl;
+
+	cout << fixed << setprecision(1);
+	for(size_t i = 0; i < stats.size(); i++)
+		cout << left << setw(40) << stats[i].name << right << setw(10) << stats[i].count << setw(14) << stats[i].totalTime << setw(12) << stats[i].meanTime
+			<< setw(12) << stats[i].p50Time << setw(12) << stats[i].p99Time << setw(12) << stats[i].meanOverhead << endl;
+	cout.unsetf(ios_base::floatfield);
+	cout << setprecision(6);
+
+	if (_droppedCount > 0)
+		cout << _droppedCount << " commands not recorded (more than " << _maxRecords << " records)" << endl;
+}
+
+#pragma endregion
\ No newline at end of file
@@ -6,14 +6,32 @@
 
 #if defined(__linux__) || defined(__APPLE__)
 #include <sys/time.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
+#ifdef WIN32
+#include <direct.h>
+#include <process.h>
+#define mkdir(path, mode) _mkdir(path)
+#define getpid _getpid
+#endif
+
+#include <vector>
+#include <cstring>
+
 string clppProgram::_basePath;
+map<string, cl_program> clppProgram::_programCache;
+string clppProgram::_binaryCachePath;
+string clppProgram::_globalBuildOptions;
+map<cl_program, shared_future<int> > clppProgram::_builds;
+bool clppProgram::_asyncBuild = false;
 
 clppProgram::clppProgram()
 {
 	_clProgram = 0;
 	_context = 0;
+	_buildOptions = "";
 }
 
 clppProgram::~clppProgram()
@@ -37,6 +55,36 @@ void clppProgram::setBasePath(string basePath)
 	_basePath = basePath;
 }
 
+void clppProgram::setBuildOptions(string options)
+{
+	_buildOptions = options;
+}
+
+string clppProgram::getBuildOptions()
+{
+	return _buildOptions;
+}
+
+void clppProgram::setGlobalBuildOptions(string options)
+{
+	_globalBuildOptions = options;
+}
+
+string clppProgram::getGlobalBuildOptions()
+{
+	return _globalBuildOptions;
+}
+
+bool clppProgram::getAsyncBuild()
+{
+	return _asyncBuild;
+}
+
+void clppProgram::setAsyncBuild(bool async)
+{
+	_asyncBuild = async;
+}
+
 bool clppProgram::compile(clppContext* context, string fileName)
 {
 	string programSource = loadSource(_basePath + fileName);
@@ -55,39 +103,306 @@ bool clppProgram::compile(clppContext* context, char* kernelCode)
 	//---- Some preprocessing
 	programSource = compilePreprocess(programSource);
 
+	//---- The global options, then the ones of this program (ex : -cl-fast-relaxed-math, -cl-std=CL2.0)
+	string buildOptions = _globalBuildOptions + " " + _buildOptions;
+
+	//---- Already built : the specializations are only compiled once, with the same options
+	ostringstream cacheKey;
+	cacheKey << context->clContext << " " << context->clDevice << " " << buildOptions << "\n" << programSource;
+
+	map<string, cl_program>::iterator cached = _programCache.find(cacheKey.str());
+	if (cached != _programCache.end())
+	{
+		_clProgram = cached->second;
+		clStatus = clRetainProgram(_clProgram);
+		checkCLStatus(clStatus);
+
+		// It may still be building in the background
+		map<cl_program, shared_future<int> >::iterator build = _builds.find(_clProgram);
+		if (build != _builds.end())
+			_build = build->second;
+
+		return true;
+	}
+
+	//---- Built by a previous run : the binary is in the on-disk cache
+	string binaryKey = "";
+	if (_binaryCachePath.length() > 0)
+	{
+		binaryKey = getBinaryKey(context, buildOptions, programSource);
+
+		_clProgram = loadProgramBinary(context, binaryKey);
+		if (_clProgram)
+		{
+			clStatus = clBuildProgram(_clProgram, 1, &context->clDevice, buildOptions.c_str(), NULL, NULL);
+			if (clStatus == CL_SUCCESS)
+			{
+				clStatus = clRetainProgram(_clProgram);
+				checkCLStatus(clStatus);
+				_programCache[cacheKey.str()] = _clProgram;
+				return true;
+			}
+
+			// Rejected by the driver : build from the source
+			clReleaseProgram(_clProgram);
+			_clProgram = 0;
+		}
+	}
+
 	//---- Build the program
 	const char* ptr = programSource.c_str();
 	size_t len = programSource.length();
 	_clProgram = clCreateProgramWithSource(context->clContext, 1, (const char **)&ptr, &len, &clStatus);
 	checkCLStatus(clStatus);
 
-#ifdef __APPLE__
-    //const char* buildOptions = "-DMAC -cl-fast-relaxed-math";
-	const char* buildOptions = "";
-#else
-    //const char* buildOptions = "-cl-fast-relaxed-math";
-	const char* buildOptions = "";
-#endif
+	if (_asyncBuild)
+	{
+		//---- In the background : the cache keeps the program alive until the end of the build
+		clStatus = clRetainProgram(_clProgram);
+		checkCLStatus(clStatus);
+		_programCache[cacheKey.str()] = _clProgram;
+
+		_build = async(launch::async, buildProgram, context, _clProgram, buildOptions, binaryKey).share();
+		_builds[_clProgram] = _build;
+		return true;
+	}
+
+	clStatus = buildProgram(context, _clProgram, buildOptions, binaryKey);
+	if (clStatus != CL_SUCCESS)
+	{
+		checkCLStatus(clStatus);
+		return false;
+	}
+
+	//---- Keep the program for the next compilations
+	clStatus = clRetainProgram(_clProgram);
+	checkCLStatus(clStatus);
+	_programCache[cacheKey.str()] = _clProgram;
+
+	return true;
+}
+
+cl_int clppProgram::buildProgram(clppContext* context, cl_program program, string buildOptions, string binaryKey)
+{
+	cl_int clStatus = clBuildProgram(program, 0, NULL, buildOptions.c_str(), NULL, NULL);
 
-	clStatus = clBuildProgram(_clProgram, 0, NULL, buildOptions, NULL, NULL);
-  
 	if (clStatus != CL_SUCCESS)
 	{
 		size_t len;
 		char buffer[50000];
 		printf("Error: Failed to build program executable!\n");
-		clGetProgramBuildInfo(_clProgram, context->clDevice, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, &len);
+		clGetProgramBuildInfo(program, context->clDevice, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, &len);
 
 		printf("%s\n", buffer);
 		printf("%s\n", getOpenCLErrorString(clStatus));
 
-		checkCLStatus(clStatus);
-		return false;
+		return clStatus;
 	}
 
-	return true;
+	//---- Keep the binary for the next runs
+	if (binaryKey.length() > 0)
+		saveProgramBinary(context, program, binaryKey);
+
+	return CL_SUCCESS;
 }
 
+bool clppProgram::waitBuild()
+{
+	if (!_build.valid())
+		return (_clProgram != 0);
+
+	cl_int clStatus = _build.get();
+	checkCLStatus(clStatus);
+
+	return (clStatus == CL_SUCCESS);
+}
+
+void clppProgram::waitAllBuilds()
+{
+	for(map<cl_program, shared_future<int> >::iterator it = _builds.begin(); it != _builds.end(); it++)
+		it->second.wait();
+}
+
+clppKernel clppProgram::getKernel(string name)
+{
+	return clppKernel(this, name);
+}
+
+cl_kernel clppProgram::createKernel(string name)
+{
+	if (!waitBuild())
+		return 0;
+
+	cl_int clStatus;
+	cl_kernel kernel = clCreateKernel(_clProgram, name.c_str(), &clStatus);
+	checkCLStatus(clStatus);
+
+	return kernel;
+}
+
+void clppProgram::clearProgramCache()
+{
+	waitAllBuilds();
+
+	for(map<string, cl_program>::iterator it = _programCache.begin(); it != _programCache.end(); it++)
+		clReleaseProgram(it->second);
+
+	_programCache.clear();
+	_builds.clear();
+}
+
+#pragma region Binary cache
+
+// 64 bits FNV-1a hash, for the file names of the binary cache
+static unsigned long long hashFNV1a(const string& text)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	for(size_t i = 0; i < text.length(); i++)
+	{
+		hash ^= (unsigned char)text[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+static string getDeviceString(cl_device_id device, cl_device_info info)
+{
+	char buffer[1024] = "";
+	clGetDeviceInfo(device, info, sizeof(buffer) - 1, buffer, NULL);
+	return string(buffer);
+}
+
+static const char binaryCacheMagic[8] = { 'C', 'L', 'P', 'P', 'B', 'I', 'N', '1' };
+
+string clppProgram::getBinaryCachePath()
+{
+	return _binaryCachePath;
+}
+
+void clppProgram::setBinaryCachePath(string path)
+{
+	if (path.length() > 0 && path[path.length() - 1] != '/' && path[path.length() - 1] != '\\')
+		path += "/";
+
+	if (path.length() > 0)
+		mkdir(path.substr(0, path.length() - 1).c_str(), 0755);
+
+	_binaryCachePath = path;
+}
+
+string clppProgram::getBinaryKey(clppContext* context, string buildOptions, string programSource)
+{
+	// A new driver or another device needs a new binary
+	ostringstream key;
+	key << getDeviceString(context->clDevice, CL_DEVICE_NAME) << "\n";
+	key << getDeviceString(context->clDevice, CL_DEVICE_VENDOR) << "\n";
+	key << getDeviceString(context->clDevice, CL_DEVICE_VERSION) << "\n";
+	key << getDeviceString(context->clDevice, CL_DRIVER_VERSION) << "\n";
+	key << buildOptions << "\n";
+	key << programSource;
+
+	return key.str();
+}
+
+// The file : the magic, the key (to reject the hash collisions), the binary
+static string getBinaryFileName(const string& binaryCachePath, const string& binaryKey)
+{
+	char name[32];
+	sprintf(name, "%016llx.clbin", hashFNV1a(binaryKey));
+	return binaryCachePath + name;
+}
+
+cl_program clppProgram::loadProgramBinary(clppContext* context, string binaryKey)
+{
+	ifstream infile(getBinaryFileName(_binaryCachePath, binaryKey).c_str(), ios_base::in | ios_base::binary);
+	if (!infile)
+		return 0;
+
+	char magic[8];
+	unsigned long long keyLength = 0, binarySize = 0;
+
+	infile.read(magic, sizeof(magic));
+	infile.read((char*)&keyLength, sizeof(keyLength));
+	if (!infile || memcmp(magic, binaryCacheMagic, sizeof(magic)) != 0 || keyLength != binaryKey.length())
+		return 0;
+
+	string key(keyLength, '\0');
+	infile.read(&key[0], keyLength);
+	infile.read((char*)&binarySize, sizeof(binarySize));
+	if (!infile || key != binaryKey || binarySize == 0)
+		return 0;
+
+	vector<unsigned char> binary(binarySize);
+	infile.read((char*)&binary[0], binarySize);
+	if (!infile)
+		return 0;
+
+	cl_int clStatus, binaryStatus;
+	size_t size = binary.size();
+	const unsigned char* ptr = &binary[0];
+	cl_program program = clCreateProgramWithBinary(context->clContext, 1, &context->clDevice, &size, &ptr, &binaryStatus, &clStatus);
+
+	if (clStatus != CL_SUCCESS || binaryStatus != CL_SUCCESS)
+	{
+		if (program)
+			clReleaseProgram(program);
+		return 0;
+	}
+
+	return program;
+}
+
+void clppProgram::saveProgramBinary(clppContext* context, cl_program program, string binaryKey)
+{
+	//---- The binary of our device
+	cl_uint devicesCount = 0;
+	if (clGetProgramInfo(program, CL_PROGRAM_NUM_DEVICES, sizeof(cl_uint), &devicesCount, NULL) != CL_SUCCESS || devicesCount == 0)
+		return;
+
+	vector<cl_device_id> devices(devicesCount);
+	vector<size_t> sizes(devicesCount);
+	clGetProgramInfo(program, CL_PROGRAM_DEVICES, sizeof(cl_device_id) * devicesCount, &devices[0], NULL);
+	clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(size_t) * devicesCount, &sizes[0], NULL);
+
+	size_t index = 0;
+	while(index < devicesCount && devices[index] != context->clDevice)
+		index++;
+
+	if (index == devicesCount || sizes[index] == 0)
+		return;
+
+	// Only the binary of our device is copied
+	vector<unsigned char> binary(sizes[index]);
+	vector<unsigned char*> binaries(devicesCount, (unsigned char*)NULL);
+	binaries[index] = &binary[0];
+
+	if (clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(unsigned char*) * devicesCount, &binaries[0], NULL) != CL_SUCCESS)
+		return;
+
+	//---- Write a temporary file, then rename it : the concurrent runs never read a partial file
+	string fileName = getBinaryFileName(_binaryCachePath, binaryKey);
+	ostringstream tempName;
+	tempName << fileName << "." << getpid() << ".tmp";
+
+	ofstream outfile(tempName.str().c_str(), ios_base::out | ios_base::binary | ios_base::trunc);
+	if (!outfile)
+		return;
+
+	unsigned long long keyLength = binaryKey.length(), binarySize = binary.size();
+	outfile.write(binaryCacheMagic, sizeof(binaryCacheMagic));
+	outfile.write((const char*)&keyLength, sizeof(keyLength));
+	outfile.write(binaryKey.c_str(), keyLength);
+	outfile.write((const char*)&binarySize, sizeof(binarySize));
+	outfile.write((const char*)&binary[0], binarySize);
+	outfile.close();
+
+	if (!outfile || rename(tempName.str().c_str(), fileName.c_str()) != 0)
+		remove(tempName.str().c_str());
+}
+
+#pragma endregion
+
 string clppProgram::compilePreprocess(string programSource)
 {
 	string source = "";
@@ -105,6 +420,13 @@ string clppProgram::compilePreprocess(string programSource)
 	else if (_context->isCPU)
 		source += "#define OCL_DEVICE_CPU\n";
 
+	//---- The index type of the data sets
+#ifdef CLPP_64BIT_INDEX
+	source += "#define INDEX_T ulong\n";
+#else
+	source += "#define INDEX_T uint\n";
+#endif
+
 	return source + programSource;
 }
 
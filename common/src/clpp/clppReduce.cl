@@ -0,0 +1,91 @@
+//------------------------------------------------------------
+// Purpose :
+// ---------
+// Reduce a data set to a single value with an associative operator (sum, min, max...).
+//
+// Algorithm :
+// -----------
+// Two passes of the same kernel :
+// 1) A few work-groups per compute unit : each work-item reduces many elements (grid-stride loop with
+//    vector loads), then each work-group reduces its work-items and writes one partial result.
+// 2) A single work-group reduces the partial results.
+//
+// The work-group reduction uses sequential addressing, so the active work-items stay contiguous and
+// there is no modulo. When the device supports OpenCL C 2.0, the work-group functions are used instead.
+//
+// The host defines :
+// T, OPERATOR_APPLY(A,B), OPERATOR_IDENTITY	The data type and the operator (clppOperator)
+// WORKGROUP_SIZE								The size of a work-group
+// VECTOR_WIDTH, T4								4 : the loads use the vector type T4, 1 : scalar loads
+// WORKGROUP_REDUCE(X)							The work-group function of the operator, when there is one
+//
+// References :
+// ------------
+// Optimizing Parallel Reduction in CUDA. Mark Harris.
+//------------------------------------------------------------
+
+#pragma OPENCL EXTENSION cl_amd_printf : enable
+
+#if defined(WORKGROUP_REDUCE) && defined(__OPENCL_C_VERSION__) && __OPENCL_C_VERSION__ >= 200
+#if __OPENCL_C_VERSION__ < 300 || defined(__opencl_c_work_group_collective_functions)
+#define USE_WORKGROUP_FUNCTIONS
+#endif
+#endif
+
+//------------------------------------------------------------
+// kernel__reduce
+//
+// Purpose : Reduce 'N' values, one result per work-group in 'output'.
+//------------------------------------------------------------
+
+__kernel
+void kernel__reduce(
+	__global const T* data,
+	__global T* output,
+	const uint N)
+{
+	const uint tid = get_local_id(0);
+	const uint gid = get_global_id(0);
+	const uint gsz = get_global_size(0);
+
+	//---- 1) Each work-item reduces its elements
+	T value = OPERATOR_IDENTITY;
+
+#if VECTOR_WIDTH == 4
+	const uint N4 = N >> 2;
+	for(uint i = gid; i < N4; i += gsz)
+	{
+		T4 v = vload4(i, data);
+		value = OPERATOR_APPLY(value, OPERATOR_APPLY(OPERATOR_APPLY(v.x, v.y), OPERATOR_APPLY(v.z, v.w)));
+	}
+
+	// The last elements, when N is not a multiple of 4
+	for(uint i = (N4 << 2) + gid; i < N; i += gsz)
+		value = OPERATOR_APPLY(value, data[i]);
+#else
+	for(uint i = gid; i < N; i += gsz)
+		value = OPERATOR_APPLY(value, data[i]);
+#endif
+
+	//---- 2) Reduce the work-group
+#ifdef USE_WORKGROUP_FUNCTIONS
+	value = WORKGROUP_REDUCE(value);
+#else
+	__local T localData[WORKGROUP_SIZE];
+
+	localData[tid] = value;
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for(uint s = WORKGROUP_SIZE >> 1; s > 0; s >>= 1)
+	{
+		if (tid < s)
+			localData[tid] = OPERATOR_APPLY(localData[tid], localData[tid + s]);
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+
+	value = localData[0];
+#endif
+
+	if (tid == 0)
+		output[get_group_id(0)] = value;
+}
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "clpp/clppReduce.h"
+#include "clpp/clppReduce_CLKernel.h"
+#include "clpp/clppBufferPool.h"
+#include "clpp/clppProfiler.h"
+
+#include <string.h>
+#include <algorithm>
+
+#pragma region Constructor
+
+clppReduce::clppReduce(clppContext* context, const clppOperator& op, unsigned int maxElements)
+{
+	_operator = op;
+	_dataSet = 0;
+	_datasetSize = 0;
+	_clBuffer_dataSet = 0;
+	_is_clBuffersOwner = false;
+	_clBuffer_partials = 0;
+	_clBuffer_result = 0;
+	_workgroupSize = 128;
+	_context = context;
+
+	//---- The work-group functions need OpenCL C 2.0 (optional in 3.0)
+	char version[128] = "";
+	clGetDeviceInfo(context->clDevice, CL_DEVICE_OPENCL_C_VERSION, sizeof(version), version, NULL);
+	if (strncmp(version, "OpenCL C 2.", 11) == 0)
+		_buildOptions += " -cl-std=CL2.0";
+	else if (strncmp(version, "OpenCL C 3.", 11) == 0)
+		_buildOptions += " -cl-std=CL3.0";
+
+	if (!compile(context, clCode_clppReduce))
+		return;
+
+	//---- Prepare all the kernels
+	_kernel_Reduce = clppKernelLauncher<cl_mem, cl_mem, unsigned int>(context, getKernel("kernel__reduce"));
+	_kernel_ReducePartials = clppKernelLauncher<cl_mem, cl_mem, unsigned int>(context, getKernel("kernel__reduce"));
+
+	//---- A few work-groups per compute unit are enough for the first pass
+	cl_uint computeUnits = 1;
+	clGetDeviceInfo(context->clDevice, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(cl_uint), &computeUnits, NULL);
+	_maxWorkgroups = max((size_t)computeUnits * 4, (size_t)1);
+
+	//---- Prepare all the buffers
+	_clBuffer_partials = _context->getBufferPool()->acquire(_operator.getValueSize() * _maxWorkgroups);
+
+	_clBuffer_result = _context->getBufferPool()->acquire(_operator.getValueSize());
+}
+
+clppReduce::~clppReduce()
+{
+	if (_is_clBuffersOwner && _clBuffer_dataSet)
+		_context->getBufferPool()->release(_clBuffer_dataSet);
+
+	if (_clBuffer_partials)
+		_context->getBufferPool()->release(_clBuffer_partials);
+
+	if (_clBuffer_result)
+		_context->getBufferPool()->release(_clBuffer_result);
+}
+
+#pragma endregion
+
+#pragma region compilePreprocess
+
+string clppReduce::compilePreprocess(string kernel)
+{
+	ostringstream source;
+
+	source << _operator.getDefines();
+	source << "#define WORKGROUP_SIZE " << _workgroupSize << endl;
+
+	if (_operator.isVectorizable())
+	{
+		source << "#define VECTOR_WIDTH 4" << endl;
+		source << "#define T4 " << _operator.getTypeName() << "4" << endl;
+	}
+	else
+		source << "#define VECTOR_WIDTH 1" << endl;
+
+	//---- The built-in operators have a work-group function
+	if (_operator.isVectorizable() && _operator.kind != clppOperator_Custom)
+	{
+		const char* functions[3] = { "add", "min", "max" };
+		source << "#define WORKGROUP_REDUCE(X) work_group_reduce_" << functions[_operator.kind] << "(X)" << endl;
+	}
+
+	return clppProgram::compilePreprocess(source.str() + kernel);
+}
+
+#pragma endregion
+
+#pragma region reduce
+
+void clppReduce::reduce()
+{
+	cl_int clStatus;
+
+	unsigned int N = _datasetSize;
+
+	//---- 1) Partial results, each work-item reduces at least 16 elements
+	size_t itemsPerWorkgroup = _workgroupSize * 16;
+	unsigned int workgroups = (unsigned int)min(_maxWorkgroups, max((N + itemsPerWorkgroup - 1) / itemsPerWorkgroup, (size_t)1));
+
+	clStatus = _kernel_Reduce.launch(workgroups * _workgroupSize, _workgroupSize, _clBuffer_dataSet, _clBuffer_partials, N);
+	checkCLStatus(clStatus);
+
+	//---- 2) A single work-group reduces the partial results (the arguments are set again only when they change)
+	clStatus = _kernel_ReducePartials.launch(_workgroupSize, _workgroupSize, _clBuffer_partials, _clBuffer_result, workgroups);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
+
+#pragma region pushDatas
+
+void clppReduce::pushDatas(void* dataSet, size_t datasetSize)
+{
+	cl_int clStatus;
+
+	//---- Store some values
+	_dataSet = dataSet;
+	_datasetSize = datasetSize;
+
+	//---- Copy on the device, through a pinned buffer of the buffer pool
+	if (!_is_clBuffersOwner)
+		_clBuffer_dataSet = 0;
+
+	_clBuffer_dataSet = _context->getBufferPool()->resizePinned(_clBuffer_dataSet, _operator.getValueSize() * _datasetSize);
+	_is_clBuffersOwner = true;
+
+	clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_dataSet, CL_FALSE, 0, _operator.getValueSize() * _datasetSize, _dataSet, 0, 0, 0);
+	checkCLStatus(clStatus);
+}
+
+void clppReduce::pushCLDatas(cl_mem clBuffer_dataSet, size_t datasetSize)
+{
+	if (_is_clBuffersOwner && _clBuffer_dataSet)
+		_context->getBufferPool()->release(_clBuffer_dataSet);
+
+	_is_clBuffersOwner = false;
+
+	_dataSet = 0;
+	_clBuffer_dataSet = clBuffer_dataSet;
+	_datasetSize = datasetSize;
+}
+
+#pragma endregion
+
+#pragma region popDatas
+
+void clppReduce::popDatas(void* result)
+{
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_result, CL_TRUE, 0, _operator.getValueSize(), result, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,97 @@
+//------------------------------------------------------------
+// Purpose :
+// ---------
+// Run-length encoding : the runs of equal consecutive keys (ex : the LP numbers of a sorted event list)
+// give their unique key, their offset, their length and the number of runs.
+//
+// Algorithm :
+// -----------
+// 1) Flag the first element of each run.
+// 2) An exclusive scan of the flags : the index of the run of each first element.
+// 3) Scatter : the first element of a run writes its key and its offset, the last element writes the
+//    end of the run, and the last element of the data set writes the number of runs.
+// 4) The length of each run : its end minus its offset.
+//
+// The host defines :
+// T						The data type of the keys
+// INDEX_T					The index type of the data set (clppIndex)
+//------------------------------------------------------------
+
+#pragma OPENCL EXTENSION cl_amd_printf : enable
+
+//------------------------------------------------------------
+// kernel__rleFlags
+//
+// Purpose : 1) Flag the first element of each run.
+//------------------------------------------------------------
+
+__kernel
+void kernel__rleFlags(
+	__global const T* keys,
+	__global INDEX_T* indices,
+	const INDEX_T N)
+{
+	const INDEX_T gid = get_global_id(0);
+	if (gid >= N)
+		return;
+
+	indices[gid] = (gid == 0 || keys[gid] != keys[gid - 1]) ? 1 : 0;
+}
+
+//------------------------------------------------------------
+// kernel__rleScatter
+//
+// Purpose : 3) The key and the offset of each run, the end of each run and the number of runs.
+//------------------------------------------------------------
+
+__kernel
+void kernel__rleScatter(
+	__global const T* keys,
+	__global const INDEX_T* indices,
+	__global T* uniqueKeys,
+	__global INDEX_T* offsets,
+	__global INDEX_T* lengths,
+	__global INDEX_T* runs,
+	const INDEX_T N)
+{
+	const INDEX_T gid = get_global_id(0);
+	if (gid >= N)
+		return;
+
+	const T key = keys[gid];
+	const INDEX_T head = (gid == 0 || key != keys[gid - 1]) ? 1 : 0;
+	const INDEX_T run = indices[gid] + head - 1;
+
+	if (head)
+	{
+		uniqueKeys[run] = key;
+		offsets[run] = gid;
+	}
+
+	if (gid == N - 1)
+	{
+		lengths[run] = N;
+		runs[0] = run + 1;
+	}
+	else if (key != keys[gid + 1])
+		lengths[run] = gid + 1;
+}
+
+//------------------------------------------------------------
+// kernel__rleLengths
+//
+// Purpose : 4) The length of each run, from its end.
+//------------------------------------------------------------
+
+__kernel
+void kernel__rleLengths(
+	__global const INDEX_T* offsets,
+	__global INDEX_T* lengths,
+	__global const INDEX_T* runs)
+{
+	const INDEX_T gid = get_global_id(0);
+	if (gid >= runs[0])
+		return;
+
+	lengths[gid] -= offsets[gid];
+}
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "clpp/clppRunLengthEncode.h"
+#include "clpp/clppRunLengthEncode_CLKernel.h"
+#include "clpp/clpp.h"
+#include "clpp/clppBufferPool.h"
+#include "clpp/clppProfiler.h"
+
+#pragma region Constructor
+
+clppRunLengthEncode::clppRunLengthEncode(clppContext* context, clppDataType type, clppIndex maxElements)
+{
+	_context = context;
+	_operator = clppOperator(type);
+	_keys = 0;
+	_datasetSize = 0;
+	_clBuffer_keys = 0;
+	_is_clBuffersOwner = false;
+	_clBuffer_indices = 0;
+	_clBuffer_uniqueKeys = 0;
+	_clBuffer_offsets = 0;
+	_clBuffer_lengths = 0;
+	_clBuffer_count = 0;
+	_workgroupSize = 128;
+	_scan = 0;
+
+	if (!compile(_context, clCode_clppRunLengthEncode))
+		return;
+
+	//---- Prepare all the kernels
+	_kernel_Flags = getKernel("kernel__rleFlags");
+
+	_kernel_Scatter = getKernel("kernel__rleScatter");
+
+	_kernel_Lengths = getKernel("kernel__rleLengths");
+
+	//---- Prepare all the buffers
+	_clBuffer_indices = _context->getBufferPool()->acquire(sizeof(clppIndex) * maxElements);
+
+	_clBuffer_uniqueKeys = _context->getBufferPool()->acquire(_operator.getValueSize() * maxElements);
+
+	_clBuffer_offsets = _context->getBufferPool()->acquire(sizeof(clppIndex) * maxElements);
+
+	_clBuffer_lengths = _context->getBufferPool()->acquire(sizeof(clppIndex) * maxElements);
+
+	_clBuffer_count = _context->getBufferPool()->acquire(sizeof(clppIndex));
+
+	//---- The scan of the run heads
+	_scan = clpp::createBestScan(_context, clppOperator(clppDataType_Index), maxElements);
+}
+
+clppRunLengthEncode::~clppRunLengthEncode()
+{
+	if (_is_clBuffersOwner && _clBuffer_keys)
+		_context->getBufferPool()->release(_clBuffer_keys);
+
+	if (_clBuffer_indices)
+		_context->getBufferPool()->release(_clBuffer_indices);
+
+	if (_clBuffer_uniqueKeys)
+		_context->getBufferPool()->release(_clBuffer_uniqueKeys);
+
+	if (_clBuffer_offsets)
+		_context->getBufferPool()->release(_clBuffer_offsets);
+
+	if (_clBuffer_lengths)
+		_context->getBufferPool()->release(_clBuffer_lengths);
+
+	if (_clBuffer_count)
+		_context->getBufferPool()->release(_clBuffer_count);
+
+	delete _scan;
+}
+
+#pragma endregion
+
+#pragma region compilePreprocess
+
+string clppRunLengthEncode::compilePreprocess(string kernel)
+{
+	ostringstream source;
+
+	if (_operator.type == clppDataType_Double)
+		source << "#pragma OPENCL EXTENSION cl_khr_fp64 : enable" << endl;
+
+	source << "#define T " << _operator.getTypeName() << endl;
+
+	return clppProgram::compilePreprocess(source.str() + kernel);
+}
+
+#pragma endregion
+
+#pragma region encode
+
+void clppRunLengthEncode::encode()
+{
+	cl_int clStatus;
+
+	clppIndex N = _datasetSize;
+	if (N == 0)
+	{
+		static const clppIndex zero = 0;
+		clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_count, CL_FALSE, 0, sizeof(clppIndex), &zero, 0, NULL, NULL);
+		checkCLStatus(clStatus);
+		return;
+	}
+
+	size_t local[1] = {_workgroupSize};
+	size_t global[1] = {toMultipleOf(N, _workgroupSize)};
+
+	//---- 1) The run heads
+	clStatus  = clSetKernelArg(_kernel_Flags, 0, sizeof(cl_mem), (const void*)&_clBuffer_keys);
+	clStatus |= clSetKernelArg(_kernel_Flags, 1, sizeof(cl_mem), (const void*)&_clBuffer_indices);
+	clStatus |= clSetKernelArg(_kernel_Flags, 2, sizeof(clppIndex), (const void*)&N);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Flags, 1, NULL, global, local, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+
+	//---- 2) The run of each head (exclusive scan, in place)
+	_scan->pushCLDatas(_clBuffer_indices, N);
+	_scan->scan();
+
+	//---- 3) The keys, the offsets and the ends of the runs, and the number of runs
+	clStatus  = clSetKernelArg(_kernel_Scatter, 0, sizeof(cl_mem), (const void*)&_clBuffer_keys);
+	clStatus |= clSetKernelArg(_kernel_Scatter, 1, sizeof(cl_mem), (const void*)&_clBuffer_indices);
+	clStatus |= clSetKernelArg(_kernel_Scatter, 2, sizeof(cl_mem), (const void*)&_clBuffer_uniqueKeys);
+	clStatus |= clSetKernelArg(_kernel_Scatter, 3, sizeof(cl_mem), (const void*)&_clBuffer_offsets);
+	clStatus |= clSetKernelArg(_kernel_Scatter, 4, sizeof(cl_mem), (const void*)&_clBuffer_lengths);
+	clStatus |= clSetKernelArg(_kernel_Scatter, 5, sizeof(cl_mem), (const void*)&_clBuffer_count);
+	clStatus |= clSetKernelArg(_kernel_Scatter, 6, sizeof(clppIndex), (const void*)&N);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Scatter, 1, NULL, global, local, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+
+	//---- 4) The lengths (the number of runs stays on the device : launched for N, the extra work-items exit)
+	clStatus  = clSetKernelArg(_kernel_Lengths, 0, sizeof(cl_mem), (const void*)&_clBuffer_offsets);
+	clStatus |= clSetKernelArg(_kernel_Lengths, 1, sizeof(cl_mem), (const void*)&_clBuffer_lengths);
+	clStatus |= clSetKernelArg(_kernel_Lengths, 2, sizeof(cl_mem), (const void*)&_clBuffer_count);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Lengths, 1, NULL, global, local, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
+
+#pragma region pushDatas
+
+void clppRunLengthEncode::pushDatas(void* keys, size_t datasetSize)
+{
+	cl_int clStatus;
+
+	//---- Store some values
+	_keys = keys;
+	_datasetSize = datasetSize;
+
+	//---- Copy on the device, through a pinned buffer of the buffer pool
+	if (!_is_clBuffersOwner)
+		_clBuffer_keys = 0;
+
+	_clBuffer_keys = _context->getBufferPool()->resizePinned(_clBuffer_keys, _operator.getValueSize() * _datasetSize);
+	_is_clBuffersOwner = true;
+
+	clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_keys, CL_FALSE, 0, _operator.getValueSize() * _datasetSize, _keys, 0, 0, 0);
+	checkCLStatus(clStatus);
+}
+
+void clppRunLengthEncode::pushCLDatas(cl_mem clBuffer_keys, size_t datasetSize)
+{
+	if (_is_clBuffersOwner && _clBuffer_keys)
+		_context->getBufferPool()->release(_clBuffer_keys);
+
+	_is_clBuffersOwner = false;
+
+	_keys = 0;
+	_clBuffer_keys = clBuffer_keys;
+	_datasetSize = datasetSize;
+}
+
+#pragma endregion
+
+#pragma region popDatas
+
+clppIndex clppRunLengthEncode::popCount()
+{
+	clppIndex count = 0;
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_count, CL_TRUE, 0, sizeof(clppIndex), &count, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+
+	return count;
+}
+
+void clppRunLengthEncode::popDatas(void* uniqueKeys, clppIndex* offsets, clppIndex* lengths)
+{
+	clppIndex count = popCount();
+	if (count == 0)
+		return;
+
+	cl_int clStatus = CL_SUCCESS;
+
+	if (uniqueKeys)
+		clStatus |= _context->getProfiler()->enqueueReadBuffer(_clBuffer_uniqueKeys, CL_FALSE, 0, _operator.getValueSize() * count, uniqueKeys, 0, NULL, NULL);
+
+	if (offsets)
+		clStatus |= _context->getProfiler()->enqueueReadBuffer(_clBuffer_offsets, CL_FALSE, 0, sizeof(clppIndex) * count, offsets, 0, NULL, NULL);
+
+	if (lengths)
+		clStatus |= _context->getProfiler()->enqueueReadBuffer(_clBuffer_lengths, CL_FALSE, 0, sizeof(clppIndex) * count, lengths, 0, NULL, NULL);
+
+	clStatus |= clFinish(_context->clQueue);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,221 @@
+//------------------------------------------------------------
+// Purpose :
+// ---------
+// Single-pass exclusive scan : each element is read once and written once (~2n moves), where the
+// multi-level scans read and write the data set once per level, plus the uniform additions.
+//
+// Algorithm :
+// -----------
+// Chained scan with decoupled look-back. The data set is cut in tiles, one per work-group.
+// 1) Each work-group takes the next tile (atomic counter), so the tiles start in order : a tile only
+//    waits for tiles that are already running.
+// 2) The work-group reduces its tile and publishes the aggregate (status A).
+// 3) It looks back at the previous tiles, combining their aggregates until it finds an inclusive
+//    prefix (status P), then publishes its own inclusive prefix.
+// 4) It scans its tile with the exclusive prefix.
+//
+// Safe fallback : when a previous tile stays without status for SPIN_LIMIT reads (no forward progress
+// guarantee between work-groups), its aggregate is computed from its input by the waiting work-group.
+// The input of a tile is only overwritten after its status is published, so the value is kept only
+// if the status is still unset after the computation.
+//
+// The host defines :
+// T, OPERATOR_APPLY(A,B), OPERATOR_IDENTITY	The data type and the operator (clppOperator)
+// WORKGROUP_SIZE, ITEMS						The size of a work-group, and the elements per work-item
+// INDEX_T										The index type of the data set (uint, or ulong beyond 2^32 elements)
+//
+// References :
+// ------------
+// Single-pass Parallel Prefix Scan with Decoupled Look-back. Duane Merrill, Michael Garland.
+//------------------------------------------------------------
+
+#pragma OPENCL EXTENSION cl_amd_printf : enable
+
+#define TILE_SIZE (WORKGROUP_SIZE * ITEMS)
+
+#define STATUS_X 0		// Nothing published
+#define STATUS_A 1		// The aggregate of the tile
+#define STATUS_P 2		// The inclusive prefix of the tile
+
+#define SPIN_LIMIT 100000
+
+//------------------------------------------------------------
+// kernel__chainedInit
+//
+// Purpose : Clear the status of the tiles and the tile counter.
+//------------------------------------------------------------
+
+__kernel
+void kernel__chainedInit(
+	__global uint* status,
+	__global uint* tileCounter,
+	const uint tiles)
+{
+	const uint gid = get_global_id(0);
+
+	if (gid < tiles)
+		status[gid] = STATUS_X;
+
+	if (gid == 0)
+		tileCounter[0] = 0;
+}
+
+//------------------------------------------------------------
+// reduce_tile_serial
+//
+// Purpose : The aggregate of a tile, computed from its input (fallback of the look-back).
+//------------------------------------------------------------
+
+inline T reduce_tile_serial(volatile __global T* data, const uint tile, const INDEX_T N)
+{
+	const INDEX_T start = (INDEX_T)tile * TILE_SIZE;
+	const INDEX_T end = min(start + TILE_SIZE, N);
+
+	T value = OPERATOR_IDENTITY;
+	for(INDEX_T i = start; i < end; i++)
+		value = OPERATOR_APPLY(value, data[i]);
+
+	return value;
+}
+
+//------------------------------------------------------------
+// kernel__chainedScan
+//
+// Purpose : Exclusive scan of 'N' values in place, one tile per work-group.
+//------------------------------------------------------------
+
+__kernel
+void kernel__chainedScan(
+	volatile __global T* data,
+	volatile __global uint* status,
+	volatile __global T* aggregates,
+	volatile __global T* prefixes,
+	__global uint* tileCounter,
+	const INDEX_T N)
+{
+	const uint lid = get_local_id(0);
+
+	__local T tileData[TILE_SIZE];
+	__local T sums[WORKGROUP_SIZE];
+	__local uint tileId;
+	__local T tileExclusive;
+
+	//---- 1) Take the next tile
+	if (lid == 0)
+		tileId = atomic_inc(tileCounter);
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	const uint tile = tileId;
+	const INDEX_T base = (INDEX_T)tile * TILE_SIZE;
+
+	// Coalesced load
+	for(uint k = 0; k < ITEMS; k++)
+	{
+		const uint i = k * WORKGROUP_SIZE + lid;
+		tileData[i] = (base + i < N) ? data[base + i] : OPERATOR_IDENTITY;
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	//---- 2) Reduce the tile : each work-item reduces ITEMS consecutive elements, then a scan of the work-items
+	T value = OPERATOR_IDENTITY;
+	for(uint k = 0; k < ITEMS; k++)
+		value = OPERATOR_APPLY(value, tileData[lid * ITEMS + k]);
+
+	sums[lid] = value;
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for(uint offset = 1; offset < WORKGROUP_SIZE; offset <<= 1)
+	{
+		T left = (lid >= offset) ? sums[lid - offset] : OPERATOR_IDENTITY;
+		barrier(CLK_LOCAL_MEM_FENCE);
+		if (lid >= offset)
+			sums[lid] = OPERATOR_APPLY(left, sums[lid]);
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+
+	const T itemExclusive = (lid > 0) ? sums[lid - 1] : OPERATOR_IDENTITY;
+
+	//---- 3) Publish, look back, publish the inclusive prefix
+	if (lid == 0)
+	{
+		const T aggregate = sums[WORKGROUP_SIZE - 1];
+		T exclusive = OPERATOR_IDENTITY;
+
+		if (tile == 0)
+		{
+			prefixes[0] = aggregate;
+			write_mem_fence(CLK_GLOBAL_MEM_FENCE);
+			atomic_xchg(&status[0], STATUS_P);
+		}
+		else
+		{
+			aggregates[tile] = aggregate;
+			write_mem_fence(CLK_GLOBAL_MEM_FENCE);
+			atomic_xchg(&status[tile], STATUS_A);
+
+			int i = tile - 1;
+			uint spins = 0;
+			while (i >= 0)
+			{
+				uint s = atomic_or(&status[i], 0);
+				if (s == STATUS_X && ++spins < SPIN_LIMIT)
+					continue;
+
+				read_mem_fence(CLK_GLOBAL_MEM_FENCE);
+
+				if (s == STATUS_X)
+				{
+					// Fallback : reduce the input of the tile, kept if the tile is still not published
+					T fallback = reduce_tile_serial(data, i, N);
+					read_mem_fence(CLK_GLOBAL_MEM_FENCE);
+					s = atomic_or(&status[i], 0);
+					read_mem_fence(CLK_GLOBAL_MEM_FENCE);
+
+					if (s == STATUS_X)
+					{
+						exclusive = OPERATOR_APPLY(fallback, exclusive);
+						i--;
+						spins = 0;
+						continue;
+					}
+				}
+
+				spins = 0;
+				if (s == STATUS_P)
+				{
+					exclusive = OPERATOR_APPLY(prefixes[i], exclusive);
+					break;
+				}
+
+				exclusive = OPERATOR_APPLY(aggregates[i], exclusive);
+				i--;
+			}
+
+			prefixes[tile] = OPERATOR_APPLY(exclusive, aggregate);
+			write_mem_fence(CLK_GLOBAL_MEM_FENCE);
+			atomic_xchg(&status[tile], STATUS_P);
+		}
+
+		tileExclusive = exclusive;
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	//---- 4) Scan the tile
+	T running = OPERATOR_APPLY(tileExclusive, itemExclusive);
+	for(uint k = 0; k < ITEMS; k++)
+	{
+		const uint i = lid * ITEMS + k;
+		const T v = tileData[i];
+		tileData[i] = running;
+		running = OPERATOR_APPLY(running, v);
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	// Coalesced store
+	for(uint k = 0; k < ITEMS; k++)
+	{
+		const uint i = k * WORKGROUP_SIZE + lid;
+		if (base + i < N)
+			data[base + i] = tileData[i];
+	}
+}
\ No newline at end of file
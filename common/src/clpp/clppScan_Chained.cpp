@@ -0,0 +1,197 @@
+#include "clpp/clppScan_Chained.h"
+#include "clpp/clppScan_Chained_CLKernel.h"
+#include "clpp/clppBufferPool.h"
+#include "clpp/clppProfiler.h"
+
+#include <string.h>
+#include <algorithm>
+
+#pragma region Constructor
+
+clppScan_Chained::clppScan_Chained(clppContext* context, size_t valueSize, clppIndex maxElements) :
+	clppScan(context, valueSize, maxElements)
+{
+	initialize(maxElements);
+}
+
+clppScan_Chained::clppScan_Chained(clppContext* context, const clppOperator& op, clppIndex maxElements) :
+	clppScan(context, op, maxElements)
+{
+	initialize(maxElements);
+}
+
+void clppScan_Chained::initialize(clppIndex maxElements)
+{
+	_clBuffer_values = 0;
+	_clBuffer_status = 0;
+	_clBuffer_aggregates = 0;
+	_clBuffer_prefixes = 0;
+	_clBuffer_tileCounter = 0;
+	_workgroupSize = 256;
+	_itemsPerWorkitem = 4;
+
+	//---- Compilation (specialized for the data type and the operator)
+	if (!compile(_context, clCode_clppScan_Chained))
+		return;
+
+	//---- Prepare all the kernels
+	_kernel_Init = getKernel("kernel__chainedInit");
+
+	_kernel_Scan = getKernel("kernel__chainedScan");
+
+	//---- Prepare all the buffers
+	size_t tileSize = _workgroupSize * _itemsPerWorkitem;
+	size_t tiles = max((maxElements + tileSize - 1) / tileSize, (size_t)1);
+
+	_clBuffer_status = _context->getBufferPool()->acquire(sizeof(cl_uint) * tiles);
+
+	_clBuffer_aggregates = _context->getBufferPool()->acquire(_valueSize * tiles);
+
+	_clBuffer_prefixes = _context->getBufferPool()->acquire(_valueSize * tiles);
+
+	_clBuffer_tileCounter = _context->getBufferPool()->acquire(sizeof(cl_uint));
+}
+
+clppScan_Chained::~clppScan_Chained()
+{
+	if (_is_clBuffersOwner && _clBuffer_values)
+		_context->getBufferPool()->release(_clBuffer_values);
+
+	if (_clBuffer_status)
+		_context->getBufferPool()->release(_clBuffer_status);
+
+	if (_clBuffer_aggregates)
+		_context->getBufferPool()->release(_clBuffer_aggregates);
+
+	if (_clBuffer_prefixes)
+		_context->getBufferPool()->release(_clBuffer_prefixes);
+
+	if (_clBuffer_tileCounter)
+		_context->getBufferPool()->release(_clBuffer_tileCounter);
+}
+
+bool clppScan_Chained::isSupported(clppContext* context)
+{
+	//---- The look-back waits for other work-groups : only on GPUs, where the running work-groups are resident
+	if (!context->isGPU)
+		return false;
+
+	//---- The global atomics are in the core since OpenCL 1.1
+	char version[128] = "";
+	clGetDeviceInfo(context->clDevice, CL_DEVICE_VERSION, sizeof(version), version, NULL);
+	if (strncmp(version, "OpenCL 1.0", 10) == 0)
+		return false;
+
+	size_t maxWorkgroupSize = 0;
+	clGetDeviceInfo(context->clDevice, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(size_t), &maxWorkgroupSize, NULL);
+
+	return maxWorkgroupSize >= 256;
+}
+
+#pragma endregion
+
+#pragma region compilePreprocess
+
+string clppScan_Chained::compilePreprocess(string kernel)
+{
+	ostringstream source;
+
+	source << "#define WORKGROUP_SIZE " << _workgroupSize << endl;
+	source << "#define ITEMS " << _itemsPerWorkitem << endl;
+
+	return clppScan::compilePreprocess(source.str() + kernel);
+}
+
+#pragma endregion
+
+#pragma region scan
+
+void clppScan_Chained::scan()
+{
+	cl_int clStatus;
+
+	clppIndex N = _datasetSize;
+	if (N == 0)
+		return;
+
+	size_t tileSize = _workgroupSize * _itemsPerWorkitem;
+	cl_uint tiles = (N + tileSize - 1) / tileSize;
+
+	size_t local[1] = {_workgroupSize};
+
+	//---- Clear the status of the tiles
+	size_t globalInit[1] = {toMultipleOf(tiles, _workgroupSize)};
+
+	clStatus  = clSetKernelArg(_kernel_Init, 0, sizeof(cl_mem), &_clBuffer_status);
+	clStatus |= clSetKernelArg(_kernel_Init, 1, sizeof(cl_mem), &_clBuffer_tileCounter);
+	clStatus |= clSetKernelArg(_kernel_Init, 2, sizeof(unsigned int), &tiles);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Init, 1, NULL, globalInit, local, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+
+	//---- The scan, one work-group per tile
+	size_t global[1] = {tiles * _workgroupSize};
+
+	clStatus  = clSetKernelArg(_kernel_Scan, 0, sizeof(cl_mem), &_clBuffer_values);
+	clStatus |= clSetKernelArg(_kernel_Scan, 1, sizeof(cl_mem), &_clBuffer_status);
+	clStatus |= clSetKernelArg(_kernel_Scan, 2, sizeof(cl_mem), &_clBuffer_aggregates);
+	clStatus |= clSetKernelArg(_kernel_Scan, 3, sizeof(cl_mem), &_clBuffer_prefixes);
+	clStatus |= clSetKernelArg(_kernel_Scan, 4, sizeof(cl_mem), &_clBuffer_tileCounter);
+	clStatus |= clSetKernelArg(_kernel_Scan, 5, sizeof(clppIndex), &N);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Scan, 1, NULL, global, local, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
+
+#pragma region pushDatas
+
+void clppScan_Chained::pushDatas(void* values, size_t datasetSize)
+{
+	cl_int clStatus;
+
+	//---- Store some values
+	_values = values;
+	_datasetSize = datasetSize;
+
+	//---- Copy on the device, through a pinned buffer of the buffer pool
+	if (!_is_clBuffersOwner)
+		_clBuffer_values = 0;
+
+	_clBuffer_values = _context->getBufferPool()->resizePinned(_clBuffer_values, _valueSize * _datasetSize);
+	_is_clBuffersOwner = true;
+
+	clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_values, CL_FALSE, 0, _valueSize * _datasetSize, _values, 0, 0, 0);
+	checkCLStatus(clStatus);
+}
+
+void clppScan_Chained::pushCLDatas(cl_mem clBuffer_values, size_t datasetSize)
+{
+	_values = 0;
+
+	//---- Give back the buffer of 'pushDatas'
+	if (_is_clBuffersOwner && _clBuffer_values)
+		_context->getBufferPool()->release(_clBuffer_values);
+
+	_is_clBuffersOwner = false;
+
+	_clBuffer_values = clBuffer_values;
+	_datasetSize = datasetSize;
+}
+
+#pragma endregion
+
+#pragma region popDatas
+
+void clppScan_Chained::popDatas()
+{
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_values, CL_TRUE, 0, _valueSize * _datasetSize, _values, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+void clppScan_Chained::popDatas(void* dataSet)
+{
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_values, CL_TRUE, 0, _valueSize * _datasetSize, dataSet, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
\ No newline at end of file
@@ -36,7 +36,8 @@
 //------------------------------------------------------------
 
 #pragma OPENCL EXTENSION cl_amd_printf : enable
-#define T int
+// The data type and the operator are defined by the host (clppOperator), the default is a sum of int.
+// The host also defines INDEX_T, the index type of the data set (uint, or ulong for more than 2^32 elements).
 //#define SUPPORT_AVOID_BANK_CONFLICT
 
 //------------------------------------------------------------
@@ -70,7 +71,7 @@ void kernel__ExclusivePrefixScanSmall(
 			int ai = offset*(2*tid + 1) - 1;
 			int bi = offset*(2*tid + 2) - 1;
 			
-			block[bi] += block[ai];
+			block[bi] = OPERATOR_APPLY(block[bi], block[ai]);
 		}
 		offset *= 2;
 	}
@@ -79,7 +80,7 @@ void kernel__ExclusivePrefixScanSmall(
 
     // Clear the last element
 	if(tid == 0)
-		block[length - 1] = 0;
+		block[length - 1] = OPERATOR_IDENTITY;
 
     // traverse down the tree building the scan in the place
 	for(int d = 1; d < length ; d *= 2)
@@ -92,9 +93,9 @@ void kernel__ExclusivePrefixScanSmall(
 			int ai = offset*(2*tid + 1) - 1;
 			int bi = offset*(2*tid + 2) - 1;
 			
-			float t = block[ai];
+			T t = block[ai];
 			block[ai] = block[bi];
-			block[bi] += t;
+			block[bi] = OPERATOR_APPLY(block[bi], t);
 		}
 	}
 	
@@ -136,10 +137,10 @@ void kernel__ExclusivePrefixScan(
 	__local T* localBuffer,
 	
 	__global T* blockSums,
-	const uint blockSumsSize
+	const INDEX_T blockSumsSize
 	)
 {
-	const uint gid = get_global_id(0);
+	const INDEX_T gid = get_global_id(0);
 	const uint tid = get_local_id(0);
 	const uint bid = get_group_id(0);
 	const uint lwz  = get_local_size(0);
@@ -151,23 +152,23 @@ void kernel__ExclusivePrefixScan(
     const int tid2_0 = tid << 1;
     const int tid2_1 = tid2_0 + 1;
 	
-	const int gid2_0 = gid << 1;
-    const int gid2_1 = gid2_0 + 1;
+	const INDEX_T gid2_0 = gid << 1;
+    const INDEX_T gid2_1 = gid2_0 + 1;
 
 	// Cache the datas in local memory
 
 #ifdef SUPPORT_AVOID_BANK_CONFLICT
 	uint ai = tid;
 	uint bi = tid + lwz;
-	uint gai = gid;
-	uint gbi = gid + lwz;
+	INDEX_T gai = gid;
+	INDEX_T gbi = gid + lwz;
 	uint bankOffsetA = CONFLICT_FREE_OFFSET(ai); 
 	uint bankOffsetB = CONFLICT_FREE_OFFSET(bi);
-	localBuffer[ai + bankOffsetA] = (gai < blockSumsSize) ? dataSet[gai] : 0; 
-	localBuffer[bi + bankOffsetB] = (gbi < blockSumsSize) ? dataSet[gbi] : 0;
+	localBuffer[ai + bankOffsetA] = (gai < blockSumsSize) ? dataSet[gai] : OPERATOR_IDENTITY; 
+	localBuffer[bi + bankOffsetB] = (gbi < blockSumsSize) ? dataSet[gbi] : OPERATOR_IDENTITY;
 #else
-	localBuffer[tid2_0] = (gid2_0 < blockSumsSize) ? dataSet[gid2_0] : 0;
-	localBuffer[tid2_1] = (gid2_1 < blockSumsSize) ? dataSet[gid2_1] : 0;
+	localBuffer[tid2_0] = (gid2_0 < blockSumsSize) ? dataSet[gid2_0] : OPERATOR_IDENTITY;
+	localBuffer[tid2_1] = (gid2_1 < blockSumsSize) ? dataSet[gid2_1] : OPERATOR_IDENTITY;
 #endif
 	
     // bottom-up
@@ -190,7 +191,7 @@ void kernel__ExclusivePrefixScan(
             const uint bi = mad24(offset, (tid2_1+1), -1);	// offset*(tid2_1+1)-1;
 #endif
 
-            localBuffer[bi] += localBuffer[ai];
+            localBuffer[bi] = OPERATOR_APPLY(localBuffer[bi], localBuffer[ai]);
         }
         offset <<= 1;
     }
@@ -213,13 +214,13 @@ void kernel__ExclusivePrefixScan(
 		uint index = localBufferSize-1;
 		index += CONFLICT_FREE_OFFSET(index);
 		blockSums[bid] = localBuffer[index];
-		localBuffer[index] = 0;
+		localBuffer[index] = OPERATOR_IDENTITY;
 #else
 		// We store the biggest value (the last) to the sum-block for later use.
         blockSums[bid] = localBuffer[localBufferSize-1];		
 		//barrier(CLK_LOCAL_MEM_FENCE | CLK_GLOBAL_MEM_FENCE);		
 		// Clear the last element
-        localBuffer[localBufferSize - 1] = 0;
+        localBuffer[localBufferSize - 1] = OPERATOR_IDENTITY;
 #endif
     }
 
@@ -246,7 +247,7 @@ void kernel__ExclusivePrefixScan(
 
             T tmp = localBuffer[ai];
             localBuffer[ai] = localBuffer[bi];
-            localBuffer[bi] += tmp;
+            localBuffer[bi] = OPERATOR_APPLY(localBuffer[bi], tmp);
         }
     }
 
@@ -255,8 +256,10 @@ void kernel__ExclusivePrefixScan(
     // Copy back from the local buffer to the output array
 	
 #ifdef SUPPORT_AVOID_BANK_CONFLICT
-	dataSet[gai] = (gai < blockSumsSize) * localBuffer[ai + bankOffsetA];		
-	dataSet[gbi] = (gbi < blockSumsSize) * localBuffer[bi + bankOffsetB];		
+	if (gai < blockSumsSize)
+		dataSet[gai] = localBuffer[ai + bankOffsetA];
+	if (gbi < blockSumsSize)
+		dataSet[gbi] = localBuffer[bi + bankOffsetB];
 #else
 	if (gid2_0 < blockSumsSize)
 		dataSet[gid2_0] = localBuffer[tid2_0];
@@ -277,10 +280,10 @@ __kernel
 void kernel__UniformAdd(
 	__global T* output,
 	__global const T* blockSums,
-	const uint outputSize
+	const INDEX_T outputSize
 	)
 {
-    uint gid = get_global_id(0) * 2;
+    INDEX_T gid = (INDEX_T)get_global_id(0) * 2;
     const uint tid = get_local_id(0);
     const uint blockId = get_group_id(0);
 	
@@ -302,15 +305,16 @@ void kernel__UniformAdd(
     barrier(CLK_LOCAL_MEM_FENCE);
 	
 #ifdef SUPPORT_AVOID_BANK_CONFLICT
-	unsigned int address = blockId * get_local_size(0) * 2 + get_local_id(0); 
+	INDEX_T address = (INDEX_T)blockId * get_local_size(0) * 2 + get_local_id(0); 
 	
-	output[address] += localBuffer[0];
-    output[address + get_local_size(0)] += (get_local_id(0) + get_local_size(0) < outputSize) * localBuffer[0];
+	output[address] = OPERATOR_APPLY(output[address], localBuffer[0]);
+	if (get_local_id(0) + get_local_size(0) < outputSize)
+		output[address + get_local_size(0)] = OPERATOR_APPLY(output[address + get_local_size(0)], localBuffer[0]);
 #else
 	if (gid < outputSize)
-		output[gid] += localBuffer[0];
+		output[gid] = OPERATOR_APPLY(output[gid], localBuffer[0]);
 	gid++;
 	if (gid < outputSize)
-		output[gid] += localBuffer[0];
+		output[gid] = OPERATOR_APPLY(output[gid], localBuffer[0]);
 #endif
 }
\ No newline at end of file
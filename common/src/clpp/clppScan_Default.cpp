@@ -1,5 +1,7 @@
 #include "clpp/clppScan_Default.h"
 #include "clpp/clppScan_Default_CLKernel.h"
+#include "clpp/clppBufferPool.h"
+#include "clpp/clppProfiler.h"
 
 // Next :
 // 1 - Allow templating
@@ -7,29 +9,39 @@
 
 #pragma region Constructor
 
-clppScan_Default::clppScan_Default(clppContext* context, size_t valueSize, unsigned int maxElements) :
+clppScan_Default::clppScan_Default(clppContext* context, size_t valueSize, clppIndex maxElements) :
 	clppScan(context, valueSize, maxElements) 
+{
+	// The legacy scan of this kernel is a sum of int
+	_operator = clppOperator(clppDataType_Int);
+	initialize(maxElements);
+}
+
+clppScan_Default::clppScan_Default(clppContext* context, const clppOperator& op, clppIndex maxElements) :
+	clppScan(context, op, maxElements) 
+{
+	initialize(maxElements);
+}
+
+void clppScan_Default::initialize(clppIndex maxElements)
 {
 	_clBuffer_values = 0;
 	_clBuffer_BlockSums = 0;
 
-	if (!compile(context, clCode_clppScan_Default))
+	//---- Compilation (specialized for the data type and the operator)
+	if (!compile(_context, clCode_clppScan_Default))
 		return;
 
 	//if (!compile(context, string("clppScan_Default.cl")))
 	//	return;
 
 	//---- Prepare all the kernels
-	cl_int clStatus;
-
-	_kernel_Scan = clCreateKernel(_clProgram, "kernel__ExclusivePrefixScan", &clStatus);
-	checkCLStatus(clStatus);
+	_kernel_Scan = getKernel("kernel__ExclusivePrefixScan");
 
 	//_kernel_ScanSmall = clCreateKernel(_clProgram, "kernel__ExclusivePrefixScanSmall", &clStatus);
 	//checkCLStatus(clStatus);
 
-	_kernel_UniformAdd = clCreateKernel(_clProgram, "kernel__UniformAdd", &clStatus);
-	checkCLStatus(clStatus);
+	_kernel_UniformAdd = getKernel("kernel__UniformAdd");
 
 	//---- Get the workgroup size
 	clGetKernelWorkGroupInfo(_kernel_Scan, _context->clDevice, CL_KERNEL_WORK_GROUP_SIZE, sizeof(size_t), &_workgroupSize, 0);
@@ -45,7 +57,7 @@ clppScan_Default::clppScan_Default(clppContext* context, size_t valueSize, unsig
 clppScan_Default::~clppScan_Default()
 {
 	if (_is_clBuffersOwner && _clBuffer_values)
-		clReleaseMemObject(_clBuffer_values);
+		_context->getBufferPool()->release(_clBuffer_values);
 
 	freeBlockSums();
 }
@@ -71,9 +83,9 @@ void clppScan_Default::scan()
 
 		clStatus = clSetKernelArg(_kernel_Scan, 0, sizeof(cl_mem), &clValues);
 		clStatus |= clSetKernelArg(_kernel_Scan, 2, sizeof(cl_mem), &_clBuffer_BlockSums[i]);
-		clStatus |= clSetKernelArg(_kernel_Scan, 3, sizeof(int), &_blockSumsSizes[i]);
+		clStatus |= clSetKernelArg(_kernel_Scan, 3, sizeof(clppIndex), &_blockSumsSizes[i]);
 
-		clStatus |= clEnqueueNDRangeKernel(_context->clQueue, _kernel_Scan, 1, NULL, &globalWorkSize, &localWorkSize, 0, NULL, NULL);
+		clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Scan, 1, NULL, &globalWorkSize, &localWorkSize, 0, NULL, NULL);
 		checkCLStatus(clStatus);
 
 		clValues = _clBuffer_BlockSums[i];
@@ -91,10 +103,10 @@ void clppScan_Default::scan()
 		checkCLStatus(clStatus);
 		clStatus = clSetKernelArg(_kernel_UniformAdd, 1, sizeof(cl_mem), &_clBuffer_BlockSums[i]);
 		checkCLStatus(clStatus);
-		clStatus = clSetKernelArg(_kernel_UniformAdd, 2, sizeof(int), &_blockSumsSizes[i]);
+		clStatus = clSetKernelArg(_kernel_UniformAdd, 2, sizeof(clppIndex), &_blockSumsSizes[i]);
 		checkCLStatus(clStatus);
 
-		clStatus = clEnqueueNDRangeKernel(_context->clQueue, _kernel_UniformAdd, 1, NULL, &globalWorkSize, &localWorkSize, 0, NULL, NULL);
+		clStatus = _context->getProfiler()->enqueueNDRangeKernel(_kernel_UniformAdd, 1, NULL, &globalWorkSize, &localWorkSize, 0, NULL, NULL);
 		checkCLStatus(clStatus);
     }
 }
@@ -109,7 +121,6 @@ void clppScan_Default::pushDatas(void* values, size_t datasetSize)
 
 	//---- Store some values
 	_values = values;
-	bool reallocate = datasetSize > _datasetSize || !_is_clBuffersOwner;
 	bool recompute =  datasetSize != _datasetSize;
 	_datasetSize = datasetSize;
 
@@ -118,7 +129,7 @@ void clppScan_Default::pushDatas(void* values, size_t datasetSize)
 	if (recompute)
 	{
 		_pass = 0;
-		unsigned int n = _datasetSize;
+		clppIndex n = _datasetSize;
 		do
 		{
 			n = (n + _workgroupSize - 1) / _workgroupSize; // round up
@@ -136,24 +147,25 @@ void clppScan_Default::pushDatas(void* values, size_t datasetSize)
 		_blockSumsSizes[_pass] = n;
 	}
 
-	//---- Copy on the device
-	if (reallocate)
-	{
-		//---- Release
-		if (_clBuffer_values)
-			clReleaseMemObject(_clBuffer_values);
+	//---- Copy on the device, through a pinned buffer of the buffer pool
+	if (!_is_clBuffersOwner)
+		_clBuffer_values = 0;
 
-		_clBuffer_values  = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, _valueSize * _datasetSize, _values, &clStatus);
-		_is_clBuffersOwner = true;
-		checkCLStatus(clStatus);
-	}
-	else
-		// Just resend
-		clEnqueueWriteBuffer(_context->clQueue, _clBuffer_values, CL_FALSE, 0, _valueSize * _datasetSize, _values, 0, 0, 0);
+	_clBuffer_values = _context->getBufferPool()->resizePinned(_clBuffer_values, _valueSize * _datasetSize);
+	_is_clBuffersOwner = true;
+
+	clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_values, CL_FALSE, 0, _valueSize * _datasetSize, _values, 0, 0, 0);
+	checkCLStatus(clStatus);
 }
 
 void clppScan_Default::pushCLDatas(cl_mem clBuffer_values, size_t datasetSize)
 {
+	//---- Give back the buffer of 'pushDatas'
+	if (_is_clBuffersOwner && _clBuffer_values)
+		_context->getBufferPool()->release(_clBuffer_values);
+
+	_is_clBuffersOwner = false;
+
 	_values = 0;
 	_clBuffer_values = clBuffer_values;
 	bool recompute =  datasetSize != _datasetSize;
@@ -164,7 +176,7 @@ void clppScan_Default::pushCLDatas(cl_mem clBuffer_values, size_t datasetSize)
 	if (recompute)
 	{
 		_pass = 0;
-		unsigned int n = _datasetSize;
+		clppIndex n = _datasetSize;
 		do
 		{
 			n = (n + _workgroupSize - 1) / _workgroupSize; // round up
@@ -191,13 +203,13 @@ void clppScan_Default::pushCLDatas(cl_mem clBuffer_values, size_t datasetSize)
 
 void clppScan_Default::popDatas()
 {
-	cl_int clStatus = clEnqueueReadBuffer(_context->clQueue, _clBuffer_values, CL_TRUE, 0, _valueSize * _datasetSize, _values, 0, NULL, NULL);
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_values, CL_TRUE, 0, _valueSize * _datasetSize, _values, 0, NULL, NULL);
 	checkCLStatus(clStatus);
 }
 
 void clppScan_Default::popDatas(void* dataSet)
 {
-	cl_int clStatus = clEnqueueReadBuffer(_context->clQueue, _clBuffer_values, CL_TRUE, 0, _valueSize * _datasetSize, dataSet, 0, NULL, NULL);
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_values, CL_TRUE, 0, _valueSize * _datasetSize, dataSet, 0, NULL, NULL);
 	checkCLStatus(clStatus);
 }
 
@@ -205,12 +217,11 @@ void clppScan_Default::popDatas(void* dataSet)
 
 #pragma region allocateBlockSums
 
-void clppScan_Default::allocateBlockSums(unsigned int maxElements)
+void clppScan_Default::allocateBlockSums(clppIndex maxElements)
 {
 	// Compute the number of buffers we need for the scan
-	cl_int clStatus;
 	_pass = 0;
-	unsigned int n = maxElements;
+	clppIndex n = maxElements;
 	do
 	{
 		n = (n + _workgroupSize - 1) / _workgroupSize; // round up
@@ -220,7 +231,7 @@ void clppScan_Default::allocateBlockSums(unsigned int maxElements)
 
 	// Allocate the arrays
 	_clBuffer_BlockSums = new cl_mem[_pass];
-	_blockSumsSizes = new unsigned int[_pass + 1];
+	_blockSumsSizes = new clppIndex[_pass + 1];
 
 	// Create the cl-buffers
 	n = maxElements;
@@ -228,14 +239,11 @@ void clppScan_Default::allocateBlockSums(unsigned int maxElements)
 	{
 		_blockSumsSizes[i] = n;
 
-		_clBuffer_BlockSums[i] = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, sizeof(int) * n, NULL, &clStatus);
-		checkCLStatus(clStatus);
+		_clBuffer_BlockSums[i] = _context->getBufferPool()->acquire(_valueSize * n);
 
 		n = (n + _workgroupSize - 1) / _workgroupSize; // round up
 	}
 	_blockSumsSizes[_pass] = n;
-
-	checkCLStatus(clStatus);
 }
 
 void clppScan_Default::freeBlockSums()
@@ -243,10 +251,8 @@ void clppScan_Default::freeBlockSums()
 	if (!_clBuffer_BlockSums)
 		return;
 
-    cl_int clStatus;
-    
 	for(unsigned int i = 0; i < _pass; i++)
-		clStatus = clReleaseMemObject(_clBuffer_BlockSums[i]);
+		_context->getBufferPool()->release(_clBuffer_BlockSums[i]);
 
 	delete [] _clBuffer_BlockSums;
 	delete [] _blockSumsSizes;
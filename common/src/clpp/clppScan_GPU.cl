@@ -35,10 +35,9 @@
 
 #pragma OPENCL EXTENSION cl_amd_printf : enable
 
-#define T uint
+// The data type and the operator are defined by the host (clppOperator), the default is a sum of uint.
+// The host also defines INDEX_T, the index type of the data set (uint, or ulong for more than 2^32 elements).
 #define OPERATOR_INDEXOF(I) I
-#define OPERATOR_APPLY(A,B) A+B
-#define OPERATOR_IDENTITY 0
 
 //#define VOLATILE volatile
 #define VOLATILE
@@ -100,9 +99,9 @@ __kernel
 void kernel__scan_block_anylength(
 	__local T* localBuf,
 	__global T* dataSet,
-	const uint B,
-	uint size,
-	const uint passesCount
+	const INDEX_T B,
+	INDEX_T size,
+	const INDEX_T passesCount
 )
 {	
 	size_t idx = get_local_id(0);
@@ -115,10 +114,10 @@ void kernel__scan_block_anylength(
 	T reduceValue = OPERATOR_IDENTITY;
 	
 	//#pragma unroll 4
-	for(uint i = 0; i < passesCount; ++i)
+	for(INDEX_T i = 0; i < passesCount; ++i)
 	{
-		const uint offset = i * TC + (bidx * B);
-		const uint offsetIdx = offset + idx;
+		const INDEX_T offset = i * TC + (bidx * B);
+		const INDEX_T offsetIdx = offset + idx;
 		
 #ifdef OCL_PLATFORM_AMD
 		if (offsetIdx > size-1)
@@ -1,5 +1,7 @@
 #include "clpp/clppScan_GPU.h"
 #include "clpp/clppScan_GPU_CLKernel.h"
+#include "clpp/clppBufferPool.h"
+#include "clpp/clppProfiler.h"
 
 #include <iostream>
 
@@ -11,19 +13,28 @@
 
 #pragma region Constructor
 
-clppScan_GPU::clppScan_GPU(clppContext* context, size_t valueSize, unsigned int maxElements) :
+clppScan_GPU::clppScan_GPU(clppContext* context, size_t valueSize, clppIndex maxElements) :
 	clppScan(context, valueSize, maxElements) 
 {
-	cl_int clStatus;
+	initialize();
+}
+
+clppScan_GPU::clppScan_GPU(clppContext* context, const clppOperator& op, clppIndex maxElements) :
+	clppScan(context, op, maxElements) 
+{
+	initialize();
+}
+
+void clppScan_GPU::initialize()
+{
 	_clBuffer_values = 0;
 
-	//---- Compilation
-	if (!compile(context, clCode_clppScan_GPU))
+	//---- Compilation (specialized for the data type and the operator)
+	if (!compile(_context, clCode_clppScan_GPU))
 		return;
 
 	//---- Prepare all the kernels
-	kernel__scan = clCreateKernel(_clProgram, "kernel__scan_block_anylength", &clStatus);
-	checkCLStatus(clStatus);
+	kernel__scan = getKernel("kernel__scan_block_anylength");
 
 	//---- Get the workgroup size
 	// ATI : Actually the wavefront size is only 64 for the highend cards(48XX, 58XX, 57XX), but 32 for the middleend cards and 16 for the lowend cards.
@@ -37,7 +48,7 @@ clppScan_GPU::clppScan_GPU(clppContext* context, size_t valueSize, unsigned int
 clppScan_GPU::~clppScan_GPU()
 {
 	if (_is_clBuffersOwner && _clBuffer_values)
-		clReleaseMemObject(_clBuffer_values);
+		_context->getBufferPool()->release(_clBuffer_values);
 }
 
 #pragma endregion
@@ -73,19 +84,20 @@ void clppScan_GPU::scan()
 {
 	cl_int clStatus;
 
-	int blockSize = _datasetSize / _workgroupSize;
-	int B = blockSize * _workgroupSize;
-	if ((_datasetSize % _workgroupSize) > 0) { blockSize++; };
+	clppIndex N = _datasetSize;
+	clppIndex blockSize = N / _workgroupSize;
+	clppIndex B = blockSize * _workgroupSize;
+	if ((N % _workgroupSize) > 0) { blockSize++; };
 	size_t localWorkSize = {_workgroupSize};
-	size_t globalWorkSize = {toMultipleOf(_datasetSize / blockSize, _workgroupSize)};
+	size_t globalWorkSize = {toMultipleOf(N / blockSize, _workgroupSize)};
 
 	clStatus  = clSetKernelArg(kernel__scan, 0, _workgroupSize * _valueSize, 0);
 	clStatus |= clSetKernelArg(kernel__scan, 1, sizeof(cl_mem), &_clBuffer_values);
-	clStatus |= clSetKernelArg(kernel__scan, 2, sizeof(int), &B);
-	clStatus |= clSetKernelArg(kernel__scan, 3, sizeof(int), &_datasetSize);
-	clStatus |= clSetKernelArg(kernel__scan, 4, sizeof(int), &blockSize);
+	clStatus |= clSetKernelArg(kernel__scan, 2, sizeof(clppIndex), &B);
+	clStatus |= clSetKernelArg(kernel__scan, 3, sizeof(clppIndex), &N);
+	clStatus |= clSetKernelArg(kernel__scan, 4, sizeof(clppIndex), &blockSize);
 
-	clStatus |= clEnqueueNDRangeKernel(_context->clQueue, kernel__scan, 1, NULL, &globalWorkSize, &localWorkSize, 0, NULL, NULL);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(kernel__scan, 1, NULL, &globalWorkSize, &localWorkSize, 0, NULL, NULL);
 	checkCLStatus(clStatus);
 }
 
@@ -128,32 +140,27 @@ void clppScan_GPU::pushDatas(void* values, size_t datasetSize)
 
 	//---- Store some values
 	_values = values;
-	bool reallocate = datasetSize > _datasetSize || !_is_clBuffersOwner;
 	_datasetSize = datasetSize;
 
-	//---- Copy on the device
-	if (reallocate)
-	{
-		//---- Release
-		if (_clBuffer_values)
-			clReleaseMemObject(_clBuffer_values);
-
-		//---- Allocate & copy on the device
-		_clBuffer_values = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, _valueSize * _datasetSize, _values, &clStatus);
-		_is_clBuffersOwner = true;
-		checkCLStatus(clStatus);
-
-		_is_clBuffersOwner = true;
-	}
-	else
-		// Just resend
-		clEnqueueWriteBuffer(_context->clQueue, _clBuffer_values, CL_FALSE, 0, _valueSize * _datasetSize, _values, 0, 0, 0);
+	//---- Copy on the device, through a pinned buffer of the buffer pool
+	if (!_is_clBuffersOwner)
+		_clBuffer_values = 0;
+
+	_clBuffer_values = _context->getBufferPool()->resizePinned(_clBuffer_values, _valueSize * _datasetSize);
+	_is_clBuffersOwner = true;
+
+	clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_values, CL_FALSE, 0, _valueSize * _datasetSize, _values, 0, 0, 0);
+	checkCLStatus(clStatus);
 }
 
 void clppScan_GPU::pushCLDatas(cl_mem clBuffer_values, size_t datasetSize)
 {
 	_values = 0;
 
+	//---- Give back the buffer of 'pushDatas'
+	if (_is_clBuffersOwner && _clBuffer_values)
+		_context->getBufferPool()->release(_clBuffer_values);
+
 	_is_clBuffersOwner = false;
 
 	_clBuffer_values = clBuffer_values;
@@ -166,13 +173,13 @@ void clppScan_GPU::pushCLDatas(cl_mem clBuffer_values, size_t datasetSize)
 
 void clppScan_GPU::popDatas()
 {
-	cl_int clStatus = clEnqueueReadBuffer(_context->clQueue, _clBuffer_values, CL_TRUE, 0, _valueSize * _datasetSize, _values, 0, NULL, NULL);
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_values, CL_TRUE, 0, _valueSize * _datasetSize, _values, 0, NULL, NULL);
 	checkCLStatus(clStatus);
 }
 
 void clppScan_GPU::popDatas(void* dataSet)
 {
-	cl_int clStatus = clEnqueueReadBuffer(_context->clQueue, _clBuffer_values, CL_TRUE, 0, _valueSize * _datasetSize, dataSet, 0, NULL, NULL);
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_values, CL_TRUE, 0, _valueSize * _datasetSize, dataSet, 0, NULL, NULL);
 	checkCLStatus(clStatus);
 }
 
@@ -0,0 +1,84 @@
+//------------------------------------------------------------
+// Purpose :
+// ---------
+// Segmented reduction : one result per segment, the segments are given by head flags or by offsets.
+//
+// Algorithm :
+// -----------
+// The segmented reduction is an inclusive segmented scan (clppSegmentedScan.cl) : the result of a segment
+// is the value of its last element. With head flags, the offsets of the segments are computed with a scan
+// of the flags, then each segment reads the scanned value before the next offset.
+//
+// The host defines :
+// T, OPERATOR_IDENTITY		The data type and the identity of the operator (clppOperator)
+// INDEX_T					The index type of the data set (clppIndex)
+//------------------------------------------------------------
+
+#pragma OPENCL EXTENSION cl_amd_printf : enable
+
+//------------------------------------------------------------
+// kernel__segHeadFlags, kernel__segHeadOffsets
+//
+// Purpose : Build the offsets of the segments from the head flags (the first element always starts a segment).
+// The flags are scanned between the two kernels.
+//------------------------------------------------------------
+
+__kernel
+void kernel__segHeadFlags(
+	__global const uchar* heads,
+	__global INDEX_T* indices,
+	const INDEX_T N)
+{
+	const INDEX_T gid = get_global_id(0);
+	if (gid >= N)
+		return;
+
+	indices[gid] = (gid == 0 || heads[gid] != 0) ? 1 : 0;
+}
+
+__kernel
+void kernel__segHeadOffsets(
+	__global const uchar* heads,
+	__global const INDEX_T* indices,
+	__global INDEX_T* offsets,
+	__global INDEX_T* segments,
+	const INDEX_T N)
+{
+	const INDEX_T gid = get_global_id(0);
+	if (gid >= N)
+		return;
+
+	const INDEX_T head = (gid == 0 || heads[gid] != 0) ? 1 : 0;
+
+	if (head)
+		offsets[indices[gid]] = gid;
+
+	if (gid == N - 1)
+		segments[0] = indices[gid] + head;
+}
+
+//------------------------------------------------------------
+// kernel__segReduceGather
+//
+// Purpose : The result of each segment : the last value of the inclusive segmented scan.
+// An empty segment gives the identity.
+//------------------------------------------------------------
+
+__kernel
+void kernel__segReduceGather(
+	__global const T* scanned,
+	__global const INDEX_T* offsets,
+	__global const INDEX_T* segments,
+	__global T* output,
+	const INDEX_T N)
+{
+	const INDEX_T gid = get_global_id(0);
+	const INDEX_T S = segments[0];
+	if (gid >= S)
+		return;
+
+	const INDEX_T start = offsets[gid];
+	const INDEX_T end = (gid + 1 < S) ? offsets[gid + 1] : N;
+
+	output[gid] = (end > start) ? scanned[end - 1] : OPERATOR_IDENTITY;
+}
\ No newline at end of file
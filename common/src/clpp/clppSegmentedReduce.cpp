@@ -0,0 +1,243 @@
+#include "clpp/clppSegmentedReduce.h"
+#include "clpp/clppSegmentedReduce_CLKernel.h"
+#include "clpp/clpp.h"
+#include "clpp/clppBufferPool.h"
+#include "clpp/clppProfiler.h"
+
+#include <algorithm>
+
+#pragma region Constructor
+
+clppSegmentedReduce::clppSegmentedReduce(clppContext* context, const clppOperator& op, clppIndex maxElements)
+{
+	_operator = op;
+	_dataSet = 0;
+	_datasetSize = 0;
+	_clBuffer_dataSet = 0;
+	_is_clBuffersOwner = false;
+	_clBuffer_heads = 0;
+	_clBuffer_offsets = 0;
+	_segments = 0;
+	_clBuffer_scanned = 0;
+	_clBuffer_indices = 0;
+	_clBuffer_ownOffsets = 0;
+	_clBuffer_output = 0;
+	_clBuffer_count = 0;
+	_workgroupSize = 128;
+	_segmentedScan = 0;
+	_scan = 0;
+	_context = context;
+
+	//---- Compilation (specialized for the data type and the operator)
+	if (!compile(context, clCode_clppSegmentedReduce))
+		return;
+
+	//---- Prepare all the kernels
+	_kernel_HeadFlags = getKernel("kernel__segHeadFlags");
+
+	_kernel_HeadOffsets = getKernel("kernel__segHeadOffsets");
+
+	_kernel_Gather = getKernel("kernel__segReduceGather");
+
+	//---- Prepare all the buffers
+	size_t elements = max(maxElements, (clppIndex)1);
+
+	_clBuffer_scanned = _context->getBufferPool()->acquire(_operator.getValueSize() * elements);
+
+	_clBuffer_indices = _context->getBufferPool()->acquire(sizeof(clppIndex) * elements);
+
+	_clBuffer_ownOffsets = _context->getBufferPool()->acquire(sizeof(clppIndex) * elements);
+
+	_clBuffer_output = _context->getBufferPool()->acquire(_operator.getValueSize() * elements);
+
+	_clBuffer_count = _context->getBufferPool()->acquire(sizeof(clppIndex));
+
+	//---- The inclusive segmented scan, and the scan of the head flags
+	_segmentedScan = new clppSegmentedScan(context, op, maxElements, true);
+	_scan = clpp::createBestScan(context, clppOperator(clppDataType_Index), maxElements);
+}
+
+clppSegmentedReduce::~clppSegmentedReduce()
+{
+	if (_is_clBuffersOwner && _clBuffer_dataSet)
+		_context->getBufferPool()->release(_clBuffer_dataSet);
+
+	if (_clBuffer_scanned)
+		_context->getBufferPool()->release(_clBuffer_scanned);
+
+	if (_clBuffer_indices)
+		_context->getBufferPool()->release(_clBuffer_indices);
+
+	if (_clBuffer_ownOffsets)
+		_context->getBufferPool()->release(_clBuffer_ownOffsets);
+
+	if (_clBuffer_output)
+		_context->getBufferPool()->release(_clBuffer_output);
+
+	if (_clBuffer_count)
+		_context->getBufferPool()->release(_clBuffer_count);
+
+	delete _segmentedScan;
+	delete _scan;
+}
+
+#pragma endregion
+
+#pragma region compilePreprocess
+
+string clppSegmentedReduce::compilePreprocess(string kernel)
+{
+	ostringstream source;
+
+	source << _operator.getDefines();
+	source << "#define WORKGROUP_SIZE " << _workgroupSize << endl;
+
+	return clppProgram::compilePreprocess(source.str() + kernel);
+}
+
+#pragma endregion
+
+#pragma region reduce
+
+void clppSegmentedReduce::reduce()
+{
+	cl_int clStatus;
+
+	clppIndex N = _datasetSize;
+
+	size_t local[1] = {_workgroupSize};
+	size_t global[1] = {toMultipleOf(max(N, (clppIndex)1), _workgroupSize)};
+
+	//---- 1) The inclusive segmented scan, on a copy of the data set
+	if (N > 0)
+	{
+		clStatus = _context->getProfiler()->enqueueCopyBuffer(_clBuffer_dataSet, _clBuffer_scanned, 0, 0, _operator.getValueSize() * N, 0, NULL, NULL);
+		checkCLStatus(clStatus);
+	}
+
+	_segmentedScan->pushCLDatas(_clBuffer_scanned, N);
+	if (_clBuffer_heads)
+		_segmentedScan->pushCLHeads(_clBuffer_heads);
+	else
+		_segmentedScan->pushCLOffsets(_clBuffer_offsets, _segments);
+	_segmentedScan->scan();
+
+	//---- 2) The offsets and the number of the segments
+	cl_mem offsets = _clBuffer_offsets;
+	if (_clBuffer_heads && N > 0)
+	{
+		offsets = _clBuffer_ownOffsets;
+
+		clStatus  = clSetKernelArg(_kernel_HeadFlags, 0, sizeof(cl_mem), (const void*)&_clBuffer_heads);
+		clStatus |= clSetKernelArg(_kernel_HeadFlags, 1, sizeof(cl_mem), (const void*)&_clBuffer_indices);
+		clStatus |= clSetKernelArg(_kernel_HeadFlags, 2, sizeof(clppIndex), (const void*)&N);
+		clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_HeadFlags, 1, NULL, global, local, 0, NULL, NULL);
+		checkCLStatus(clStatus);
+
+		_scan->pushCLDatas(_clBuffer_indices, N);
+		_scan->scan();
+
+		clStatus  = clSetKernelArg(_kernel_HeadOffsets, 0, sizeof(cl_mem), (const void*)&_clBuffer_heads);
+		clStatus |= clSetKernelArg(_kernel_HeadOffsets, 1, sizeof(cl_mem), (const void*)&_clBuffer_indices);
+		clStatus |= clSetKernelArg(_kernel_HeadOffsets, 2, sizeof(cl_mem), (const void*)&offsets);
+		clStatus |= clSetKernelArg(_kernel_HeadOffsets, 3, sizeof(cl_mem), (const void*)&_clBuffer_count);
+		clStatus |= clSetKernelArg(_kernel_HeadOffsets, 4, sizeof(clppIndex), (const void*)&N);
+		clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_HeadOffsets, 1, NULL, global, local, 0, NULL, NULL);
+		checkCLStatus(clStatus);
+	}
+	else
+	{
+		if (_clBuffer_heads)
+			_segments = 0;
+
+		clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_count, CL_FALSE, 0, sizeof(clppIndex), &_segments, 0, NULL, NULL);
+		checkCLStatus(clStatus);
+	}
+
+	//---- 3) The result of each segment (the number of segments is read on the device)
+	size_t globalSegments[1] = {toMultipleOf(max(N, _segments), _workgroupSize)};
+	if (globalSegments[0] == 0)
+		return;
+
+	clStatus  = clSetKernelArg(_kernel_Gather, 0, sizeof(cl_mem), (const void*)&_clBuffer_scanned);
+	clStatus |= clSetKernelArg(_kernel_Gather, 1, sizeof(cl_mem), (const void*)&offsets);
+	clStatus |= clSetKernelArg(_kernel_Gather, 2, sizeof(cl_mem), (const void*)&_clBuffer_count);
+	clStatus |= clSetKernelArg(_kernel_Gather, 3, sizeof(cl_mem), (const void*)&_clBuffer_output);
+	clStatus |= clSetKernelArg(_kernel_Gather, 4, sizeof(clppIndex), (const void*)&N);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Gather, 1, NULL, globalSegments, local, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
+
+#pragma region pushDatas
+
+void clppSegmentedReduce::pushDatas(void* dataSet, size_t datasetSize)
+{
+	cl_int clStatus;
+
+	//---- Store some values
+	_dataSet = dataSet;
+	_datasetSize = datasetSize;
+
+	//---- Copy on the device, through a pinned buffer of the buffer pool
+	if (!_is_clBuffersOwner)
+		_clBuffer_dataSet = 0;
+
+	_clBuffer_dataSet = _context->getBufferPool()->resizePinned(_clBuffer_dataSet, _operator.getValueSize() * _datasetSize);
+	_is_clBuffersOwner = true;
+
+	clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_dataSet, CL_FALSE, 0, _operator.getValueSize() * _datasetSize, _dataSet, 0, 0, 0);
+	checkCLStatus(clStatus);
+}
+
+void clppSegmentedReduce::pushCLDatas(cl_mem clBuffer_dataSet, size_t datasetSize)
+{
+	if (_is_clBuffersOwner && _clBuffer_dataSet)
+		_context->getBufferPool()->release(_clBuffer_dataSet);
+
+	_is_clBuffersOwner = false;
+
+	_dataSet = 0;
+	_clBuffer_dataSet = clBuffer_dataSet;
+	_datasetSize = datasetSize;
+}
+
+void clppSegmentedReduce::pushCLHeads(cl_mem clBuffer_heads)
+{
+	_clBuffer_heads = clBuffer_heads;
+	_clBuffer_offsets = 0;
+	_segments = 0;
+}
+
+void clppSegmentedReduce::pushCLOffsets(cl_mem clBuffer_offsets, size_t segments)
+{
+	_clBuffer_heads = 0;
+	_clBuffer_offsets = clBuffer_offsets;
+	_segments = segments;
+}
+
+#pragma endregion
+
+#pragma region popDatas
+
+clppIndex clppSegmentedReduce::popCount()
+{
+	clppIndex count = 0;
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_count, CL_TRUE, 0, sizeof(clppIndex), &count, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+
+	return count;
+}
+
+void clppSegmentedReduce::popDatas(void* results)
+{
+	clppIndex count = popCount();
+	if (count == 0)
+		return;
+
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_output, CL_TRUE, 0, _operator.getValueSize() * count, results, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,216 @@
+//------------------------------------------------------------
+// Purpose :
+// ---------
+// Segmented scan and segmented reduction : a scan (or a reduction) restarted at the head of each segment.
+// The segments are given by head flags (one byte per element, ex : markNextEventByLP) or by offsets.
+//
+// Algorithm :
+// -----------
+// Each element is a (flag, value) pair, and the operator propagates the flags :
+//
+// (fa, a) + (fb, b) = (fa | fb, fb ? b : a + b)
+//
+// This operator is associative, so the usual scan algorithms work unchanged (reduce then scan) :
+// 1) Each work-group reduces its tile to a (flag, value) pair.
+// 2) A single work-group scans the pairs of the tiles : the carry of each tile.
+// 3) Each work-group scans its tile, and applies the carry to the elements before its first head.
+//
+// The host defines :
+// T, OPERATOR_APPLY(A,B), OPERATOR_IDENTITY	The data type and the operator (clppOperator)
+// WORKGROUP_SIZE								The size of a work-group, and of a tile
+// INDEX_T										The index type of the data set (clppIndex)
+//
+// References :
+// ------------
+// Scan Primitives for GPU Computing. Shubhabrata Sengupta, Mark Harris, Yao Zhang, John D. Owens.
+//------------------------------------------------------------
+
+#pragma OPENCL EXTENSION cl_amd_printf : enable
+
+//------------------------------------------------------------
+// scan_workgroup_segmented
+//
+// Purpose : Inclusive scan of the (flag, value) pairs of a work-group, in local memory.
+//------------------------------------------------------------
+
+inline void scan_workgroup_segmented(__local T* values, __local uint* flags, const uint lid)
+{
+	for(uint offset = 1; offset < WORKGROUP_SIZE; offset <<= 1)
+	{
+		T left = OPERATOR_IDENTITY;
+		uint leftFlag = 0;
+		if (lid >= offset)
+		{
+			left = values[lid - offset];
+			leftFlag = flags[lid - offset];
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+
+		if (lid >= offset)
+		{
+			if (!flags[lid])
+				values[lid] = OPERATOR_APPLY(left, values[lid]);
+			flags[lid] |= leftFlag;
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+}
+
+//------------------------------------------------------------
+// kernel__segScanReduceTiles
+//
+// Purpose : 1) Reduce each tile to a (flag, value) pair.
+//------------------------------------------------------------
+
+__kernel
+void kernel__segScanReduceTiles(
+	__global const T* data,
+	__global const uchar* heads,
+	__global T* tileValues,
+	__global uint* tileFlags,
+	const INDEX_T N)
+{
+	const uint lid = get_local_id(0);
+	const INDEX_T gid = get_global_id(0);
+
+	__local T values[WORKGROUP_SIZE];
+	__local uint flags[WORKGROUP_SIZE];
+
+	values[lid] = (gid < N) ? data[gid] : OPERATOR_IDENTITY;
+	flags[lid] = (gid < N) ? (gid == 0 || heads[gid] != 0) : 0;
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	scan_workgroup_segmented(values, flags, lid);
+
+	if (lid == WORKGROUP_SIZE - 1)
+	{
+		tileValues[get_group_id(0)] = values[lid];
+		tileFlags[get_group_id(0)] = flags[lid];
+	}
+}
+
+//------------------------------------------------------------
+// kernel__segScanCarries
+//
+// Purpose : 2) Replace the pair of each tile by its carry (exclusive scan of the pairs, in place).
+// A single work-group walks all the tiles.
+//------------------------------------------------------------
+
+__kernel
+void kernel__segScanCarries(
+	__global T* tileValues,
+	__global const uint* tileFlags,
+	const INDEX_T tiles)
+{
+	const uint lid = get_local_id(0);
+
+	__local T values[WORKGROUP_SIZE];
+	__local uint flags[WORKGROUP_SIZE];
+
+	T carry = OPERATOR_IDENTITY;
+
+	for(INDEX_T base = 0; base < tiles; base += WORKGROUP_SIZE)
+	{
+		const INDEX_T i = base + lid;
+
+		values[lid] = (i < tiles) ? tileValues[i] : OPERATOR_IDENTITY;
+		flags[lid] = (i < tiles) ? tileFlags[i] : 0;
+		barrier(CLK_LOCAL_MEM_FENCE);
+
+		scan_workgroup_segmented(values, flags, lid);
+
+		// The carry of the tile 'i' is the inclusive result of the tile 'i - 1'
+		T carryIn = carry;
+		if (lid > 0)
+			carryIn = flags[lid - 1] ? values[lid - 1] : OPERATOR_APPLY(carry, values[lid - 1]);
+
+		T last = values[WORKGROUP_SIZE - 1];
+		uint lastFlag = flags[WORKGROUP_SIZE - 1];
+		barrier(CLK_LOCAL_MEM_FENCE);
+
+		if (i < tiles)
+			tileValues[i] = carryIn;
+
+		carry = lastFlag ? last : OPERATOR_APPLY(carry, last);
+	}
+}
+
+//------------------------------------------------------------
+// kernel__segScanTiles
+//
+// Purpose : 3) Scan each tile with its carry (in place).
+//------------------------------------------------------------
+
+__kernel
+void kernel__segScanTiles(
+	__global T* data,
+	__global const uchar* heads,
+	__global const T* tileCarries,
+	const INDEX_T N,
+	const uint inclusive)
+{
+	const uint lid = get_local_id(0);
+	const INDEX_T gid = get_global_id(0);
+
+	__local T values[WORKGROUP_SIZE];
+	__local uint flags[WORKGROUP_SIZE];
+
+	const uint head = (gid < N) ? (gid == 0 || heads[gid] != 0) : 0;
+	values[lid] = (gid < N) ? data[gid] : OPERATOR_IDENTITY;
+	flags[lid] = head;
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	scan_workgroup_segmented(values, flags, lid);
+
+	if (gid >= N)
+		return;
+
+	const T carry = tileCarries[get_group_id(0)];
+
+	if (inclusive)
+	{
+		data[gid] = flags[lid] ? values[lid] : OPERATOR_APPLY(carry, values[lid]);
+	}
+	else if (head)
+	{
+		data[gid] = OPERATOR_IDENTITY;
+	}
+	else
+	{
+		data[gid] = (lid == 0) ? carry : (flags[lid - 1] ? values[lid - 1] : OPERATOR_APPLY(carry, values[lid - 1]));
+	}
+}
+
+//------------------------------------------------------------
+// kernel__segClearHeads, kernel__segSetHeads
+//
+// Purpose : Build the head flags from the offsets of the segments.
+//------------------------------------------------------------
+
+__kernel
+void kernel__segClearHeads(
+	__global uchar* heads,
+	const INDEX_T N)
+{
+	const INDEX_T gid = get_global_id(0);
+	if (gid >= N)
+		return;
+
+	heads[gid] = 0;
+}
+
+__kernel
+void kernel__segSetHeads(
+	__global const INDEX_T* offsets,
+	__global uchar* heads,
+	const INDEX_T segments,
+	const INDEX_T N)
+{
+	const INDEX_T gid = get_global_id(0);
+	if (gid >= segments)
+		return;
+
+	const INDEX_T offset = offsets[gid];
+	if (offset < N)
+		heads[offset] = 1;
+}
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "clpp/clppSegmentedScan.h"
+#include "clpp/clppSegmentedScan_CLKernel.h"
+#include "clpp/clppBufferPool.h"
+#include "clpp/clppProfiler.h"
+
+#include <algorithm>
+
+#pragma region Constructor
+
+clppSegmentedScan::clppSegmentedScan(clppContext* context, const clppOperator& op, clppIndex maxElements, bool inclusive) :
+	clppScan(context, op, maxElements)
+{
+	_inclusive = inclusive;
+	_clBuffer_heads = 0;
+	_clBuffer_offsets = 0;
+	_segments = 0;
+	_clBuffer_ownHeads = 0;
+	_clBuffer_tileValues = 0;
+	_clBuffer_tileFlags = 0;
+	_workgroupSize = 128;
+
+	//---- Compilation (specialized for the data type and the operator)
+	if (!compile(_context, clCode_clppSegmentedScan))
+		return;
+
+	//---- Prepare all the kernels
+	_kernel_ReduceTiles = getKernel("kernel__segScanReduceTiles");
+
+	_kernel_Carries = getKernel("kernel__segScanCarries");
+
+	_kernel_ScanTiles = getKernel("kernel__segScanTiles");
+
+	_kernel_ClearHeads = getKernel("kernel__segClearHeads");
+
+	_kernel_SetHeads = getKernel("kernel__segSetHeads");
+
+	//---- Prepare all the buffers
+	size_t tiles = toMultipleOf(maxElements, _workgroupSize) / _workgroupSize;
+	if (tiles == 0)
+		tiles = 1;
+
+	_clBuffer_ownHeads = _context->getBufferPool()->acquire(sizeof(cl_uchar) * max(maxElements, (clppIndex)1));
+
+	_clBuffer_tileValues = _context->getBufferPool()->acquire(_valueSize * tiles);
+
+	_clBuffer_tileFlags = _context->getBufferPool()->acquire(sizeof(cl_uint) * tiles);
+}
+
+clppSegmentedScan::~clppSegmentedScan()
+{
+	if (_is_clBuffersOwner && _clBuffer_values)
+		_context->getBufferPool()->release(_clBuffer_values);
+
+	if (_clBuffer_ownHeads)
+		_context->getBufferPool()->release(_clBuffer_ownHeads);
+
+	if (_clBuffer_tileValues)
+		_context->getBufferPool()->release(_clBuffer_tileValues);
+
+	if (_clBuffer_tileFlags)
+		_context->getBufferPool()->release(_clBuffer_tileFlags);
+}
+
+#pragma endregion
+
+#pragma region compilePreprocess
+
+string clppSegmentedScan::compilePreprocess(string kernel)
+{
+	ostringstream source;
+	source << "#define WORKGROUP_SIZE " << _workgroupSize << endl;
+
+	return clppScan::compilePreprocess(source.str() + kernel);
+}
+
+#pragma endregion
+
+#pragma region scan
+
+void clppSegmentedScan::scan()
+{
+	cl_int clStatus;
+
+	clppIndex N = _datasetSize;
+	if (N == 0)
+		return;
+
+	size_t local[1] = {_workgroupSize};
+	size_t global[1] = {toMultipleOf(N, _workgroupSize)};
+	clppIndex tiles = global[0] / _workgroupSize;
+
+	//---- 0) The head flags of the offsets (no offsets : a single segment)
+	cl_mem heads = _clBuffer_heads;
+	if (!heads)
+	{
+		heads = _clBuffer_ownHeads;
+		clppIndex S = _segments;
+
+		clStatus  = clSetKernelArg(_kernel_ClearHeads, 0, sizeof(cl_mem), (const void*)&heads);
+		clStatus |= clSetKernelArg(_kernel_ClearHeads, 1, sizeof(clppIndex), (const void*)&N);
+		clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_ClearHeads, 1, NULL, global, local, 0, NULL, NULL);
+		checkCLStatus(clStatus);
+
+		if (_clBuffer_offsets && S > 0)
+		{
+			size_t globalSegments[1] = {toMultipleOf(S, _workgroupSize)};
+
+			clStatus  = clSetKernelArg(_kernel_SetHeads, 0, sizeof(cl_mem), (const void*)&_clBuffer_offsets);
+			clStatus |= clSetKernelArg(_kernel_SetHeads, 1, sizeof(cl_mem), (const void*)&heads);
+			clStatus |= clSetKernelArg(_kernel_SetHeads, 2, sizeof(clppIndex), (const void*)&S);
+			clStatus |= clSetKernelArg(_kernel_SetHeads, 3, sizeof(clppIndex), (const void*)&N);
+			clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_SetHeads, 1, NULL, globalSegments, local, 0, NULL, NULL);
+			checkCLStatus(clStatus);
+		}
+	}
+
+	//---- 1) Reduce each tile
+	clStatus  = clSetKernelArg(_kernel_ReduceTiles, 0, sizeof(cl_mem), (const void*)&_clBuffer_values);
+	clStatus |= clSetKernelArg(_kernel_ReduceTiles, 1, sizeof(cl_mem), (const void*)&heads);
+	clStatus |= clSetKernelArg(_kernel_ReduceTiles, 2, sizeof(cl_mem), (const void*)&_clBuffer_tileValues);
+	clStatus |= clSetKernelArg(_kernel_ReduceTiles, 3, sizeof(cl_mem), (const void*)&_clBuffer_tileFlags);
+	clStatus |= clSetKernelArg(_kernel_ReduceTiles, 4, sizeof(clppIndex), (const void*)&N);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_ReduceTiles, 1, NULL, global, local, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+
+	//---- 2) The carry of each tile (a single work-group)
+	clStatus  = clSetKernelArg(_kernel_Carries, 0, sizeof(cl_mem), (const void*)&_clBuffer_tileValues);
+	clStatus |= clSetKernelArg(_kernel_Carries, 1, sizeof(cl_mem), (const void*)&_clBuffer_tileFlags);
+	clStatus |= clSetKernelArg(_kernel_Carries, 2, sizeof(clppIndex), (const void*)&tiles);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Carries, 1, NULL, local, local, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+
+	//---- 3) Scan each tile with its carry
+	unsigned int inclusive = _inclusive ? 1 : 0;
+
+	clStatus  = clSetKernelArg(_kernel_ScanTiles, 0, sizeof(cl_mem), (const void*)&_clBuffer_values);
+	clStatus |= clSetKernelArg(_kernel_ScanTiles, 1, sizeof(cl_mem), (const void*)&heads);
+	clStatus |= clSetKernelArg(_kernel_ScanTiles, 2, sizeof(cl_mem), (const void*)&_clBuffer_tileValues);
+	clStatus |= clSetKernelArg(_kernel_ScanTiles, 3, sizeof(clppIndex), (const void*)&N);
+	clStatus |= clSetKernelArg(_kernel_ScanTiles, 4, sizeof(unsigned int), (const void*)&inclusive);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_ScanTiles, 1, NULL, global, local, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
+
+#pragma region pushDatas
+
+void clppSegmentedScan::pushDatas(void* values, size_t datasetSize)
+{
+	cl_int clStatus;
+
+	//---- Store some values
+	_values = values;
+	_datasetSize = datasetSize;
+
+	//---- Copy on the device, through a pinned buffer of the buffer pool
+	if (!_is_clBuffersOwner)
+		_clBuffer_values = 0;
+
+	_clBuffer_values = _context->getBufferPool()->resizePinned(_clBuffer_values, _valueSize * _datasetSize);
+	_is_clBuffersOwner = true;
+
+	clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_values, CL_FALSE, 0, _valueSize * _datasetSize, _values, 0, 0, 0);
+	checkCLStatus(clStatus);
+}
+
+void clppSegmentedScan::pushCLDatas(cl_mem clBuffer_values, size_t datasetSize)
+{
+	_values = 0;
+
+	//---- Give back the buffer of 'pushDatas'
+	if (_is_clBuffersOwner && _clBuffer_values)
+		_context->getBufferPool()->release(_clBuffer_values);
+
+	_is_clBuffersOwner = false;
+
+	_clBuffer_values = clBuffer_values;
+	_datasetSize = datasetSize;
+}
+
+void clppSegmentedScan::pushCLHeads(cl_mem clBuffer_heads)
+{
+	_clBuffer_heads = clBuffer_heads;
+	_clBuffer_offsets = 0;
+	_segments = 0;
+}
+
+void clppSegmentedScan::pushCLOffsets(cl_mem clBuffer_offsets, size_t segments)
+{
+	_clBuffer_heads = 0;
+	_clBuffer_offsets = clBuffer_offsets;
+	_segments = segments;
+}
+
+#pragma endregion
+
+#pragma region popDatas
+
+void clppSegmentedScan::popDatas()
+{
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_values, CL_TRUE, 0, _valueSize * _datasetSize, _values, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+void clppSegmentedScan::popDatas(void* dataSet)
+{
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_values, CL_TRUE, 0, _valueSize * _datasetSize, dataSet, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,161 @@
+//------------------------------------------------------------
+// Purpose :
+// ---------
+// Select the 'k' smallest keys (with their values) of an unsorted data set, without sorting it.
+//
+// Algorithm :
+// -----------
+// Radix select : the keys are examined from the most significant digit to the least significant one,
+// 8 bits at a time.
+//
+// For each digit, we build the histogram of the keys that still share the prefix found so far, and we
+// find the bucket containing the k-th smallest key. Its digit is appended to the prefix and the count
+// of the smaller buckets is removed from 'k'. After the last digit, the prefix is the k-th smallest key.
+//
+// The final pass gathers every key strictly smaller than the k-th key, plus as many keys equal to it
+// as needed to have exactly 'k' elements.
+//
+// Each pass reads the data once, so the whole selection costs (bits/8 + 1) reads of the data set,
+// against 2 * bits/4 reads and writes for a full radix sort.
+//
+// The selection state lives on the device, so there is no synchronization with the host between the passes.
+//
+// state[0] : The prefix of the k-th key
+// state[1] : The mask of the bits already in the prefix
+// state[2] : The rank of the k-th key among the keys sharing the prefix (1 based)
+// state[3] : Counter of the gathered keys smaller than the k-th key
+// state[4] : Counter of the gathered keys equal to the k-th key
+// state[5] : k
+//
+// References :
+// ------------
+// Fast k-selection algorithms for graphics processing units. Tolu Alabi, Jeffrey D. Blanchard, Bradley Gordon, Russel Steinbach.
+//------------------------------------------------------------
+
+#pragma OPENCL EXTENSION cl_amd_printf : enable
+
+#define RADIX 256
+#define RADIX_MASK 0xFF
+
+#ifdef KEYS_ONLY
+#define KEY(DATA) (DATA)
+#else
+#define KEY(DATA) (DATA.x)
+#endif
+
+#define STATE_PREFIX 0
+#define STATE_MASK 1
+#define STATE_RANK 2
+#define STATE_LESS 3
+#define STATE_EQUAL 4
+#define STATE_K 5
+
+//------------------------------------------------------------
+// kernel__selectHistogram
+//
+// Purpose : Histogram of the digit at 'shift' for the keys sharing the current prefix.
+// Each workgroup counts in local memory, then merges its counts into the global histogram.
+//------------------------------------------------------------
+
+__kernel
+void kernel__selectHistogram(
+	__global const KV_TYPE* data,
+	__global uint* histogram,
+	__global const uint* state,
+	const uint shift,
+	const uint N)
+{
+	const uint tid = get_local_id(0);
+	const uint lsz = get_local_size(0);
+
+	__local uint localHistogram[RADIX];
+
+	for(uint i = tid; i < RADIX; i += lsz)
+		localHistogram[i] = 0;
+
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	const uint prefix = state[STATE_PREFIX];
+	const uint mask = state[STATE_MASK];
+
+	for(uint i = get_global_id(0); i < N; i += get_global_size(0))
+	{
+		uint key = KEY(data[i]);
+		if ((key & mask) == prefix)
+			atomic_inc(&localHistogram[(key >> shift) & RADIX_MASK]);
+	}
+
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for(uint i = tid; i < RADIX; i += lsz)
+		if (localHistogram[i] > 0)
+			atomic_add(&histogram[i], localHistogram[i]);
+}
+
+//------------------------------------------------------------
+// kernel__selectDigit
+//
+// Purpose : Find the bucket containing the k-th key, append its digit to the prefix
+// and reset the histogram for the next pass. Run by a single work-item.
+//------------------------------------------------------------
+
+__kernel
+void kernel__selectDigit(
+	__global uint* histogram,
+	__global uint* state,
+	const uint shift)
+{
+	uint rank = state[STATE_RANK];
+
+	uint digit = 0;
+	for(; digit < RADIX_MASK; digit++)
+	{
+		uint count = histogram[digit];
+		if (rank <= count)
+			break;
+		rank -= count;
+	}
+
+	state[STATE_PREFIX] |= digit << shift;
+	state[STATE_MASK] |= RADIX_MASK << shift;
+	state[STATE_RANK] = rank;
+
+	for(uint i = 0; i < RADIX; i++)
+		histogram[i] = 0;
+}
+
+//------------------------------------------------------------
+// kernel__selectGather
+//
+// Purpose : Write the keys smaller than the k-th key, and enough keys equal to it, in 'dataOut'.
+// The smaller keys go in [0, k-rank) and the equal keys in [k-rank, k).
+//------------------------------------------------------------
+
+__kernel
+void kernel__selectGather(
+	__global const KV_TYPE* data,
+	__global KV_TYPE* dataOut,
+	__global uint* state,
+	const uint N)
+{
+	const uint kth = state[STATE_PREFIX];
+	const uint rank = state[STATE_RANK];
+	const uint equalOffset = state[STATE_K] - rank;
+
+	for(uint i = get_global_id(0); i < N; i += get_global_size(0))
+	{
+		KV_TYPE value = data[i];
+		uint key = KEY(value);
+
+		if (key < kth)
+		{
+			dataOut[atomic_inc(&state[STATE_LESS])] = value;
+		}
+		else if (key == kth)
+		{
+			uint index = atomic_inc(&state[STATE_EQUAL]);
+			if (index < rank)
+				dataOut[equalOffset + index] = value;
+		}
+	}
+}
\ No newline at end of file
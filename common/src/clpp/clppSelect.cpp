@@ -0,0 +1,196 @@
+#include "clpp/clppSelect.h"
+#include "clpp/clppSelect_CLKernel.h"
+#include "clpp/clppBufferPool.h"
+#include "clpp/clppProfiler.h"
+
+#include <string.h>
+#include <algorithm>
+
+#pragma region Constructor
+
+clppSelect::clppSelect(clppContext* context, unsigned int maxElements, unsigned int bits, bool keysOnly)
+{
+	_keysOnly = keysOnly;
+	_bits = bits;
+	_k = 0;
+	_dataSet = 0;
+	_datasetSize = 0;
+	_clBuffer_dataSet = 0;
+	_clBuffer_dataSetOut = 0;
+	_dataSetOutSize = 0;
+	_is_clBuffersOwner = false;
+	_clBuffer_histogram = 0;
+	_clBuffer_state = 0;
+
+	if (!compile(context, clCode_clppSelect))
+		return;
+
+	//---- Prepare all the kernels
+	_kernel_Histogram = getKernel("kernel__selectHistogram");
+
+	_kernel_Digit = getKernel("kernel__selectDigit");
+
+	_kernel_Gather = getKernel("kernel__selectGather");
+
+	//---- Get the workgroup size
+	clGetKernelWorkGroupInfo(_kernel_Histogram, _context->clDevice, CL_KERNEL_WORK_GROUP_SIZE, sizeof(size_t), &_workgroupSize, 0);
+	_workgroupSize = min(_workgroupSize, (size_t)256);
+
+	//---- Prepare all the buffers
+	_clBuffer_histogram = _context->getBufferPool()->acquire(sizeof(cl_uint) * 256);
+
+	_clBuffer_state = _context->getBufferPool()->acquire(sizeof(cl_uint) * 6);
+
+	memset(_initialState, 0, sizeof(_initialState));
+}
+
+clppSelect::~clppSelect()
+{
+	if (_is_clBuffersOwner && _clBuffer_dataSet)
+		_context->getBufferPool()->release(_clBuffer_dataSet);
+
+	if (_clBuffer_dataSetOut)
+		_context->getBufferPool()->release(_clBuffer_dataSetOut);
+
+	if (_clBuffer_histogram)
+		_context->getBufferPool()->release(_clBuffer_histogram);
+
+	if (_clBuffer_state)
+		_context->getBufferPool()->release(_clBuffer_state);
+}
+
+#pragma endregion
+
+#pragma region compilePreprocess
+
+string clppSelect::compilePreprocess(string kernel)
+{
+	string source = _keysOnly ? "#define KV_TYPE uint\n" : "#define KV_TYPE uint2\n";
+
+	if (_keysOnly)
+		source += "#define KEYS_ONLY 1\n";
+
+	return clppProgram::compilePreprocess(source + kernel);
+}
+
+#pragma endregion
+
+#pragma region select
+
+void clppSelect::select(unsigned int k)
+{
+	cl_int clStatus;
+
+	_k = (unsigned int)min((size_t)k, _datasetSize);
+	if (_k == 0)
+		return;
+
+	//---- The output buffer grows with 'k'
+	if (_k > _dataSetOutSize)
+	{
+		if (_clBuffer_dataSetOut)
+			_context->getBufferPool()->release(_clBuffer_dataSetOut);
+
+		_clBuffer_dataSetOut = _context->getBufferPool()->acquire(getElementSize() * _k);
+		_dataSetOutSize = _k;
+	}
+
+	//---- Reset the state : empty prefix, rank = k
+	_initialState[2] = _k;
+	_initialState[5] = _k;
+	clStatus  = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_state, CL_FALSE, 0, sizeof(cl_uint) * 6, _initialState, 0, NULL, NULL);
+	clStatus |= _context->getProfiler()->enqueueWriteBuffer(_clBuffer_histogram, CL_FALSE, 0, sizeof(cl_uint) * 256, _initialState + 6, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+
+	// Each work-item handles several elements, a few work-groups per compute unit are enough.
+	unsigned int N = _datasetSize;
+	size_t local[1] = {_workgroupSize};
+	size_t global[1] = {toMultipleOf((N + 7) / 8, _workgroupSize)};
+	size_t single[1] = {1};
+
+	//---- 1) One histogram per 8-bit digit, from the most significant one
+	int firstShift = ((_bits + 7) / 8 - 1) * 8;
+	for(int shift = firstShift; shift >= 0; shift -= 8)
+	{
+		unsigned int ushift = shift;
+
+		clStatus  = clSetKernelArg(_kernel_Histogram, 0, sizeof(cl_mem), (const void*)&_clBuffer_dataSet);
+		clStatus |= clSetKernelArg(_kernel_Histogram, 1, sizeof(cl_mem), (const void*)&_clBuffer_histogram);
+		clStatus |= clSetKernelArg(_kernel_Histogram, 2, sizeof(cl_mem), (const void*)&_clBuffer_state);
+		clStatus |= clSetKernelArg(_kernel_Histogram, 3, sizeof(unsigned int), (const void*)&ushift);
+		clStatus |= clSetKernelArg(_kernel_Histogram, 4, sizeof(unsigned int), (const void*)&N);
+		clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Histogram, 1, NULL, global, local, 0, NULL, NULL);
+		checkCLStatus(clStatus);
+
+		clStatus  = clSetKernelArg(_kernel_Digit, 0, sizeof(cl_mem), (const void*)&_clBuffer_histogram);
+		clStatus |= clSetKernelArg(_kernel_Digit, 1, sizeof(cl_mem), (const void*)&_clBuffer_state);
+		clStatus |= clSetKernelArg(_kernel_Digit, 2, sizeof(unsigned int), (const void*)&ushift);
+		clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Digit, 1, NULL, single, single, 0, NULL, NULL);
+		checkCLStatus(clStatus);
+	}
+
+	//---- 2) Gather the 'k' smallest elements
+	clStatus  = clSetKernelArg(_kernel_Gather, 0, sizeof(cl_mem), (const void*)&_clBuffer_dataSet);
+	clStatus |= clSetKernelArg(_kernel_Gather, 1, sizeof(cl_mem), (const void*)&_clBuffer_dataSetOut);
+	clStatus |= clSetKernelArg(_kernel_Gather, 2, sizeof(cl_mem), (const void*)&_clBuffer_state);
+	clStatus |= clSetKernelArg(_kernel_Gather, 3, sizeof(unsigned int), (const void*)&N);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Gather, 1, NULL, global, local, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+unsigned int clppSelect::getKthKey()
+{
+	// The prefix is the complete k-th key once all the digits are found
+	cl_uint kth = 0;
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_state, CL_TRUE, 0, sizeof(cl_uint), &kth, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+
+	return kth;
+}
+
+#pragma endregion
+
+#pragma region pushDatas
+
+void clppSelect::pushDatas(void* dataSet, size_t datasetSize)
+{
+	cl_int clStatus;
+
+	//---- Store some values
+	_dataSet = dataSet;
+	_datasetSize = datasetSize;
+
+	//---- Copy on the device, through a pinned buffer of the buffer pool
+	if (!_is_clBuffersOwner)
+		_clBuffer_dataSet = 0;
+
+	_clBuffer_dataSet = _context->getBufferPool()->resizePinned(_clBuffer_dataSet, getElementSize() * _datasetSize);
+	_is_clBuffersOwner = true;
+
+	clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_dataSet, CL_FALSE, 0, getElementSize() * _datasetSize, _dataSet, 0, 0, 0);
+	checkCLStatus(clStatus);
+}
+
+void clppSelect::pushCLDatas(cl_mem clBuffer_dataSet, size_t datasetSize)
+{
+	if (_is_clBuffersOwner && _clBuffer_dataSet)
+		_context->getBufferPool()->release(_clBuffer_dataSet);
+
+	_is_clBuffersOwner = false;
+
+	_dataSet = 0;
+	_clBuffer_dataSet = clBuffer_dataSet;
+	_datasetSize = datasetSize;
+}
+
+#pragma endregion
+
+#pragma region popDatas
+
+void clppSelect::popDatas(void* dataSet)
+{
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_dataSetOut, CL_TRUE, 0, getElementSize() * _k, dataSet, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
\ No newline at end of file
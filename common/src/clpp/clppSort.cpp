@@ -1,4 +1,5 @@
 #include "clpp/clppSort.h"
+#include "clpp/clppBufferPool.h"
 
 void clppSort::pushDatas(void* dataSet, size_t datasetSize)
 {
@@ -6,9 +7,7 @@ void clppSort::pushDatas(void* dataSet, size_t datasetSize)
 	_dataSet = dataSet;
 	_datasetSize = datasetSize;
 
-	cl_int clStatus;
-	_clBuffer_dataSet = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, _keySize * datasetSize, NULL, &clStatus);
-	checkCLStatus(clStatus);
+	_clBuffer_dataSet = _context->getBufferPool()->acquire(_keySize * datasetSize);
 
 	pushCLDatas(_clBuffer_dataSet, datasetSize);
 }
\ No newline at end of file
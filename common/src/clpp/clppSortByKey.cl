@@ -0,0 +1,127 @@
+//------------------------------------------------------------
+// Purpose :
+// ---------
+// Sort a set of keys and output the permutation, then reorder any number of payload arrays
+// (structure of arrays) with this permutation.
+//
+// Algorithm :
+// -----------
+// Each key is packed with its index in a uint2 (key, index), and the pairs are sorted with a
+// key-value sort. The radix passes only move 8 bytes per element, whatever the size of the payload.
+// The sorted pairs are then split into the sorted keys and the permutation :
+//
+// permutation[i] = index, in the unsorted data set, of the i-th sorted element
+//
+// Each payload array is then reordered in a single gather pass : dst[i] = src[permutation[i]]
+//------------------------------------------------------------
+
+#pragma OPENCL EXTENSION cl_amd_printf : enable
+
+//------------------------------------------------------------
+// kernel__sortByKeyInit
+//
+// Purpose : Pack each key with its index.
+//------------------------------------------------------------
+
+__kernel
+void kernel__sortByKeyInit(
+	__global const uint* keys,
+	__global uint2* pairs,
+	const uint N)
+{
+	const uint gid = get_global_id(0);
+	if (gid >= N)
+		return;
+
+	pairs[gid] = (uint2)(keys[gid], gid);
+}
+
+//------------------------------------------------------------
+// kernel__sortByKeySplit
+//
+// Purpose : Split the sorted pairs into the sorted keys and the permutation.
+//------------------------------------------------------------
+
+__kernel
+void kernel__sortByKeySplit(
+	__global const uint2* pairs,
+	__global uint* keys,
+	__global uint* permutation,
+	const uint N)
+{
+	const uint gid = get_global_id(0);
+	if (gid >= N)
+		return;
+
+	uint2 pair = pairs[gid];
+	keys[gid] = pair.x;
+	permutation[gid] = pair.y;
+}
+
+//------------------------------------------------------------
+// kernel__gather
+//
+// Purpose : Reorder a payload array with the permutation, one kernel per element size.
+// The generic version moves 'words' 32 bits words per element.
+//------------------------------------------------------------
+
+__kernel
+void kernel__gather1(
+	__global const uint* src,
+	__global uint* dst,
+	__global const uint* permutation,
+	const uint N)
+{
+	const uint gid = get_global_id(0);
+	if (gid >= N)
+		return;
+
+	dst[gid] = src[permutation[gid]];
+}
+
+__kernel
+void kernel__gather2(
+	__global const uint2* src,
+	__global uint2* dst,
+	__global const uint* permutation,
+	const uint N)
+{
+	const uint gid = get_global_id(0);
+	if (gid >= N)
+		return;
+
+	dst[gid] = src[permutation[gid]];
+}
+
+__kernel
+void kernel__gather4(
+	__global const uint4* src,
+	__global uint4* dst,
+	__global const uint* permutation,
+	const uint N)
+{
+	const uint gid = get_global_id(0);
+	if (gid >= N)
+		return;
+
+	dst[gid] = src[permutation[gid]];
+}
+
+__kernel
+void kernel__gatherWords(
+	__global const uint* src,
+	__global uint* dst,
+	__global const uint* permutation,
+	const uint N,
+	const uint words)
+{
+	const uint gid = get_global_id(0);
+	if (gid >= N)
+		return;
+
+	__global const uint* from = src + permutation[gid] * words;
+	__global uint* to = dst + gid * words;
+
+	for(uint i = 0; i < words; i++)
+		to[i] = from[i];
+}
\ No newline at end of file
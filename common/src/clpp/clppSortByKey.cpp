@@ -0,0 +1,192 @@
+#include "clpp/clppSortByKey.h"
+#include "clpp/clppSortByKey_CLKernel.h"
+#include "clpp/clpp.h"
+#include "clpp/clppBufferPool.h"
+#include "clpp/clppProfiler.h"
+
+#pragma region Constructor
+
+clppSortByKey::clppSortByKey(clppContext* context, unsigned int maxElements, unsigned int bits)
+{
+	_dataSet = 0;
+	_datasetSize = 0;
+	_clBuffer_keys = 0;
+	_is_clBuffersOwner = false;
+	_clBuffer_pairs = 0;
+	_clBuffer_pairsScratch = 0;
+	_clBuffer_permutation = 0;
+	_workgroupSize = 128;
+	_sort = 0;
+
+	if (!compile(context, clCode_clppSortByKey))
+		return;
+
+	//---- Prepare all the kernels
+	_kernel_Init = getKernel("kernel__sortByKeyInit");
+
+	_kernel_Split = getKernel("kernel__sortByKeySplit");
+
+	_kernel_Gather1 = getKernel("kernel__gather1");
+
+	_kernel_Gather2 = getKernel("kernel__gather2");
+
+	_kernel_Gather4 = getKernel("kernel__gather4");
+
+	_kernel_GatherWords = getKernel("kernel__gatherWords");
+
+	//---- Prepare all the buffers
+	_clBuffer_pairs = _context->getBufferPool()->acquire(sizeof(cl_uint2) * maxElements);
+
+	_clBuffer_pairsScratch = _context->getBufferPool()->acquire(sizeof(cl_uint2) * maxElements);
+
+	_clBuffer_permutation = _context->getBufferPool()->acquire(sizeof(cl_uint) * maxElements);
+
+	//---- The sort of the pairs
+	_sort = clpp::createBestSortKV(context, maxElements, bits);
+}
+
+clppSortByKey::~clppSortByKey()
+{
+	if (_is_clBuffersOwner && _clBuffer_keys)
+		_context->getBufferPool()->release(_clBuffer_keys);
+
+	if (_clBuffer_pairs)
+		_context->getBufferPool()->release(_clBuffer_pairs);
+
+	if (_clBuffer_pairsScratch)
+		_context->getBufferPool()->release(_clBuffer_pairsScratch);
+
+	if (_clBuffer_permutation)
+		_context->getBufferPool()->release(_clBuffer_permutation);
+
+	delete _sort;
+}
+
+#pragma endregion
+
+#pragma region sort
+
+void clppSortByKey::sort()
+{
+	cl_int clStatus;
+
+	unsigned int N = _datasetSize;
+	if (N == 0)
+		return;
+
+	size_t local[1] = {_workgroupSize};
+	size_t global[1] = {toMultipleOf(N, _workgroupSize)};
+
+	//---- 1) Pack the keys with their index
+	clStatus  = clSetKernelArg(_kernel_Init, 0, sizeof(cl_mem), (const void*)&_clBuffer_keys);
+	clStatus |= clSetKernelArg(_kernel_Init, 1, sizeof(cl_mem), (const void*)&_clBuffer_pairs);
+	clStatus |= clSetKernelArg(_kernel_Init, 2, sizeof(unsigned int), (const void*)&N);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Init, 1, NULL, global, local, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+
+	//---- 2) Sort the pairs
+	_sort->pushCLDatas(_clBuffer_pairs, _clBuffer_pairsScratch, _datasetSize);
+	_sort->sort();
+	cl_mem sortedPairs = _sort->getCLResultBuffer();
+
+	//---- 3) Split the sorted keys and the permutation
+	clStatus  = clSetKernelArg(_kernel_Split, 0, sizeof(cl_mem), (const void*)&sortedPairs);
+	clStatus |= clSetKernelArg(_kernel_Split, 1, sizeof(cl_mem), (const void*)&_clBuffer_keys);
+	clStatus |= clSetKernelArg(_kernel_Split, 2, sizeof(cl_mem), (const void*)&_clBuffer_permutation);
+	clStatus |= clSetKernelArg(_kernel_Split, 3, sizeof(unsigned int), (const void*)&N);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_Split, 1, NULL, global, local, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
+
+#pragma region gather
+
+void clppSortByKey::gather(cl_mem clBuffer_src, cl_mem clBuffer_dst, size_t elementSize)
+{
+	cl_int clStatus;
+
+	unsigned int N = _datasetSize;
+	if (N == 0)
+		return;
+
+	//---- Use the widest vector type matching the element size
+	cl_kernel kernel;
+	switch (elementSize)
+	{
+	case 4: kernel = _kernel_Gather1; break;
+	case 8: kernel = _kernel_Gather2; break;
+	case 16: kernel = _kernel_Gather4; break;
+	default: kernel = _kernel_GatherWords; break;
+	}
+
+	size_t local[1] = {_workgroupSize};
+	size_t global[1] = {toMultipleOf(N, _workgroupSize)};
+
+	clStatus  = clSetKernelArg(kernel, 0, sizeof(cl_mem), (const void*)&clBuffer_src);
+	clStatus |= clSetKernelArg(kernel, 1, sizeof(cl_mem), (const void*)&clBuffer_dst);
+	clStatus |= clSetKernelArg(kernel, 2, sizeof(cl_mem), (const void*)&_clBuffer_permutation);
+	clStatus |= clSetKernelArg(kernel, 3, sizeof(unsigned int), (const void*)&N);
+
+	if (kernel == _kernel_GatherWords)
+	{
+		unsigned int words = elementSize / sizeof(cl_uint);
+		clStatus |= clSetKernelArg(kernel, 4, sizeof(unsigned int), (const void*)&words);
+	}
+
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(kernel, 1, NULL, global, local, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
+
+#pragma region pushDatas
+
+void clppSortByKey::pushDatas(void* keys, size_t datasetSize)
+{
+	cl_int clStatus;
+
+	//---- Store some values
+	_dataSet = keys;
+	_datasetSize = datasetSize;
+
+	//---- Copy on the device, through a pinned buffer of the buffer pool
+	if (!_is_clBuffersOwner)
+		_clBuffer_keys = 0;
+
+	_clBuffer_keys = _context->getBufferPool()->resizePinned(_clBuffer_keys, sizeof(cl_uint) * _datasetSize);
+	_is_clBuffersOwner = true;
+
+	clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_keys, CL_FALSE, 0, sizeof(cl_uint) * _datasetSize, _dataSet, 0, 0, 0);
+	checkCLStatus(clStatus);
+}
+
+void clppSortByKey::pushCLDatas(cl_mem clBuffer_keys, size_t datasetSize)
+{
+	if (_is_clBuffersOwner && _clBuffer_keys)
+		_context->getBufferPool()->release(_clBuffer_keys);
+
+	_is_clBuffersOwner = false;
+
+	_dataSet = 0;
+	_clBuffer_keys = clBuffer_keys;
+	_datasetSize = datasetSize;
+}
+
+#pragma endregion
+
+#pragma region popDatas
+
+void clppSortByKey::popDatas(void* keys)
+{
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_keys, CL_TRUE, 0, sizeof(cl_uint) * _datasetSize, keys, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+void clppSortByKey::popPermutation(void* permutation)
+{
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_permutation, CL_TRUE, 0, sizeof(cl_uint) * _datasetSize, permutation, 0, NULL, NULL);
+	checkCLStatus(clStatus);
+}
+
+#pragma endregion
\ No newline at end of file
@@ -1,25 +1,271 @@
 #include "clpp/clppSort_CPU.h"
+#include "clpp/clppProfiler.h"
 
 #include <algorithm>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
-#pragma region Construsctor
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
-clppSort_CPU::clppSort_CPU(clppContext* context)
+#define RADIX 256
+#define RADIX_MASK 0xFF
+
+// Below this number of elements per thread, the threads cost more than they save
+#define MIN_ELEMENTS_PER_THREAD 65536
+
+#pragma region clppSortBarrier
+
+// A reusable barrier between the sorting threads
+class clppSortBarrier
+{
+public:
+	clppSortBarrier(unsigned int count) : _count(count), _waiting(0), _generation(0) {}
+
+	void wait()
+	{
+		unique_lock<mutex> lock(_mutex);
+		unsigned int generation = _generation;
+
+		if (++_waiting == _count)
+		{
+			_waiting = 0;
+			_generation++;
+			_condition.notify_all();
+			return;
+		}
+
+		while (generation == _generation)
+			_condition.wait(lock);
+	}
+
+private:
+	mutex _mutex;
+	condition_variable _condition;
+	unsigned int _count;
+	unsigned int _waiting;
+	unsigned int _generation;
+};
+
+#pragma endregion
+
+#pragma region Digits
+
+static inline unsigned int keyOf(unsigned int value) { return value; }
+static inline unsigned int keyOf(const cl_uint2& value) { return value.s[0]; }
+
+//---- Histogram of the digit at 'shift' for data[begin, end)
+static void histogramSlice(const unsigned int* data, size_t begin, size_t end, unsigned int shift, size_t* counts)
 {
+	size_t i = begin;
+
+#ifdef __SSE2__
+	const __m128i mask = _mm_set1_epi32(RADIX_MASK);
+	const __m128i shiftCount = _mm_cvtsi32_si128(shift);
+	unsigned int digits[4];
+
+	for(; i + 4 <= end; i += 4)
+	{
+		__m128i keys = _mm_loadu_si128((const __m128i*)(data + i));
+		_mm_storeu_si128((__m128i*)digits, _mm_and_si128(_mm_srl_epi32(keys, shiftCount), mask));
+
+		counts[digits[0]]++;
+		counts[digits[1]]++;
+		counts[digits[2]]++;
+		counts[digits[3]]++;
+	}
+#endif
+
+	for(; i < end; i++)
+		counts[(data[i] >> shift) & RADIX_MASK]++;
+}
+
+static void histogramSlice(const cl_uint2* data, size_t begin, size_t end, unsigned int shift, size_t* counts)
+{
+	size_t i = begin;
+
+#ifdef __SSE2__
+	const __m128i mask = _mm_set1_epi32(RADIX_MASK);
+	const __m128i shiftCount = _mm_cvtsi32_si128(shift);
+	unsigned int digits[4];
+
+	for(; i + 4 <= end; i += 4)
+	{
+		//---- 2 key-values per load, keep the keys (x) of both loads
+		__m128 kv0 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(data + i)));
+		__m128 kv1 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(data + i + 2)));
+		__m128i keys = _mm_castps_si128(_mm_shuffle_ps(kv0, kv1, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_si128((__m128i*)digits, _mm_and_si128(_mm_srl_epi32(keys, shiftCount), mask));
+
+		counts[digits[0]]++;
+		counts[digits[1]]++;
+		counts[digits[2]]++;
+		counts[digits[3]]++;
+	}
+#endif
+
+	for(; i < end; i++)
+		counts[(data[i].s[0] >> shift) & RADIX_MASK]++;
+}
+
+#pragma endregion
+
+#pragma region Constructor
+
+clppSort_CPU::clppSort_CPU(clppContext* context, clppIndex maxElements, unsigned int bits, bool keysOnly)
+{
+	_context = context;
+	_keysOnly = keysOnly;
+	_bits = bits;
+	_keyBits = bits;
+	_keySize = 4;
+	_valueSize = keysOnly ? 0 : 4;
+
+	_dataSet = 0;
+	_datasetSize = 0;
+	_clBuffer_dataSet = 0;
+	_clBuffer_result = 0;
+
+	setThreadCount(thread::hardware_concurrency());
+	_temp.reserve(maxElements * getElementSize() / sizeof(unsigned int));
 }
 
 clppSort_CPU::~clppSort_CPU()
 {
 }
 
+void clppSort_CPU::setThreadCount(unsigned int threadCount)
+{
+	_threadCount = max(threadCount, 1u);
+	_histograms.resize(_threadCount * RADIX);
+}
+
 #pragma endregion
 
 #pragma region sort
 
 void clppSort_CPU::sort()
 {
-	//std::sort((char*)_keys, (char*)_keys + _datasetSize * (_keyBits/8));
-	std::sort((int*)_dataSet, ((int*)_dataSet) + _datasetSize);
+	if (_datasetSize < 2)
+		return;
+
+	size_t words = _datasetSize * getElementSize() / sizeof(unsigned int);
+
+	//---- Device data set : sort a host copy
+	void* data = _dataSet;
+	if (_clBuffer_dataSet)
+	{
+		_hostData.resize(words);
+		data = &_hostData[0];
+
+		cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_dataSet, CL_TRUE, 0, _datasetSize * getElementSize(), data, 0, NULL, NULL);
+		checkCLStatus(clStatus);
+	}
+
+	//---- The temporary buffer is kept between the sorts
+	if (_temp.size() < words)
+		_temp.resize(words);
+
+	if (_keysOnly)
+		radixSort((unsigned int*)data, (unsigned int*)&_temp[0], _datasetSize);
+	else
+		radixSort((cl_uint2*)data, (cl_uint2*)&_temp[0], _datasetSize);
+
+	if (_clBuffer_dataSet)
+	{
+		cl_int clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_dataSet, CL_TRUE, 0, _datasetSize * getElementSize(), data, 0, NULL, NULL);
+		checkCLStatus(clStatus);
+	}
+}
+
+template<typename T>
+void clppSort_CPU::radixSort(T* data, T* temp, size_t count)
+{
+	unsigned int threads = min((size_t)_threadCount, max((size_t)1, count / MIN_ELEMENTS_PER_THREAD));
+	unsigned int passes = (_bits + 7) / 8;
+
+	size_t* histograms = &_histograms[0];
+	clppSortBarrier barrier(threads);
+
+	T* result = data;
+	bool skipPass = false;
+
+	auto worker = [&](unsigned int t)
+	{
+		size_t begin = count * t / threads;
+		size_t end = count * (t + 1) / threads;
+		size_t* counts = histograms + t * RADIX;
+
+		// Each thread follows the ping-pong pair on its own : all the threads swap on the same passes
+		T* src = data;
+		T* dst = temp;
+
+		for(unsigned int pass = 0; pass < passes; pass++)
+		{
+			unsigned int shift = pass * 8;
+
+			//---- 1) Histogram of the slice
+			memset(counts, 0, sizeof(size_t) * RADIX);
+			histogramSlice(src, begin, end, shift, counts);
+
+			barrier.wait();
+
+			//---- 2) Scan the histograms : digit major, thread minor, to keep the sort stable
+			if (t == 0)
+			{
+				skipPass = false;
+				size_t offset = 0;
+				for(unsigned int digit = 0; digit < RADIX && !skipPass; digit++)
+				{
+					size_t digitStart = offset;
+					for(unsigned int i = 0; i < threads; i++)
+					{
+						size_t digitCount = histograms[i * RADIX + digit];
+						histograms[i * RADIX + digit] = offset;
+						offset += digitCount;
+					}
+
+					// All the keys have the same digit, nothing to move
+					if (offset - digitStart == count)
+						skipPass = true;
+				}
+			}
+
+			barrier.wait();
+
+			//---- 3) Scatter the slice
+			if (!skipPass)
+			{
+				for(size_t i = begin; i < end; i++)
+					dst[counts[(keyOf(src[i]) >> shift) & RADIX_MASK]++] = src[i];
+			}
+
+			barrier.wait();
+
+			// 'skipPass' is written again only after the first barrier of the next pass
+			if (!skipPass)
+				swap(src, dst);
+		}
+
+		if (t == 0)
+			result = src;
+	};
+
+	vector<thread> pool;
+	for(unsigned int t = 1; t < threads; t++)
+		pool.push_back(thread(worker, t));
+
+	worker(0);
+
+	for(size_t t = 0; t < pool.size(); t++)
+		pool[t].join();
+
+	//---- Odd number of passes : the result is in the temporary buffer
+	if (result != data)
+		memcpy(data, result, sizeof(T) * count);
 }
 
 #pragma endregion
@@ -28,14 +274,24 @@ void clppSort_CPU::sort()
 
 void clppSort_CPU::pushDatas(void* dataSet, size_t datasetSize)
 {
-	_keySize = _valueSize = 4;
 	_dataSet = dataSet;
 	_datasetSize = datasetSize;
+	_clBuffer_dataSet = 0;
+	_clBuffer_result = 0;
 }
 
 void clppSort_CPU::pushCLDatas(cl_mem clBuffer_dataSet, size_t datasetSize)
 {
-	// Unsupported of course !
+	_dataSet = 0;
+	_datasetSize = datasetSize;
+	_clBuffer_dataSet = clBuffer_dataSet;
+	_clBuffer_result = clBuffer_dataSet;
+}
+
+void clppSort_CPU::pushCLDatas(cl_mem clBuffer_dataSet, cl_mem, size_t datasetSize)
+{
+	// The sort happens on the host : the result is written back in the first buffer of the pair
+	pushCLDatas(clBuffer_dataSet, datasetSize);
 }
 
 #pragma endregion
@@ -44,6 +300,14 @@ void clppSort_CPU::pushCLDatas(cl_mem clBuffer_dataSet, size_t datasetSize)
 
 void clppSort_CPU::popDatas()
 {
+	// Host data are sorted in place
+}
+
+void clppSort_CPU::popDatas(void* dataSet)
+{
+	const void* sorted = _clBuffer_dataSet ? (const void*)&_hostData[0] : _dataSet;
+	if (dataSet != sorted && _datasetSize > 0)
+		memcpy(dataSet, sorted, _datasetSize * getElementSize());
 }
 
 #pragma endregion
\ No newline at end of file
@@ -38,6 +38,12 @@
 #define EXTRACT_KEY_BIT(VALUE,BIT) ((KEY(VALUE)>>BIT)&0x1)
 #define EXTRACT_KEY_4BITS(VALUE,BIT) ((KEY(VALUE)>>BIT)&0xF)
 
+// The indices of the 4 elements of a work-item, INDEX_T is defined by the host (uint, or ulong beyond 2^32 elements)
+#define VECTOR4_(TYPE) TYPE##4
+#define VECTOR4(TYPE) VECTOR4_(TYPE)
+#define INDEX_T4 VECTOR4(INDEX_T)
+#define GLOBAL_ID4 ((INDEX_T4)((INDEX_T)get_global_id(0) << 2) + (INDEX_T4)(0,1,2,3))
+
 #define BARRIER_LOCAL barrier(CLK_LOCAL_MEM_FENCE)
 
 //------------------------------------------------------------
@@ -128,11 +134,11 @@ void kernel__radixLocalSort(
 	__local KV_TYPE* localData,			// size 4*4 int2s (8 kB)
 	__global KV_TYPE* data,				// size 4*4 int2s per block (8 kB)
 	const int bitOffset,				// k*4, k=0..7
-	const int N)						// Total number of items to sort
+	const INDEX_T N)					// Total number of items to sort
 {
 	const int tid = (int)get_local_id(0);
 		
-    const int4 gid4 = (int4)(get_global_id(0) << 2) + (const int4)(0,1,2,3);    
+    const INDEX_T4 gid4 = GLOBAL_ID4;
     const int4 tid4 = (int4)(tid << 2) + (const int4)(0,1,2,3);
     
 	// Local memory
@@ -217,11 +223,11 @@ void kernel__radixLocalSort(
 //------------------------------------------------------------
 
 __kernel
-void kernel__localHistogram(__global KV_TYPE* data, const int bitOffset, __global uint* radixCount, __global uint* radixOffsets, const int N)
+void kernel__localHistogram(__global KV_TYPE* data, const int bitOffset, __global INDEX_T* radixCount, __global uint* radixOffsets, const INDEX_T N)
 {
     const int tid = (int)get_local_id(0);
     const int4 tid4 = (int4)(tid << 2) + (const int4)(0,1,2,3);
-	const int4 gid4 = (int4)(get_global_id(0) << 2) + (const int4)(0,1,2,3);
+	const INDEX_T4 gid4 = GLOBAL_ID4;
 	const int blockId = (int)get_group_id(0);
 	
 	__local uint localData[WGZ_x4];
@@ -302,18 +308,18 @@ __kernel
 void kernel__radixPermute(
 	__global const KV_TYPE* dataIn,
 	__global KV_TYPE* dataOut,
-	__global const int* histSum,
+	__global const INDEX_T* histSum,
 	__global const int* radixOffsets,
 	const uint bitOffset,
-	const uint N,
+	const INDEX_T N,
 	const int numBlocks)
 {
-    const int4 gid4 = ((const int4)(get_global_id(0) << 2)) + (const int4)(0,1,2,3);
+    const INDEX_T4 gid4 = GLOBAL_ID4;
     const int tid = get_local_id(0);
     const int4 tid4 = ((const int4)(tid << 2)) + (const int4)(0,1,2,3);
     
     //const int numBlocks = get_num_groups(0); // Can be passed as a parameter !
-    __local int sharedHistSum[16];
+    __local INDEX_T sharedHistSum[16];
     __local int localHistStart[16];
 
     // Fetch per-block KV_TYPE histogram and int histogram sums
@@ -343,7 +349,7 @@ void kernel__radixPermute(
     //BARRIER_LOCAL;
 
     // Compute the final indices
-    uint4 finalOffset;
+    INDEX_T4 finalOffset;
     finalOffset.x = tid4.x - localHistStart[myShiftedKeys[0]] + sharedHistSum[myShiftedKeys[0]];
     finalOffset.y = tid4.y - localHistStart[myShiftedKeys[1]] + sharedHistSum[myShiftedKeys[1]];
     finalOffset.z = tid4.z - localHistStart[myShiftedKeys[2]] + sharedHistSum[myShiftedKeys[2]];
@@ -1,8 +1,10 @@
 //#define BENCHMARK
 #include "clpp/clppSort_RadixSort.h"
 #include "clpp/clpp.h"
+#include "clpp/clppBufferPool.h"
+#include "clpp/clppProfiler.h"
 
-#include "clpp/StopWatch.h"
+#include "clpp/clppTimer.h"
 
 #include "clpp/clppScan_Default.h"
 
@@ -14,13 +16,17 @@
 
 #pragma region Constructor
 
-clppSort_RadixSort::clppSort_RadixSort(clppContext* context, unsigned int maxElements, unsigned int bits, bool keysOnly)
+clppSort_RadixSort::clppSort_RadixSort(clppContext* context, clppIndex maxElements, unsigned int bits, bool keysOnly)
 {
 	_keysOnly = keysOnly;
 	_valueSize = 4;
 	_keySize = 4;
 	_clBuffer_dataSet = 0;
 	_clBuffer_dataSetOut = 0;
+	_clBuffer_result = 0;
+	_clBuffer_scratch = 0;
+	_scratchSize = 0;
+	_histogramBlocks = 0;
 
 	_bits = bits;
 
@@ -31,21 +37,16 @@ clppSort_RadixSort::clppSort_RadixSort(clppContext* context, unsigned int maxEle
 	//	return;
 
 	//---- Prepare all the kernels
-	cl_int clStatus;
-
-	_kernel_RadixLocalSort = clCreateKernel(_clProgram, "kernel__radixLocalSort", &clStatus);
-	checkCLStatus(clStatus);
+	_kernel_RadixLocalSort = getKernel("kernel__radixLocalSort");
 
-	_kernel_LocalHistogram = clCreateKernel(_clProgram, "kernel__localHistogram", &clStatus);
-	checkCLStatus(clStatus);
+	_kernel_LocalHistogram = getKernel("kernel__localHistogram");
 
-	_kernel_RadixPermute = clCreateKernel(_clProgram, "kernel__radixPermute", &clStatus);
-	checkCLStatus(clStatus);
+	_kernel_RadixPermute = getKernel("kernel__radixPermute");
 
 	//---- Get the workgroup size
 	_workgroupSize = 32;
 
-	_scan = clpp::createBestScan(context, sizeof(int), maxElements);
+	_scan = clpp::createBestScan(context, clppOperator(clppDataType_Index), maxElements);
 
     _clBuffer_radixHist1 = NULL;
     _clBuffer_radixHist2 = NULL;
@@ -58,17 +59,17 @@ clppSort_RadixSort::~clppSort_RadixSort()
 	if (_is_clBuffersOwner)
 	{
 		if (_clBuffer_dataSet)
-			clReleaseMemObject(_clBuffer_dataSet);
+			_context->getBufferPool()->release(_clBuffer_dataSet);
 	}
 
-	if (_clBuffer_dataSetOut)
-		clReleaseMemObject(_clBuffer_dataSetOut);
+	if (_clBuffer_scratch)
+		_context->getBufferPool()->release(_clBuffer_scratch);
 
 	if (_clBuffer_radixHist1)
-		clReleaseMemObject(_clBuffer_radixHist1);
+		_context->getBufferPool()->release(_clBuffer_radixHist1);
 
 	if (_clBuffer_radixHist2)
-		clReleaseMemObject(_clBuffer_radixHist2);
+		_context->getBufferPool()->release(_clBuffer_radixHist2);
 
 	delete _scan;
 }
@@ -106,7 +107,7 @@ string clppSort_RadixSort::compilePreprocess(string kernel)
 
 #pragma region sort
 
-inline int roundUpDiv(int A, int B) { return (A + B - 1) / (B); }
+inline clppIndex roundUpDiv(clppIndex A, clppIndex B) { return (A + B - 1) / (B); }
 
 void clppSort_RadixSort::sort()
 {
@@ -114,11 +115,11 @@ void clppSort_RadixSort::sort()
 	// work-items, depending on the concrete device and each work-item processes more than one
 	// stream element, usually 4, in order to hide latencies.
 
-	StopWatch sw;
+	clppScopedTimer sortTimer("radix sort");
 
 	cl_int clStatus;
     unsigned int numBlocks = roundUpDiv(_datasetSize, _workgroupSize * 4);
-	unsigned int Ndiv4 = roundUpDiv(_datasetSize, 4);
+	clppIndex Ndiv4 = roundUpDiv(_datasetSize, 4);
 
 	size_t global[1] = {toMultipleOf(Ndiv4, _workgroupSize)};
     size_t local[1] = {_workgroupSize};
@@ -127,33 +128,32 @@ void clppSort_RadixSort::sort()
     cl_mem* dataB = &_clBuffer_dataSetOut;
     for(unsigned int bitOffset = 0; bitOffset < _bits; bitOffset += 4)
 	{
+		clppScopedTimer passTimer("pass");
+
 		// 1) Each workgroup sorts its tile by using local memory
 		// 2) Create an histogram of d=2^b digits entries
 #ifdef BENCHMARK
-		sw.StartTimer();
+		clppTimer::start("local sort");
 #endif
 
         radixLocal(global, local, dataA, bitOffset);
 
 #ifdef BENCHMARK
-		sw.StopTimer();
-		cout << "Local sort       " << sw.GetElapsedTime() << endl;
-
-		sw.StartTimer();
+		clppTimer::stop();
+		clppTimer::start("local histogram");
 #endif
 
         localHistogram(global, local, dataA, &_clBuffer_radixHist1, &_clBuffer_radixHist2, bitOffset);
 
 #ifdef BENCHMARK
-		sw.StopTimer();
-		cout << "Local histogram  " << sw.GetElapsedTime() << endl;
+		clppTimer::stop();
 
 		//**********
 		//clEnqueueReadBuffer(_context->clQueue, dataA, CL_TRUE, 0, sizeof(int) * _datasetSize, _dataSetOut, 0, NULL, NULL);
 		//**********
 		
 		// 3) Scan the p*2^b = p*(16) entry histogram table. Stored in column-major order, computes global digit offsets.
-		sw.StartTimer();
+		clppTimer::start("global scan");
 #endif
 
 		_scan->pushCLDatas(_clBuffer_radixHist1, 16 * numBlocks);
@@ -161,27 +161,29 @@ void clppSort_RadixSort::sort()
 
 #ifdef BENCHMARK
 		_scan->waitCompletion();
-		sw.StopTimer();
-		cout << "Global scan      " << sw.GetElapsedTime() << endl;
+		clppTimer::stop();
         
 		// 4) Prefix sum results are used to scatter each work-group's elements to their correct position.
-		sw.StartTimer();
+		clppTimer::start("global reorder");
 #endif
 
 		radixPermute(global, local, dataA, dataB, &_clBuffer_radixHist1, &_clBuffer_radixHist2, bitOffset, numBlocks);
 
 #ifdef BENCHMARK
-		sw.StopTimer();
-		cout << "Global reorder   " << sw.GetElapsedTime() << endl;
+		clppTimer::stop();
 #endif
 
         std::swap(dataA, dataB);
     }
+
+	// After the last swap, 'dataA' is the buffer that received the last permutation
+	_clBuffer_result = *dataA;
 }
 
 void clppSort_RadixSort::radixLocal(const size_t* global, const size_t* local, cl_mem* data, int bitOffset)
 {
     cl_int clStatus;
+    clppIndex N = _datasetSize;
     unsigned int a = 0;
 
 	if (_keysOnly)
@@ -190,8 +192,8 @@ void clppSort_RadixSort::radixLocal(const size_t* global, const size_t* local, c
 		clStatus  = clSetKernelArg(_kernel_RadixLocalSort, a++, (_valueSize+_keySize) * 2 * 4 * _workgroupSize, (const void*)NULL);	// 2 KV array of 128 items (2 for permutations)
     clStatus |= clSetKernelArg(_kernel_RadixLocalSort, a++, sizeof(cl_mem), (const void*)data);
     clStatus |= clSetKernelArg(_kernel_RadixLocalSort, a++, sizeof(int), (const void*)&bitOffset);
-    clStatus |= clSetKernelArg(_kernel_RadixLocalSort, a++, sizeof(unsigned int), (const void*)&_datasetSize);
-	clStatus |= clEnqueueNDRangeKernel(_context->clQueue, _kernel_RadixLocalSort, 1, NULL, global, local, 0, NULL, NULL);
+    clStatus |= clSetKernelArg(_kernel_RadixLocalSort, a++, sizeof(clppIndex), (const void*)&N);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_RadixLocalSort, 1, NULL, global, local, 0, NULL, NULL);
 
 #ifdef BENCHMARK
     clStatus |= clFinish(_context->clQueue);
@@ -202,12 +204,13 @@ void clppSort_RadixSort::radixLocal(const size_t* global, const size_t* local, c
 void clppSort_RadixSort::localHistogram(const size_t* global, const size_t* local, cl_mem* data, cl_mem* radixCount, cl_mem* radixOffsets, int bitOffset)
 {
 	cl_int clStatus;
+	clppIndex N = _datasetSize;
 	clStatus = clSetKernelArg(_kernel_LocalHistogram, 0, sizeof(cl_mem), (const void*)data);
 	clStatus |= clSetKernelArg(_kernel_LocalHistogram, 1, sizeof(int), (const void*)&bitOffset);
 	clStatus |= clSetKernelArg(_kernel_LocalHistogram, 2, sizeof(cl_mem), (const void*)radixCount);
 	clStatus |= clSetKernelArg(_kernel_LocalHistogram, 3, sizeof(cl_mem), (const void*)radixOffsets);
-	clStatus |= clSetKernelArg(_kernel_LocalHistogram, 4, sizeof(unsigned int), (const void*)&_datasetSize);
-	clStatus |= clEnqueueNDRangeKernel(_context->clQueue, _kernel_LocalHistogram, 1, NULL, global, local, 0, NULL, NULL);	
+	clStatus |= clSetKernelArg(_kernel_LocalHistogram, 4, sizeof(clppIndex), (const void*)&N);
+	clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_LocalHistogram, 1, NULL, global, local, 0, NULL, NULL);	
 
 #ifdef BENCHMARK
     clStatus |= clFinish(_context->clQueue);
@@ -218,14 +221,15 @@ void clppSort_RadixSort::localHistogram(const size_t* global, const size_t* loca
 void clppSort_RadixSort::radixPermute(const size_t* global, const size_t* local, cl_mem* dataIn, cl_mem* dataOut, cl_mem* histScan, cl_mem* blockHists, int bitOffset, unsigned int numBlocks)
 {
     cl_int clStatus;
+    clppIndex N = _datasetSize;
     clStatus  = clSetKernelArg(_kernel_RadixPermute, 0, sizeof(cl_mem), (const void*)dataIn);
     clStatus |= clSetKernelArg(_kernel_RadixPermute, 1, sizeof(cl_mem), (const void*)dataOut);
     clStatus |= clSetKernelArg(_kernel_RadixPermute, 2, sizeof(cl_mem), (const void*)histScan);
     clStatus |= clSetKernelArg(_kernel_RadixPermute, 3, sizeof(cl_mem), (const void*)blockHists);
     clStatus |= clSetKernelArg(_kernel_RadixPermute, 4, sizeof(int), (const void*)&bitOffset);
-    clStatus |= clSetKernelArg(_kernel_RadixPermute, 5, sizeof(unsigned int), (const void*)&_datasetSize);
+    clStatus |= clSetKernelArg(_kernel_RadixPermute, 5, sizeof(clppIndex), (const void*)&N);
 	clStatus |= clSetKernelArg(_kernel_RadixPermute, 6, sizeof(unsigned int), (const void*)&numBlocks);
-    clStatus |= clEnqueueNDRangeKernel(_context->clQueue, _kernel_RadixPermute, 1, NULL, global, local, 0, NULL, NULL);
+    clStatus |= _context->getProfiler()->enqueueNDRangeKernel(_kernel_RadixPermute, 1, NULL, global, local, 0, NULL, NULL);
 
 #ifdef BENCHMARK
     clStatus |= clFinish(_context->clQueue);
@@ -244,106 +248,94 @@ void clppSort_RadixSort::pushDatas(void* dataSet, size_t datasetSize)
 	//---- Store some values
 	_dataSet = dataSet;
 	_dataSetOut = dataSet;
-	bool reallocate = datasetSize > _datasetSize || !_is_clBuffersOwner;
 	_datasetSize = datasetSize;
 
+	//---- Copy on the device, through a pinned buffer of the buffer pool
+	if (!_is_clBuffersOwner)
+		_clBuffer_dataSet = 0;
+
+	_clBuffer_dataSet = _context->getBufferPool()->resizePinned(_clBuffer_dataSet, getElementSize() * _datasetSize);
+	_is_clBuffersOwner = true;
+
+	clStatus = _context->getProfiler()->enqueueWriteBuffer(_clBuffer_dataSet, CL_FALSE, 0, getElementSize() * _datasetSize, _dataSet, 0, 0, 0);
+	checkCLStatus(clStatus);
+
 	//---- Prepare some buffers
-	if (reallocate)
-	{
-		//---- Release
-		if (_clBuffer_dataSet)
-		{
-			clReleaseMemObject(_clBuffer_dataSet);
-			clReleaseMemObject(_clBuffer_dataSetOut);
-			clReleaseMemObject(_clBuffer_radixHist1);
-			clReleaseMemObject(_clBuffer_radixHist2);
-		}
-
-		//---- Allocate
-		unsigned int numBlocks = roundUpDiv(_datasetSize, _workgroupSize * 4);
-	    
-		_clBuffer_radixHist1 = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, sizeof(int) * 16 * numBlocks, NULL, &clStatus);
-		checkCLStatus(clStatus);
-
-		//_clBuffer_radixHist2 = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, sizeof(int) * 2 * 16 * numBlocks, NULL, &clStatus);
-		_clBuffer_radixHist2 = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, sizeof(int) * 16 * numBlocks, NULL, &clStatus);
-		checkCLStatus(clStatus);
-
-		//---- Copy on the device
-		if (_keysOnly)
-		{
-			_clBuffer_dataSet = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, _keySize * _datasetSize, _dataSet, &clStatus);
-			checkCLStatus(clStatus);
-
-			_clBuffer_dataSetOut = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, _keySize * _datasetSize, NULL, &clStatus);
-			checkCLStatus(clStatus);
-		}
-		else
-		{
-			_clBuffer_dataSet = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, (_valueSize+_keySize) * _datasetSize, _dataSet, &clStatus);
-			checkCLStatus(clStatus);
-
-			_clBuffer_dataSetOut = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, (_valueSize+_keySize) * _datasetSize, NULL, &clStatus);
-			checkCLStatus(clStatus);
-		}
-
-		_is_clBuffersOwner = true;
-	}
-	else
-	{
-		// Just resend
-		if (_keysOnly)
-			clEnqueueWriteBuffer(_context->clQueue, _clBuffer_dataSet, CL_FALSE, 0, (_keySize) * _datasetSize, _dataSet, 0, 0, 0);
-		else
-			clEnqueueWriteBuffer(_context->clQueue, _clBuffer_dataSet, CL_FALSE, 0, (_valueSize+_keySize) * _datasetSize, _dataSet, 0, 0, 0);
-	}
+	allocateHistograms(_datasetSize);
+	allocateScratch(_datasetSize);
+
+	_clBuffer_dataSetOut = _clBuffer_scratch;
+	_clBuffer_result = _clBuffer_dataSet;
 }
 
 void clppSort_RadixSort::pushCLDatas(cl_mem clBuffer_dataSet, size_t datasetSize)
 {
-	cl_int clStatus;
+	// The sort needs 2 different buffers. We keep our own second buffer and only
+	// re-allocate it when the data set grows, so there is no allocation per call.
+	allocateScratch(datasetSize);
+
+	pushCLDatas(clBuffer_dataSet, _clBuffer_scratch, datasetSize);
+}
+
+void clppSort_RadixSort::pushCLDatas(cl_mem clBuffer_dataSet, cl_mem clBuffer_dataSetOut, size_t datasetSize)
+{
+	//---- Release the buffer created by 'pushDatas'
+	if (_is_clBuffersOwner && _clBuffer_dataSet)
+		_context->getBufferPool()->release(_clBuffer_dataSet);
 
 	_is_clBuffersOwner = false;
 
 	//---- Store some values
-	bool reallocate = datasetSize > _datasetSize;
+	_dataSet = 0;
+	_dataSetOut = 0;
 	_datasetSize = datasetSize;
 
 	//---- Prepare some buffers
-	if (reallocate)
-	{
-		//---- Release
-		if (_clBuffer_dataSet)
-		{
-			clReleaseMemObject(_clBuffer_dataSet);
-			clReleaseMemObject(_clBuffer_dataSetOut);
-			clReleaseMemObject(_clBuffer_radixHist1);
-			clReleaseMemObject(_clBuffer_radixHist2);
-		}
-
-		//---- Allocate
-		unsigned int numBlocks = roundUpDiv(_datasetSize, _workgroupSize * 4);
-	    
-		// column size = 2^b = 16
-		// row size = numblocks
-		_clBuffer_radixHist1 = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, sizeof(int) * 16 * numBlocks, NULL, &clStatus);
-		checkCLStatus(clStatus);
-		_clBuffer_radixHist2 = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, sizeof(int) * 16 * numBlocks, NULL, &clStatus);
-		checkCLStatus(clStatus);
-	}
-
-	// ISSUE : We need 2 different buffers, but
-	// a) when using 32 bits sort(by example) the result buffer is _clBuffer_dataSet
-	// b) when using 28 bits sort(by example) the result buffer is _clBuffer_dataSetOut
-	// Without copy, how can we do to put the result in _clBuffer_dataSet when using 28 bits ?
+	allocateHistograms(_datasetSize);
 
+	// Depending on the number of radix passes, the result ends up in one buffer or the other.
+	// 'sort' updates '_clBuffer_result' accordingly.
 	_clBuffer_dataSet = clBuffer_dataSet;
-	
-	if (_keysOnly)
-		_clBuffer_dataSetOut = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, _keySize * _datasetSize, NULL, &clStatus);
-	else
-		_clBuffer_dataSetOut = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, (_valueSize+_keySize) * _datasetSize, NULL, &clStatus);
-	checkCLStatus(clStatus);
+	_clBuffer_dataSetOut = clBuffer_dataSetOut;
+	_clBuffer_result = _clBuffer_dataSet;
+}
+
+void clppSort_RadixSort::allocateHistograms(size_t datasetSize)
+{
+	unsigned int numBlocks = roundUpDiv(datasetSize, _workgroupSize * 4);
+	if (numBlocks <= _histogramBlocks)
+		return;
+
+	//---- Release
+	if (_clBuffer_radixHist1)
+		_context->getBufferPool()->release(_clBuffer_radixHist1);
+	if (_clBuffer_radixHist2)
+		_context->getBufferPool()->release(_clBuffer_radixHist2);
+
+	//---- Allocate
+	// column size = 2^b = 16
+	// row size = numblocks
+
+	// histogram : 16 values per block
+	_clBuffer_radixHist1 = _context->getBufferPool()->acquire(sizeof(clppIndex) * 16 * numBlocks);
+
+	// histogram : 16 values per block
+	_clBuffer_radixHist2 = _context->getBufferPool()->acquire(sizeof(int) * 16 * numBlocks);
+
+	_histogramBlocks = numBlocks;
+}
+
+void clppSort_RadixSort::allocateScratch(size_t datasetSize)
+{
+	if (datasetSize <= _scratchSize)
+		return;
+
+	if (_clBuffer_scratch)
+		_context->getBufferPool()->release(_clBuffer_scratch);
+
+	_clBuffer_scratch = _context->getBufferPool()->acquire(getElementSize() * datasetSize);
+
+	_scratchSize = datasetSize;
 }
 
 #pragma endregion
@@ -357,22 +349,8 @@ void clppSort_RadixSort::popDatas()
 
 void clppSort_RadixSort::popDatas(void* dataSet)
 {
-	cl_int clStatus;
-
-	if (_keysOnly)
-	{
-		if ((_bits/4) % 2 == 0)
-			clEnqueueReadBuffer(_context->clQueue, _clBuffer_dataSet, CL_TRUE, 0, _keySize * _datasetSize, dataSet, 0, NULL, NULL);
-		else
-			clEnqueueReadBuffer(_context->clQueue, _clBuffer_dataSetOut, CL_TRUE, 0, _keySize * _datasetSize, dataSet, 0, NULL, NULL);
-	}
-	else
-	{
-		if ((_bits/4) % 2 == 0)
-			clEnqueueReadBuffer(_context->clQueue, _clBuffer_dataSet, CL_TRUE, 0, (_valueSize + _keySize) * _datasetSize, dataSet, 0, NULL, NULL);
-		else
-			clEnqueueReadBuffer(_context->clQueue, _clBuffer_dataSetOut, CL_TRUE, 0, (_valueSize + _keySize) * _datasetSize, dataSet, 0, NULL, NULL);
-	}
+	cl_int clStatus = _context->getProfiler()->enqueueReadBuffer(_clBuffer_result, CL_TRUE, 0, getElementSize() * _datasetSize, dataSet, 0, NULL, NULL);
+	checkCLStatus(clStatus);
 }
 
 #pragma endregion
\ No newline at end of file
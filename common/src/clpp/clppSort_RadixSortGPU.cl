@@ -38,6 +38,12 @@
 #define EXTRACT_KEY_BIT(VALUE,BIT) ((KEY(VALUE)>>BIT)&0x1)
 #define EXTRACT_KEY_4BITS(VALUE,BIT) ((KEY(VALUE)>>BIT)&0xF)
 
+// The indices of the 4 elements of a work-item, INDEX_T is defined by the host (uint, or ulong beyond 2^32 elements)
+#define VECTOR4_(TYPE) TYPE##4
+#define VECTOR4(TYPE) VECTOR4_(TYPE)
+#define INDEX_T4 VECTOR4(INDEX_T)
+#define GLOBAL_ID4 ((INDEX_T4)((INDEX_T)get_global_id(0) << 2) + (INDEX_T4)(0,1,2,3))
+
 // Because our workgroup size = SIMT size, we use the natural synchronization provided by SIMT.
 // So, we don't need any barrier to synchronize
 #define BARRIER_LOCAL barrier(CLK_LOCAL_MEM_FENCE)
@@ -140,11 +146,11 @@ void kernel__radixLocalSort(
 	//__local KV_TYPE* localDataOLD,
 	__global KV_TYPE* data,
 	const int bitOffset,
-	const int N)
+	const INDEX_T N)
 {
 	const uint tid = (uint)get_local_id(0);
 	const uint4 tid4 = (const uint4)(tid << 2) + (const uint4)(0,1,2,3);
-	const uint4 gid4 = (const uint4)(get_global_id(0) << 2) + (const uint4)(0,1,2,3);
+	const INDEX_T4 gid4 = GLOBAL_ID4;
 	
 	// Local memory
 	__local KV_TYPE localDataArray[TPG*4*2]; // Faster than using it as a parameter !!!
@@ -219,11 +225,11 @@ void kernel__radixLocalSort(
 //------------------------------------------------------------
 
 __kernel
-void kernel__localHistogram(__global KV_TYPE* data, const int bitOffset, __global int* radixCount, __global int* radixOffsets, const int N)
+void kernel__localHistogram(__global KV_TYPE* data, const int bitOffset, __global INDEX_T* radixCount, __global int* radixOffsets, const INDEX_T N)
 {
     const int tid = (int)get_local_id(0);
     const int4 tid4 = (int4)(tid << 2) + (const int4)(0,1,2,3);
-	const int4 gid4 = (int4)(get_global_id(0) << 2) + (const int4)(0,1,2,3);
+	const INDEX_T4 gid4 = GLOBAL_ID4;
 	const int blockId = (int)get_group_id(0);
 	
 	__local uint localData[WGZ_x4];
@@ -311,19 +317,19 @@ __kernel
 void kernel__radixPermute(
 	__global const KV_TYPE* dataIn,		// size 4*4 int2s per block
 	__global KV_TYPE* dataOut,			// size 4*4 int2s per block
-	__global const int* histSum,		// size 16 per block (64 B)
+	__global const INDEX_T* histSum,	// size 16 per block
 	__global const int* blockHists,		// size 16 int2s per block (64 B)
 	const int bitOffset,				// k*4, k=0..7
-	const int N,
+	const INDEX_T N,
 	const int numBlocks)
 {    
     const int tid = get_local_id(0);	
 	const int groupId = get_group_id(0);
     const int4 tid4 = (int4)(tid << 2) + (const int4)(0,1,2,3);
-	const int4 gid4 = (int4)(get_global_id(0) << 2) + (const int4)(0,1,2,3);
+	const INDEX_T4 gid4 = GLOBAL_ID4;
 	
 	
-    __local int sharedHistSum[16];
+    __local INDEX_T sharedHistSum[16];
     __local int localHistStart[16];
 
     // Fetch per-block KV_TYPE histogram and int histogram sums
@@ -337,7 +343,7 @@ void kernel__radixPermute(
 	
 	KV_TYPE myData;
     int myShiftedKeys;
-	int finalOffset;
+	INDEX_T finalOffset;
 	
 	myData = (gid4.x < N) ? dataIn[gid4.x] : MAX_KV_TYPE;
     myShiftedKeys = EXTRACT_KEY_4BITS(myData, bitOffset);
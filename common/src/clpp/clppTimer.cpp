@@ -0,0 +1,220 @@
+#include "clpp/clppTimer.h"
+#include "clpp/clppTracer.h"
+
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <set>
+#include <assert.h>
+
+bool clppTimer::_enabled = false;
+
+#pragma region Timer trees
+
+// A scope of a timer tree, with its accumulated times
+struct clppTimerNode
+{
+	string name;
+	vector<size_t> children;	// Indices of the scopes started inside this one
+	size_t count;
+	double totalTime;
+	double minTime;
+	double maxTime;
+
+	clppTimerNode(const string& name) : name(name), count(0), totalTime(0), minTime(0), maxTime(0) {}
+};
+
+// The scopes timed by a thread : nodes[0] is the root
+struct clppTimerTree
+{
+	vector<clppTimerNode> nodes;
+	vector<pair<size_t, clppTimer::Clock::time_point> > running;	// The started scopes, innermost last
+
+	clppTimerTree() { nodes.push_back(clppTimerNode("")); }
+
+	// Returns the scope 'name' inside 'parent', created on the first call
+	size_t getChild(size_t parent, const string& name)
+	{
+		for(size_t i = 0; i < nodes[parent].children.size(); i++)
+			if (nodes[nodes[parent].children[i]].name == name)
+				return nodes[parent].children[i];
+
+		nodes.push_back(clppTimerNode(name));
+		nodes[parent].children.push_back(nodes.size() - 1);
+		return nodes.size() - 1;
+	}
+
+	void add(size_t node, size_t count, double totalTime, double minTime, double maxTime)
+	{
+		clppTimerNode& n = nodes[node];
+		n.minTime = (n.count == 0) ? minTime : min(n.minTime, minTime);
+		n.maxTime = (n.count == 0) ? maxTime : max(n.maxTime, maxTime);
+		n.count += count;
+		n.totalTime += totalTime;
+	}
+
+	// Accumulate the scope 'srcNode' of 'src', and the scopes inside it, in 'node'
+	void merge(size_t node, const clppTimerTree& src, size_t srcNode)
+	{
+		const clppTimerNode& s = src.nodes[srcNode];
+		if (s.count > 0)
+			add(node, s.count, s.totalTime, s.minTime, s.maxTime);
+
+		for(size_t i = 0; i < s.children.size(); i++)
+			merge(getChild(node, src.nodes[s.children[i]].name), src, s.children[i]);
+	}
+
+	// The running scopes keep their place : only the times are cleared
+	void clearTimes()
+	{
+		for(size_t i = 0; i < nodes.size(); i++)
+			nodes[i].count = 0, nodes[i].totalTime = nodes[i].minTime = nodes[i].maxTime = 0;
+	}
+};
+
+static mutex _treesMutex;
+static set<clppTimerTree*> _threadTrees;	// The trees of the running threads
+static clppTimerTree _endedTrees;			// The times of the ended threads
+
+// The tree of a thread, registered for the reports, and merged in '_endedTrees' when the thread ends
+struct clppThreadTimerTree : public clppTimerTree
+{
+	clppThreadTimerTree()
+	{
+		lock_guard<mutex> lock(_treesMutex);
+		_threadTrees.insert(this);
+	}
+
+	~clppThreadTimerTree()
+	{
+		lock_guard<mutex> lock(_treesMutex);
+		_endedTrees.merge(0, *this, 0);
+		_threadTrees.erase(this);
+	}
+};
+
+static thread_local clppThreadTimerTree _threadTree;
+
+#pragma endregion
+
+#pragma region start / stop
+
+void clppTimer::start(const char* name)
+{
+	if (!_enabled)
+		return;
+
+	size_t parent = _threadTree.running.empty() ? 0 : _threadTree.running.back().first;
+	size_t node = _threadTree.getChild(parent, name);
+
+	_threadTree.running.push_back(make_pair(node, Clock::now()));
+}
+
+double clppTimer::stop()
+{
+	Clock::time_point end = Clock::now();
+
+	if (!_enabled)
+		return 0;
+
+	assert(!_threadTree.running.empty());
+	if (_threadTree.running.empty())
+		return 0;
+
+	size_t node = _threadTree.running.back().first;
+	Clock::time_point start = _threadTree.running.back().second;
+	double time = chrono::duration<double>(end - start).count();
+	_threadTree.running.pop_back();
+
+	_threadTree.add(node, 1, time, time, time);
+
+	if (clppTracer::isEnabled())
+		clppTracer::addSpan(_threadTree.nodes[node].name, start, end);
+
+	return time;
+}
+
+#pragma endregion
+
+#pragma region Stats
+
+// Add the scopes of 'node' to 'stats', depth first. Returns false when nothing was timed under 'node'.
+static bool addStats(const clppTimerTree& tree, size_t node, const string& path, unsigned int depth, vector<clppTimerStats>& stats)
+{
+	const clppTimerNode& n = tree.nodes[node];
+
+	size_t index = stats.size();
+	clppTimerStats s;
+	s.path = path;
+	s.depth = depth;
+	s.count = n.count;
+	s.totalTime = n.totalTime;
+	s.minTime = n.minTime;
+	s.maxTime = n.maxTime;
+	stats.push_back(s);
+
+	bool timed = n.count > 0;
+	for(size_t i = 0; i < n.children.size(); i++)
+	{
+		const clppTimerNode& child = tree.nodes[n.children[i]];
+		timed |= addStats(tree, n.children[i], path.empty() ? child.name : path + "/" + child.name, depth + 1, stats);
+	}
+
+	if (!timed)
+		stats.resize(index);
+
+	return timed;
+}
+
+vector<clppTimerStats> clppTimer::getStats()
+{
+	clppTimerTree merged;
+	{
+		lock_guard<mutex> lock(_treesMutex);
+		merged.merge(0, _endedTrees, 0);
+		for(set<clppTimerTree*>::iterator it = _threadTrees.begin(); it != _threadTrees.end(); it++)
+			merged.merge(0, **it, 0);
+	}
+
+	vector<clppTimerStats> stats;
+	for(size_t i = 0; i < merged.nodes[0].children.size(); i++)
+	{
+		size_t child = merged.nodes[0].children[i];
+		addStats(merged, child, merged.nodes[child].name, 0, stats);
+	}
+
+	return stats;
+}
+
+void clppTimer::printStats()
+{
+	vector<clppTimerStats> stats = getStats();
+
+	cout << "Host timers (ms) :" << endl;
+	cout << left << setw(40) << "scope" << right << setw(10) << "count" << setw(14) << "total" << setw(12) << "mean"
+		<< setw(12) << "min" << setw(12) << "max" << endl;
+
+	cout << fixed << setprecision(4);
+	for(size_t i = 0; i < stats.size(); i++)
+	{
+		// The name of the scope, indented by its depth
+		string name = stats[i].path.substr(stats[i].path.find_last_of('/') + 1);
+		name = string(2 * stats[i].depth, ' ') + name;
+
+		double mean = stats[i].count ? stats[i].totalTime / stats[i].count : 0;
+		cout << left << setw(40) << name << right << setw(10) << stats[i].count << setw(14) << stats[i].totalTime * 1000 << setw(12) << mean * 1000
+			<< setw(12) << stats[i].minTime * 1000 << setw(12) << stats[i].maxTime * 1000 << endl;
+	}
+	cout.unsetf(ios_base::floatfield);
+	cout << setprecision(6);
+}
+
+void clppTimer::reset()
+{
+	lock_guard<mutex> lock(_treesMutex);
+	_endedTrees.clearTimes();
+	for(set<clppTimerTree*>::iterator it = _threadTrees.begin(); it != _threadTrees.end(); it++)
+		(*it)->clearTimes();
+}
+
+#pragma endregion
\ No newline at end of file
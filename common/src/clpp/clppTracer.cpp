@@ -0,0 +1,173 @@
+#include "clpp/clppTracer.h"
+#include "clpp/clppProfiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+bool clppTracer::_enabled = false;
+
+// A host span, in nanoseconds on the clock of clppTimer
+struct clppTraceSpan
+{
+	string name;
+	unsigned int thread;
+	long long start;
+	long long end;
+};
+
+static mutex _spansMutex;
+static vector<clppTraceSpan> _spans;
+static size_t _maxSpans = 1 << 20;
+static size_t _droppedSpans = 0;		// The spans not recorded since the last reset (beyond '_maxSpans')
+
+// The row of each thread in the trace, in the order of their first span (the threads that didn't record a span
+// can take a number too)
+static atomic<unsigned int> _threadCount(0);
+static thread_local unsigned int _threadIndex = _threadCount++;
+
+#pragma region addSpan
+
+static long long toNanoseconds(clppTimer::Clock::time_point time)
+{
+	return chrono::duration_cast<chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+void clppTracer::addSpan(const string& name, clppTimer::Clock::time_point start, clppTimer::Clock::time_point end)
+{
+	clppTraceSpan span = { name, _threadIndex, toNanoseconds(start), toNanoseconds(end) };
+
+	lock_guard<mutex> lock(_spansMutex);
+	if (_spans.size() < _maxSpans)
+		_spans.push_back(span);
+	else
+		_droppedSpans++;
+}
+
+void clppTracer::reset()
+{
+	lock_guard<mutex> lock(_spansMutex);
+	_spans.clear();
+	_droppedSpans = 0;
+}
+
+void clppTracer::setMaxSpans(size_t maxSpans)
+{
+	lock_guard<mutex> lock(_spansMutex);
+	_maxSpans = maxSpans;
+}
+
+#pragma endregion
+
+#pragma region write
+
+// A JSON string
+static string quote(const string& text)
+{
+	string quoted = "\"";
+	for(size_t i = 0; i < text.size(); i++)
+	{
+		char c = text[i];
+		if (c == '"' || c == '\\')
+			quoted += '\\';
+		if ((unsigned char)c < 0x20)
+			c = ' ';
+		quoted += c;
+	}
+	return quoted + "\"";
+}
+
+// A complete event ("ph":"X"), the times in nanoseconds from the origin of the trace
+static void writeEvent(ostream& out, bool& first, const string& name, const char* category, int pid, unsigned int tid, long long start, long long duration)
+{
+	out << (first ? "\n" : ",\n");
+	first = false;
+
+	out << "{\"name\":" << quote(name) << ",\"cat\":\"" << category << "\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << tid
+		<< ",\"ts\":" << start * 1e-3 << ",\"dur\":" << duration * 1e-3 << "}";
+}
+
+static void writeName(ostream& out, bool& first, const char* kind, int pid, unsigned int tid, const string& name)
+{
+	out << (first ? "\n" : ",\n");
+	first = false;
+
+	out << "{\"name\":\"" << kind << "\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << tid << ",\"args\":{\"name\":" << quote(name) << "}}";
+}
+
+bool clppTracer::write(const string& fileName, clppProfiler* profiler)
+{
+	ofstream out(fileName.c_str());
+	if (!out)
+		return false;
+
+	vector<clppTraceSpan> spans;
+	size_t droppedSpans;
+	{
+		lock_guard<mutex> lock(_spansMutex);
+		spans = _spans;
+		droppedSpans = _droppedSpans;
+	}
+
+	//---- The device commands on the host clock, with one offset for all of them : a command is queued
+	// after the host time taken before its enqueue, so each command bounds the offset from below, and
+	// the largest bound is the closest. An offset per command would move each kernel by its own jitter.
+	vector<clppTraceSpan> commands;
+	size_t droppedCommands = 0;
+	if (profiler)
+	{
+		const vector<clppProfileRecord>& records = profiler->getRecords();
+		droppedCommands = profiler->getDroppedCount();
+
+		long long offset = 0;
+		for(size_t i = 0; i < records.size(); i++)
+		{
+			long long bound = (long long)records[i].hostQueued - (long long)records[i].queued;
+			offset = (i == 0) ? bound : max(offset, bound);
+		}
+
+		for(size_t i = 0; i < records.size(); i++)
+		{
+			clppTraceSpan command = { profiler->getName(records[i].name), 0, (long long)records[i].start + offset, (long long)records[i].end + offset };
+			commands.push_back(command);
+		}
+	}
+
+	//---- The times start at the first event
+	long long origin = 0;
+	if (!spans.empty() || !commands.empty())
+	{
+		origin = spans.empty() ? commands[0].start : spans[0].start;
+		for(size_t i = 0; i < spans.size(); i++)
+			origin = min(origin, spans[i].start);
+		for(size_t i = 0; i < commands.size(); i++)
+			origin = min(origin, commands[i].start);
+	}
+
+	out << fixed << setprecision(3);
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	bool first = true;
+	writeName(out, first, "process_name", 0, 0, "host");
+	writeName(out, first, "process_name", 1, 0, "device");
+	writeName(out, first, "thread_name", 1, 0, "queue");
+
+	unsigned int threads = _threadCount;
+	for(unsigned int t = 0; t < threads; t++)
+		writeName(out, first, "thread_name", 0, t, "thread " + to_string(t));
+
+	for(size_t i = 0; i < spans.size(); i++)
+		writeEvent(out, first, spans[i].name, "host", 0, spans[i].thread, spans[i].start - origin, spans[i].end - spans[i].start);
+
+	for(size_t i = 0; i < commands.size(); i++)
+		writeEvent(out, first, commands[i].name, "device", 1, 0, commands[i].start - origin, commands[i].end - commands[i].start);
+
+	out << "\n],\"otherData\":{\"droppedSpans\":" << droppedSpans << ",\"droppedCommands\":" << droppedCommands << "}}" << endl;
+
+	return out.good();
+}
+
+#pragma endregion
\ No newline at end of file
@@ -19,7 +19,6 @@
 #include <memory>
 #include <iostream>
 #include <cassert>
-#include <sys/time.h>
 #include <limits.h>
 #include <float.h>
 
@@ -29,8 +28,15 @@
 #endif
 
 #include <clpp/clpp.h>
-#include <clpp/clppSort_RadixSortGPU.h>
+#include <clpp/clppReduce.h>
+#include <clpp/clppCompact.h>
 #include <clpp/clppProgram.h>
+#include <clpp/clppKernelLauncher.h>
+#include <clpp/clppBufferPool.h>
+#include <clpp/clppMappedBuffer.h>
+#include <clpp/clppProfiler.h>
+#include <clpp/clppTimer.h>
+#include <clpp/clppTracer.h>
 
 //! Represents the state of a particular generator
 typedef struct{ uint x; uint c; } mwc64x_state_t;
@@ -44,87 +50,66 @@ inline void clCheckError (cl_int err, const char *name)
 	}
 }
 
-double cpuSecond()
-{
-  struct timeval tp;
-  gettimeofday(&tp, NULL);
-  return((double)tp.tv_sec + (double)tp.tv_usec*1.e-6);
-}
-
 static clppContext clpp_context;
 static clppProgram pholdProgram = clppProgram();
 static std::string kernelFileName = "/home/jared/repos/OpenCLPhold/src/oclPhold/phold.cl";
-
-cl_int runInitializeSimulator (size_t *grid_size, size_t *block_size,
+static std::string pholdBuildOptions = "";	// --options="-cl-fast-relaxed-math" : the PHOLD kernels are float-heavy
+static bool pholdProfile = false;			// --profile : the time of each kernel, printed at the end of the test
+static bool pholdTimers = false;			// --timers : the host time of each step of the windows, printed at the end of the test
+static std::string pholdCachePath = "";		// --cache=dir : the on-disk cache of the program binaries (off by default)
+static std::string pholdTraceFile = "";		// --trace=phold.json : the timeline of the host and the device (chrome://tracing, Perfetto)
+
+// Each PHOLD kernel has its own launcher : the arguments are type-checked, and only the ones that changed are set
+cl_int runInitializeSimulator (size_t *global_size, size_t *block_size,
 		cl_mem d_random_state, cl_mem d_lp_current_time, cl_mem d_event_time, cl_mem d_event_lp_number, cl_mem d_events_processed)
 {
-	cl_int clStatus;
-	unsigned int a = 0;
-
-	cl_kernel _kernel_initializeSimulator = clCreateKernel(pholdProgram._clProgram, "initializeSimulator", &clStatus);
-	clCheckError (clStatus, "clCreateKernel: _kernel_initializeSimulator");
-
-	clStatus = clSetKernelArg(_kernel_initializeSimulator, a++, sizeof (mwc64x_state_t), (const void*)&d_random_state);
-	clCheckError (clStatus, "clSetKernelArg: d_random_state");
-	clStatus |= clSetKernelArg(_kernel_initializeSimulator, a++, sizeof(cl_mem), (const void*)&d_lp_current_time);
-	clCheckError (clStatus, "clSetKernelArg: d_lp_current_time");
-	clStatus |= clSetKernelArg(_kernel_initializeSimulator, a++, sizeof(cl_mem), (const void*)&d_event_time);
-	clCheckError (clStatus, "clSetKernelArg: d_event_time");
-	clStatus |= clSetKernelArg(_kernel_initializeSimulator, a++, sizeof(cl_mem), (const void*)&d_event_lp_number);
-	clCheckError (clStatus, "clSetKernelArg: d_event_lp_number");
-	clStatus |= clSetKernelArg(_kernel_initializeSimulator, a++, sizeof(cl_mem), (const void*)&d_events_processed);
-	clCheckError (clStatus, "clSetKernelArg: d_events_processed");
-	clStatus |= clEnqueueNDRangeKernel(clpp_context.clQueue, _kernel_initializeSimulator, 1, NULL, grid_size, block_size, 0, NULL, NULL);
-	clCheckError (clStatus, "clEnqueueNDRangeKernel");
+	static clppKernelLauncher<cl_mem, cl_mem, cl_mem, cl_mem, cl_mem> _kernel_initializeSimulator (&clpp_context, pholdProgram.getKernel ("initializeSimulator"));
+
+	cl_int clStatus = _kernel_initializeSimulator.launch (global_size[0], block_size[0],
+			d_random_state, d_lp_current_time, d_event_time, d_event_lp_number, d_events_processed);
+	clCheckError (clStatus, "launch: initializeSimulator");
 	clStatus |= clFinish(clpp_context.clQueue);
 
 	return clStatus;
 }
 
 // markNextEventByLP<<<grid_size, block_size>>>(d_event_lp_number.Current(), d_next_event_flag);
-cl_int runMarkNextEventByLP (size_t *grid_size, size_t *block_size,
+cl_int runMarkNextEventByLP (size_t *global_size, size_t *block_size,
 		cl_mem d_event_lp_number, cl_mem d_next_event_flag)
 {
-	cl_int clStatus;
-	unsigned int a = 0;
-
-	cl_kernel _kernel_markNextEventByLP = clCreateKernel(pholdProgram._clProgram, "markNextEventByLP", &clStatus);
-	clCheckError (clStatus, "clCreateKernel: _kernel_markNextEventByLP");
-
-	clStatus = clSetKernelArg(_kernel_markNextEventByLP, a++, sizeof (cl_mem), (const void*)&d_event_lp_number);
-	clCheckError (clStatus, "clSetKernelArg: d_event_lp_number");
-	clStatus |= clSetKernelArg(_kernel_markNextEventByLP, a++, sizeof(cl_mem), (const void*)&d_next_event_flag);
-	clCheckError (clStatus, "clSetKernelArg: d_next_event_flag");
-	clStatus |= clEnqueueNDRangeKernel(clpp_context.clQueue, _kernel_markNextEventByLP, 1, NULL, grid_size, block_size, 0, NULL, NULL);
-	clCheckError (clStatus, "clEnqueueNDRangeKernel");
+	static clppKernelLauncher<cl_mem, cl_mem> _kernel_markNextEventByLP (&clpp_context, pholdProgram.getKernel ("markNextEventByLP"));
+
+	cl_int clStatus = _kernel_markNextEventByLP.launch (global_size[0], block_size[0],
+			d_event_lp_number, d_next_event_flag);
+	clCheckError (clStatus, "launch: markNextEventByLP");
 	clStatus |= clFinish(clpp_context.clQueue);
 
 	return clStatus;
 }
-//simulatorRun<<<gird_run_size, block_size>>>(d_random_state, d_lp_current_time, d_event_time.Current(), d_event_lp_number.Current(), d_current_lbts, d_events_processed);
-cl_int runSimulatorRun (size_t *grid_size, size_t *block_size,
+// Flag the LPs whose next event is safe to process in this window
+cl_int runMarkReadyLPs (size_t *global_size, size_t *block_size,
+		cl_mem d_event_time, cl_mem d_current_lbts, cl_mem d_ready_flag)
+{
+	static clppKernelLauncher<cl_mem, cl_mem, cl_mem> _kernel_markReadyLPs (&clpp_context, pholdProgram.getKernel ("markReadyLPs"));
+
+	cl_int clStatus = _kernel_markReadyLPs.launch (global_size[0], block_size[0],
+			d_event_time, d_current_lbts, d_ready_flag);
+	clCheckError (clStatus, "launch: markReadyLPs");
+
+	return clStatus;
+}
+
+// Process the next event of the ready LPs only (compacted list of LP indices)
+cl_int runSimulatorRunReady (size_t *block_size, cl_mem d_ready_lps, clppIndex num_ready,
 		cl_mem d_random_state, cl_mem d_lp_current_time, cl_mem d_event_time, cl_mem d_event_lp_number, cl_mem d_current_lbts, cl_mem d_events_processed)
 {
-	cl_int clStatus;
-	unsigned int a = 0;
-
-	cl_kernel _kernel_simulatorRun = clCreateKernel(pholdProgram._clProgram, "simulatorRun", &clStatus);
-	clCheckError (clStatus, "clCreateKernel: _kernel_simulatorRun");
-
-	clStatus = clSetKernelArg(_kernel_simulatorRun, a++, sizeof (mwc64x_state_t), (const void*)&d_random_state);
-	clCheckError (clStatus, "clSetKernelArg: d_random_state");
-	clStatus |= clSetKernelArg(_kernel_simulatorRun, a++, sizeof(cl_mem), (const void*)&d_lp_current_time);
-	clCheckError (clStatus, "clSetKernelArg: d_lp_current_time");
-	clStatus |= clSetKernelArg(_kernel_simulatorRun, a++, sizeof(cl_mem), (const void*)&d_event_time);
-	clCheckError (clStatus, "clSetKernelArg: d_event_time");
-	clStatus |= clSetKernelArg(_kernel_simulatorRun, a++, sizeof(cl_mem), (const void*)&d_event_lp_number);
-	clCheckError (clStatus, "clSetKernelArg: d_event_lp_number");
-	clStatus |= clSetKernelArg(_kernel_simulatorRun, a++, sizeof(cl_mem), (const void*)&d_current_lbts);
-	clCheckError (clStatus, "clSetKernelArg: d_current_lbts");
-	clStatus |= clSetKernelArg(_kernel_simulatorRun, a++, sizeof(cl_mem), (const void*)&d_events_processed);
-	clCheckError (clStatus, "clSetKernelArg: d_events_processed");
-	clStatus |= clEnqueueNDRangeKernel(clpp_context.clQueue, _kernel_simulatorRun, 1, NULL, grid_size, block_size, 0, NULL, NULL);
-	clCheckError (clStatus, "clEnqueueNDRangeKernel");
+	static clppKernelLauncher<cl_mem, clppIndex, cl_mem, cl_mem, cl_mem, cl_mem, cl_mem, cl_mem> _kernel_simulatorRunReady (&clpp_context, pholdProgram.getKernel ("simulatorRunReady"));
+
+	size_t global_size = ((num_ready + block_size[0] - 1) / block_size[0]) * block_size[0];
+
+	cl_int clStatus = _kernel_simulatorRunReady.launch (global_size, block_size[0],
+			d_ready_lps, num_ready, d_random_state, d_lp_current_time, d_event_time, d_event_lp_number, d_current_lbts, d_events_processed);
+	clCheckError (clStatus, "launch: simulatorRunReady");
 	clStatus |= clFinish(clpp_context.clQueue);
 
 	return clStatus;
@@ -132,13 +117,19 @@ cl_int runSimulatorRun (size_t *grid_size, size_t *block_size,
 
 int runTest ()
 {
-	cl_int errNum;
-
     clpp_context.setup (0, 0);
+    clpp_context.getProfiler()->setEnabled (pholdProfile || !pholdTraceFile.empty());
+
+    // With --cache, the programs built by the previous runs are loaded from the binary cache. The others
+    // build in parallel in the background (PHOLD, sort, reduce, compact) until their first kernel launch
+    clppProgram::setBinaryCachePath (pholdCachePath);
+    clppProgram::setAsyncBuild (true);
+    pholdProgram.setBuildOptions (pholdBuildOptions);
     assert(pholdProgram.compile (&clpp_context, kernelFileName));
 
 	std::cout << "Device ID: " << clpp_context.clDevice << std::endl;
 	std::cout << "Platform ID: " << clpp_context.clPlatform << std::endl;
+	std::cout << "Host unified memory: " << (clpp_context.isHostUnified ? "yes" : "no") << std::endl;
 
 	//debug files
 	std::ofstream currentTime;
@@ -155,109 +146,121 @@ int runTest ()
 	int num_events = 2 * num_lps;
 
 	float                        current_lbts;
-	double                       total_start_time;
 	double                       total_duration;
 
-	// Allocate device memory
-    cl_mem d_events_processed = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (int) * num_lps, NULL, &errNum);
-    clCheckError (errNum, "clCreateBuffer: d_events_processed");
+	// Allocate device memory : the buffers go back to the pool of the context at the end of the test
+    clppBuffer d_events_processed (clpp_context.getBufferPool(), sizeof (int) * num_lps);
 
-    cl_mem d_lp_current_time = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (float) * num_lps, NULL, &errNum);
-    clCheckError (errNum, "clCreateBuffer: d_lp_current_time");
-    cl_mem d_random_state = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (mwc64x_state_t) * num_lps, NULL, &errNum);
-    clCheckError (errNum, "clCreateBuffer: d_random_state");
+    clppBuffer d_lp_current_time (clpp_context.getBufferPool(), sizeof (float) * num_lps);
+    clppBuffer d_random_state (clpp_context.getBufferPool(), sizeof (mwc64x_state_t) * num_lps);
 
     // Need to make double buffer
-    cl_mem d_event_lp_number = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (int) * num_lps, NULL, &errNum);
-    clCheckError (errNum, "clCreateBuffer: d_event_lp_number");
+    // One LP number per event : the initialization gives every LP a stop event after its first one
+    clppBuffer d_event_lp_number (clpp_context.getBufferPool(), sizeof (int) * num_events);
 
     // Need to make double buffer
-    cl_mem d_event_time = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (float) * num_events, NULL, &errNum);
-    clCheckError (errNum, "clCreateBuffer: d_event_time");
+    clppBuffer d_event_time (clpp_context.getBufferPool(), sizeof (float) * num_events);
 
-    cl_mem d_current_lbts = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (float), NULL, &errNum);
-    clCheckError (errNum, "clCreateBuffer: d_current_lbts");
+    clppBuffer d_current_lbts (clpp_context.getBufferPool(), sizeof (float));
 
-    cl_mem d_next_event_flag = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (unsigned char) * num_events, NULL, &errNum);
-    clCheckError (errNum, "clCreateBuffer: d_next_event_flag");
+    clppBuffer d_next_event_flag (clpp_context.getBufferPool(), sizeof (unsigned char) * num_events);
     //better with 32bit value?  Verify this is 8 and then check if better memory coalescing occurs with 32 int
 
+    clppBuffer d_ready_flag (clpp_context.getBufferPool(), sizeof (unsigned char) * num_lps);
+
     //INITIALIZE WORK MEMORY
 
-    //work memory for sort
-    unsigned int temp_sort_bytes = 64512;
-	clppSort_RadixSortGPU RadixSort(&clpp_context, num_events, temp_sort_bytes*8, false);
-	cl_mem d_temp_sort = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, temp_sort_bytes, NULL, &errNum);
-    clCheckError (errNum, "clCreateBuffer: d_temp_sort");
+    //LBTS : the smallest event time, reduced on the device without sorting the event list
+	clppReduce LbtsReduce(&clpp_context, clppOperator(clppDataType_Float, clppOperator_Min), num_events);
 
-    //work memory for reduce
-    size_t temp_reduce_bytes = 4096;
-	clppSort_RadixSortGPU RadixReduce(&clpp_context, num_events, temp_reduce_bytes*8, true);
-	cl_mem d_temp_reduce = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, temp_reduce_bytes, NULL, &errNum);
-    clCheckError (errNum, "clCreateBuffer: d_temp_reduce");
+    //Ready LPs : the indices of the LPs with a safe event, so the event kernel only runs over them
+	clppCompact ReadyCompact(&clpp_context, sizeof (cl_uint), num_lps);
 
     size_t grid_size[1] = {((num_events + block_size[0] - 1) / block_size[0])};
     size_t grid_run_size[1] = {((num_lps + block_size[0] - 1) / block_size[0])};
+    size_t lp_global_size[1] = {grid_run_size[0] * block_size[0]};
+    // OpenCL takes the number of work-items, not the number of blocks
+    size_t event_global_size[1] = {grid_size[0] * block_size[0]};
 
     std::cout << "Grid Size: " << grid_size[0] << " Block Size: " << block_size[0] << std::endl;
 
-    cl_int clStatus = runInitializeSimulator (grid_size, block_size,
+    cl_int clStatus = runInitializeSimulator (event_global_size, block_size,
     		d_random_state, d_lp_current_time, d_event_time, d_event_lp_number, d_events_processed);
 	clCheckError (clStatus, "runInitializeSimulator");
 
 	std::cout << "Running simulation..." << std::endl;
 
-	total_start_time = cpuSecond();
+	clppScopedTimer simulation_timer ("simulation", true);
 
-    float *local_event_times = (float *)calloc (sizeof(float), num_events);
 	while(true)
 	{
-		std::cout << "0 Current LBTS: " << current_lbts << std::endl;
-		clEnqueueReadBuffer(clpp_context.clQueue, d_event_time, CL_TRUE, 0, 4 * num_events, local_event_times, 0, NULL, NULL);
-		std::cout << "1 Current LBTS: " << current_lbts << "; Local event time[0]: " << local_event_times[10] << std::endl;
-		RadixReduce.pushDatas(local_event_times, num_events);
-		std::cout << "2 Current LBTS: " << current_lbts << std::endl;
-		RadixReduce.sort();
-		std::cout << "3 Current LBTS: " << current_lbts << std::endl;
-		RadixReduce.popDatas(local_event_times);
-		std::cout << "4 Current LBTS: " << current_lbts << std::endl;
-		current_lbts = local_event_times[0];
-		std::cout << "5 Current LBTS: " << current_lbts << std::endl;
+		clppScopedTimer window_timer ("window");
+
+		clppScopedTimer lbts_timer ("lbts");
+		LbtsReduce.pushCLDatas(d_event_time, num_events);
+		LbtsReduce.reduce();
+
+		// simulatorRunReady reads the LBTS on the device
+		clStatus = clpp_context.getProfiler()->enqueueCopyBuffer(LbtsReduce.getCLResultBuffer(), d_current_lbts, 0, 0, sizeof (float), 0, NULL, NULL);
+		clCheckError (clStatus, "clEnqueueCopyBuffer: d_current_lbts");
+		LbtsReduce.popDatas(&current_lbts);
+		lbts_timer.stop();
+		std::cout << "Current LBTS: " << current_lbts << std::endl;
 
 		if(current_lbts >= stop_time)
 		{
 		  break;
 		}
 
-//	CudaCheck(cub::DeviceRadixSort::SortPairs(d_temp_sort, temp_sort_bytes, d_event_time, d_event_lp_number, num_events));
-
-//	CudaCheck(cub::DeviceRadixSort::SortPairs(d_temp_sort, temp_sort_bytes, d_event_lp_number, d_event_time, num_events));
-
-		clStatus = runMarkNextEventByLP (grid_size, block_size,
+		clppScopedTimer mark_timer ("mark");
+		clStatus = runMarkNextEventByLP (event_global_size, block_size,
 				d_event_lp_number, d_next_event_flag);
 		clCheckError (clStatus, "runMarkNextEventByLP");
 
-		clStatus = runSimulatorRun (grid_run_size, block_size,
-				d_random_state, d_lp_current_time, d_event_time, d_event_lp_number, d_current_lbts, d_events_processed);
-		clCheckError (clStatus, "runSimulatorRun");
+		clStatus = runMarkReadyLPs (lp_global_size, block_size,
+				d_event_time, d_current_lbts, d_ready_flag);
+		clCheckError (clStatus, "runMarkReadyLPs");
+		mark_timer.stop();
+
+		clppScopedTimer compact_timer ("compact");
+		ReadyCompact.pushCLDatas(0, num_lps);
+		ReadyCompact.pushCLFlags(d_ready_flag);
+		ReadyCompact.compact();
+		clppIndex num_ready = ReadyCompact.popCount();
+		compact_timer.stop();
+
+		if (num_ready > 0)
+		{
+			clppScopedTimer run_timer ("run");
+			clStatus = runSimulatorRunReady (block_size, ReadyCompact.getCLResultBuffer(), num_ready,
+					d_random_state, d_lp_current_time, d_event_time, d_event_lp_number, d_current_lbts, d_events_processed);
+			clCheckError (clStatus, "runSimulatorRunReady");
+		}
 	}
 
-	total_duration = cpuSecond() - total_start_time;
+	total_duration = simulation_timer.stop();
 
 	std::cout << "Stats: " << std::endl;
 
-	int* events_processed = (int*)malloc(sizeof(int) * num_lps);
-	clEnqueueReadBuffer(clpp_context.clQueue, d_events_processed, CL_TRUE, 0, 4 * num_lps, events_processed, 0, NULL, NULL);
+	// Mapped on the CPU and unified-memory devices, read into a host copy elsewhere
+	clppMappedBuffer events_processed (&clpp_context, d_events_processed, sizeof (int) * num_lps);
 
 	int total_events_processed = 0;
 	for(int i = 0; i < num_lps; ++i)
 	{
-		total_events_processed += events_processed[i];
+		total_events_processed += events_processed.as<int>()[i];
 	}
 
 	std::cout << "Total Number of Events Processed: " << total_events_processed << std::endl;
 
 	std::cout << "Simulation Run Time: " << total_duration << " seconds." << std::endl;
+	clpp_context.getBufferPool()->printStats();
+	if (pholdProfile)
+		clpp_context.getProfiler()->printStats();
+	if (pholdTimers)
+		clppTimer::printStats();
+	if (!pholdTraceFile.empty() && !clppTracer::write(pholdTraceFile, clpp_context.getProfiler()))
+		std::cerr << "Can't write the trace " << pholdTraceFile << std::endl;
 	std::cout << "The context: " << clpp_context.clContext << std::endl;
 	return 0;
 }
@@ -269,6 +272,24 @@ int main(int argc, char** argv)
 {
     shrQAStart(argc, argv);
 
+    // The build options of the PHOLD kernels
+    char* options = NULL;
+    if (shrGetCmdLineArgumentstr (argc, (const char**)argv, "options", &options))
+        pholdBuildOptions = options;
+    pholdProfile = shrCheckCmdLineFlag (argc, (const char**)argv, "profile") != 0;
+    pholdTimers = shrCheckCmdLineFlag (argc, (const char**)argv, "timers") != 0;
+
+    char* cache = NULL;
+    if (shrGetCmdLineArgumentstr (argc, (const char**)argv, "cache", &cache))
+        pholdCachePath = cache;
+
+    // The trace needs the host timers and the profiler
+    char* trace = NULL;
+    if (shrGetCmdLineArgumentstr (argc, (const char**)argv, "trace", &trace))
+        pholdTraceFile = trace;
+    clppTracer::setEnabled (!pholdTraceFile.empty());
+    clppTimer::setEnabled (pholdTimers || !pholdTraceFile.empty());
+
     // start logs
     shrSetLogFileName ("oclDeviceQuery.txt");
     shrLog("%s Starting...\n\n", argv[0]);
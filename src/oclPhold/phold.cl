@@ -45,7 +45,9 @@ __kernel void markNextEventByLP(__global int* event_lp, __global unsigned char*
   }
 }
 
-__kernel void simulatorRun(__global mwc64x_state_t* state,
+//one event of the LP 'idx', when it is safe to process
+void processNextEvent(int idx,
+						__global mwc64x_state_t* state,
 						__global float* current_time,
 						__global float* event_time,
 						__global int* event_lp,
@@ -53,8 +55,6 @@ __kernel void simulatorRun(__global mwc64x_state_t* state,
 						__global int* events_processed)
 {
   //goal:  Minimize the number of global memory accesses / anywhere that does read/write using []/arrays
-  int idx = get_global_id(0);
-
   float safe_time = *current_lbps + d_lookahead;
 
   //check the next event
@@ -102,4 +102,34 @@ __kernel void simulatorRun(__global mwc64x_state_t* state,
     event_lp[idx] = target_lp;
     state[idx] = rand;
   }
+}
+
+//flag the LPs whose next event is safe to process in this window
+__kernel void markReadyLPs(__global float* event_time, __global float* current_lbps, __global unsigned char* flags)
+{
+  int idx = get_global_id(0);
+
+  if(idx < d_num_lps)
+  {
+    float next_event_time = event_time[idx];
+    flags[idx] = (next_event_time <= *current_lbps + d_lookahead && next_event_time < d_stop_time) ? 1 : 0;
+  }
+}
+
+//process the next event of the ready LPs only (compacted by clppCompact)
+__kernel void simulatorRunReady(__global const INDEX_T* ready_lps,
+						const INDEX_T num_ready,
+						__global mwc64x_state_t* state,
+						__global float* current_time,
+						__global float* event_time,
+						__global int* event_lp,
+						__global float* current_lbps,
+						__global int* events_processed)
+{
+  INDEX_T i = get_global_id(0);
+
+  if(i < num_ready)
+  {
+    processNextEvent(ready_lps[i], state, current_time, event_time, event_lp, current_lbps, events_processed);
+  }
 }
\ No newline at end of file
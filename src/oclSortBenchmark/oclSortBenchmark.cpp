@@ -0,0 +1,900 @@
+/* Sort benchmark : keys/second of every clppSort implementation, and of the other primitives, written as CSV.
+ *
+ * Options :
+ *   --platform=N --device=N       OpenCL platform and device (default 0, 0)
+ *   --minlog=N --maxlog=N         Sizes from 2^minlog to 2^maxlog elements (default 10 to 26)
+ *   --sorts=gpu,radix,cpu,merge   The sort implementations. 'merge' sorts the last quarter of the data
+ *                                 set and merges it with the first three quarters, already sorted
+ *                                 (clppMerge::sortAndMerge)
+ *   --dists=uniform,sorted,reverse,fewunique,phold
+ *   --bits=16,32                  The key bit widths
+ *   --modes=keys,kv               Keys only and/or key-values (uint2)
+ *   --warmup=N --reps=N           Untimed and timed runs per configuration (default 2, 10)
+ *   --threads=N                   Threads of the CPU sort, the one of the merge on a CPU device
+ *                                 included (default : the hardware threads)
+ *   --primitives=count,segmented,histogram,rle
+ *                                 The other primitives, checked against a host reference on the same
+ *                                 distributions and sizes (32 bits keys) : 'count' counts by value
+ *                                 (256 bins, then 65536 bins in global memory) and by key (8 keys
+ *                                 with a linear search, 100 keys with a binary search). 'segmented'
+ *                                 sums segments of 1 to 700 elements, across the work-groups : the
+ *                                 exclusive and inclusive segmented scans, and the segmented reduction
+ *                                 by head flags and by offsets (with empty segments). 'histogram'
+ *                                 bins by key (256 bins, then 65536 bins in global memory), by range
+ *                                 (float) and by bit-field. 'rle' encodes the keys as they are, and
+ *                                 runs of 1 to 700 equal keys, across the work-groups
+ *   --options=default,-cl-mad-enable,-cl-fast-relaxed-math
+ *                                 The build option sets to compare ('default' : no option), given
+ *                                 to all the programs. Each set is a separate build of the kernels.
+ *   --csv=file                    Output file (default : standard output)
+ *
+ * Each run sorts a fresh copy of the data already on the device, with a persistent ping-pong
+ * pair : uploads and allocations are not timed. The result of the last run is checked : the
+ * exit status is a failure when a configuration is not sorted, or when a primitive does not match
+ * its host reference.
+ */
+
+#include <oclUtils.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#include <clpp/clpp.h>
+#include <clpp/clppSort_RadixSortGPU.h>
+#include <clpp/clppSort_RadixSort.h>
+#include <clpp/clppSort_CPU.h>
+#include <clpp/clppMerge.h>
+#include <clpp/clppCount.h>
+#include <clpp/clppSegmentedScan.h>
+#include <clpp/clppSegmentedReduce.h>
+#include <clpp/clppHistogram.h>
+#include <clpp/clppRunLengthEncode.h>
+#include <clpp/clppTimer.h>
+
+inline void clCheckError (cl_int err, const char *name)
+{
+	if (err != CL_SUCCESS)
+	{
+		std::cerr << "ERROR: " << name << " (" << err << ")" << std::endl;
+		exit (EXIT_FAILURE);
+	}
+}
+
+static clppContext clpp_context;
+
+// Split a comma separated command line list
+static std::vector<std::string> getListArgument (int argc, char** argv, const char* name, const char* defaultValue)
+{
+	char* value = NULL;
+	std::string list = defaultValue;
+	if (shrGetCmdLineArgumentstr (argc, (const char**)argv, name, &value))
+		list = value;
+
+	std::vector<std::string> items;
+	std::stringstream stream(list);
+	std::string item;
+	while (std::getline (stream, item, ','))
+		if (!item.empty())
+			items.push_back (item);
+
+	return items;
+}
+
+static clppSort* createSort (const std::string& name, unsigned int maxElements, unsigned int bits, bool keysOnly, int cpuThreads)
+{
+	if (name == "gpu")
+		return new clppSort_RadixSortGPU (&clpp_context, maxElements, bits, keysOnly);
+	if (name == "radix")
+		return new clppSort_RadixSort (&clpp_context, maxElements, bits, keysOnly);
+	if (name == "cpu")
+	{
+		clppSort_CPU* sort = new clppSort_CPU (&clpp_context, maxElements, bits, keysOnly);
+		if (cpuThreads > 0)
+			sort->setThreadCount (cpuThreads);
+		return sort;
+	}
+
+	std::cerr << "Unknown sort: " << name << std::endl;
+	exit (EXIT_FAILURE);
+}
+
+// Fill 'keys' with the given distribution, masked to 'bits'
+static void generateKeys (const std::string& dist, unsigned int bits, std::vector<unsigned int>& keys)
+{
+	unsigned int mask = (bits >= 32) ? 0xFFFFFFFF : ((1u << bits) - 1);
+	size_t n = keys.size();
+
+	srand (1234);
+	for(size_t i = 0; i < n; i++)
+	{
+		unsigned int key;
+		if (dist == "uniform")
+			key = ((unsigned int)rand() << 16) ^ (unsigned int)rand();
+		else if (dist == "sorted")
+			key = (unsigned int)((unsigned long long)i * mask / (n > 1 ? n - 1 : 1));
+		else if (dist == "reverse")
+			key = (unsigned int)((unsigned long long)(n - 1 - i) * mask / (n > 1 ? n - 1 : 1));
+		else if (dist == "fewunique")
+			key = (rand() % 16) * (mask / 16);
+		else if (dist == "phold")
+		{
+			// Timestamps of a PHOLD window : lbts + lookahead + exponential delay, as float bits
+			float u = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+			float time = 10.0f + 4.0f - 0.9f * logf(u);
+			memcpy (&key, &time, sizeof (float));
+		}
+		else
+		{
+			std::cerr << "Unknown distribution: " << dist << std::endl;
+			exit (EXIT_FAILURE);
+		}
+
+		keys[i] = key & mask;
+	}
+}
+
+// Check a sorted data set : keys in order, and each value (original index) still with its key
+static bool verifySorted (const std::vector<unsigned int>& result, const std::vector<unsigned int>& keys, size_t n, bool keysOnly)
+{
+	unsigned int words = keysOnly ? 1 : 2;
+	for(size_t i = 0; i < n; i++)
+	{
+		if (i > 0 && result[i * words] < result[(i - 1) * words])
+			return false;
+		if (!keysOnly && (result[i * words + 1] >= n || keys[result[i * words + 1]] != result[i * words]))
+			return false;
+	}
+	return true;
+}
+
+// Write a line of the CSV, the times in seconds
+static void writeResult (std::ostream& csv, const std::string& name, const std::string& mode, unsigned int bits, const std::string& dist,
+	size_t n, const std::string& options, std::vector<double>& times, bool verified)
+{
+	std::sort (times.begin(), times.end());
+	double median = times[times.size() / 2];
+
+	csv << name << "," << mode << "," << bits << "," << dist << "," << n << "," << options << ","
+		<< median * 1000.0 << "," << times[0] * 1000.0 << "," << n / median / 1.e6 << ","
+		<< (verified ? "yes" : "no") << std::endl;
+}
+
+// sortAndMerge of the last quarter of each data set with the first three quarters, sorted on the host.
+// Returns false when a result is not sorted.
+static bool benchmarkMerge (std::ostream& csv, const std::vector<std::string>& dists, const std::string& mode, unsigned int bits,
+	const std::string& options, int minLog, int maxLog, int warmup, int reps, int cpuThreads)
+{
+	cl_int errNum;
+
+	bool keysOnly = (mode != "kv");
+	unsigned int words = keysOnly ? 1 : 2;
+	unsigned int maxElements = 1u << maxLog;
+
+	clppMerge merge (&clpp_context, maxElements, bits, keysOnly);
+	clppSort_CPU* cpuSort = dynamic_cast<clppSort_CPU*> (merge.getSort());
+	if (cpuSort && cpuThreads > 0)
+		cpuSort->setThreadCount (cpuThreads);
+
+	// The sorted run, the updates (sorted in place, uploaded again before each run) and the merged set
+	size_t bytes = sizeof (cl_uint) * words * maxElements;
+	cl_mem d_run = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, bytes, NULL, &errNum);
+	clCheckError (errNum, "clCreateBuffer: d_run");
+	cl_mem d_updates = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, bytes, NULL, &errNum);
+	clCheckError (errNum, "clCreateBuffer: d_updates");
+	cl_mem d_merged = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, bytes, NULL, &errNum);
+	clCheckError (errNum, "clCreateBuffer: d_merged");
+
+	std::vector<unsigned int> keys;
+	std::vector<unsigned int> data;
+	std::vector<unsigned int> result;
+	std::vector<double> times;
+	std::vector<std::pair<unsigned int, unsigned int> > run;
+	bool allVerified = true;
+
+	for(size_t d = 0; d < dists.size(); d++)
+	for(int log = minLog; log <= maxLog; log++)
+	{
+		size_t n = (size_t)1 << log;
+		size_t runSize = n - n / 4;
+		size_t updatesSize = n / 4;
+
+		//---- The values are the original indices, the run is sorted on the host
+		keys.resize (n);
+		generateKeys (dists[d], bits, keys);
+
+		run.resize (runSize);
+		for(size_t i = 0; i < runSize; i++)
+			run[i] = std::make_pair (keys[i], (unsigned int)i);
+		std::stable_sort (run.begin(), run.end());
+
+		data.resize (n * words);
+		for(size_t i = 0; i < n; i++)
+		{
+			data[i * words] = (i < runSize) ? run[i].first : keys[i];
+			if (!keysOnly)
+				data[i * words + 1] = (i < runSize) ? run[i].second : i;
+		}
+
+		errNum = clEnqueueWriteBuffer (clpp_context.clQueue, d_run, CL_TRUE, 0, sizeof (cl_uint) * runSize * words, &data[0], 0, NULL, NULL);
+		clCheckError (errNum, "clEnqueueWriteBuffer: d_run");
+
+		//---- Warmup, then timed runs
+		times.clear ();
+		for(int r = 0; r < warmup + reps; r++)
+		{
+			errNum = clEnqueueWriteBuffer (clpp_context.clQueue, d_updates, CL_TRUE, 0, sizeof (cl_uint) * updatesSize * words, &data[runSize * words], 0, NULL, NULL);
+			clCheckError (errNum, "clEnqueueWriteBuffer: d_updates");
+
+			clppScopedTimer merge_timer ("merge", true);
+			merge.sortAndMerge (d_run, runSize, d_updates, updatesSize, d_merged);
+			clFinish (clpp_context.clQueue);
+			double duration = merge_timer.stop ();
+
+			if (r >= warmup)
+				times.push_back (duration);
+		}
+
+		result.resize (n * words);
+		errNum = clEnqueueReadBuffer (clpp_context.clQueue, d_merged, CL_TRUE, 0, sizeof (cl_uint) * n * words, &result[0], 0, NULL, NULL);
+		clCheckError (errNum, "clEnqueueReadBuffer: d_merged");
+
+		bool verified = verifySorted (result, keys, n, keysOnly);
+		allVerified &= verified;
+
+		writeResult (csv, merge.getName(), mode, bits, dists[d], n, options, times, verified);
+	}
+
+	clReleaseMemObject (d_run);
+	clReleaseMemObject (d_updates);
+	clReleaseMemObject (d_merged);
+
+	return allVerified;
+}
+
+// Count the values of each data set : by value (the bin is the value, the values outside the bins are not
+// counted) and by key (the bin is the index of the value in a table of keys). The counts are checked
+// against a std::map of the values. Returns false when a count is wrong.
+static bool benchmarkCount (std::ostream& csv, const std::vector<std::string>& dists, const std::string& options,
+	int minLog, int maxLog, int warmup, int reps)
+{
+	cl_int errNum;
+
+	// The configurations : the number of bins, and the number of keys (0 : by value)
+	const char* modeNames[] = { "bins256", "bins65536", "keys8", "keys100" };
+	const unsigned int modeBins[] = { 256, 65536, 8, 100 };
+	const bool modeKeys[] = { false, false, true, true };
+
+	clppIndex maxElements = (clppIndex)1 << maxLog;
+
+	cl_mem d_values = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (cl_uint) * maxElements, NULL, &errNum);
+	clCheckError (errNum, "clCreateBuffer: d_values");
+
+	std::vector<unsigned int> keys;
+	std::vector<unsigned int> values;
+	std::vector<unsigned int> binKeys;
+	std::vector<clppIndex> counts;
+	std::vector<double> times;
+	std::map<unsigned int, size_t> reference;
+	bool allVerified = true;
+
+	for(size_t m = 0; m < 4; m++)
+	{
+		unsigned int bins = modeBins[m];
+		clppCount count (&clpp_context, sizeof (cl_uint), bins, maxElements);
+
+		//---- Distinct keys, spread over the 32 bits
+		if (modeKeys[m])
+		{
+			binKeys.resize (bins);
+			for(unsigned int b = 0; b < bins; b++)
+				binKeys[b] = b * 2654435761u + 12345u;
+			count.setKeys (&binKeys[0]);
+		}
+
+		for(size_t d = 0; d < dists.size(); d++)
+		for(int log = minLog; log <= maxLog; log++)
+		{
+			size_t n = (size_t)1 << log;
+
+			//---- The values : a few outside the bins, the others in the bins (by the distribution)
+			keys.resize (n);
+			generateKeys (dists[d], 32, keys);
+
+			values.resize (n);
+			for(size_t i = 0; i < n; i++)
+			{
+				unsigned int bin = keys[i] % (bins + bins / 8 + 1);
+				if (modeKeys[m])
+					values[i] = (bin < bins) ? binKeys[bin] : binKeys[bin % bins] + 1;
+				else
+					values[i] = bin;
+			}
+
+			errNum = clEnqueueWriteBuffer (clpp_context.clQueue, d_values, CL_TRUE, 0, sizeof (cl_uint) * n, &values[0], 0, NULL, NULL);
+			clCheckError (errNum, "clEnqueueWriteBuffer: d_values");
+
+			//---- Warmup, then timed runs
+			times.clear ();
+			for(int r = 0; r < warmup + reps; r++)
+			{
+				clppScopedTimer count_timer ("count", true);
+				count.pushCLDatas (d_values, n);
+				count.count ();
+				clFinish (clpp_context.clQueue);
+				double duration = count_timer.stop ();
+
+				if (r >= warmup)
+					times.push_back (duration);
+			}
+
+			//---- Check the last run
+			counts.resize (bins);
+			count.popDatas (&counts[0]);
+
+			reference.clear ();
+			for(size_t i = 0; i < n; i++)
+				reference[values[i]]++;
+
+			bool verified = true;
+			for(unsigned int b = 0; b < bins; b++)
+			{
+				std::map<unsigned int, size_t>::iterator it = reference.find (modeKeys[m] ? binKeys[b] : b);
+				if (counts[b] != ((it != reference.end()) ? it->second : 0))
+					verified = false;
+			}
+			allVerified &= verified;
+
+			writeResult (csv, count.getName(), modeNames[m], 32, dists[d], n, options, times, verified);
+		}
+	}
+
+	clReleaseMemObject (d_values);
+
+	return allVerified;
+}
+
+// The segments of a data set of 'n' elements : 1 to 700 elements, so they cross the work-groups. With
+// 'emptySegments', one offset in 8 is repeated (an empty segment).
+static void generateSegments (size_t n, bool emptySegments, std::vector<unsigned char>& heads, std::vector<clppIndex>& offsets)
+{
+	heads.assign (n, 0);
+	offsets.clear ();
+
+	srand (4321);
+	for(size_t i = 0; i < n; i += 1 + rand() % 700)
+	{
+		heads[i] = 1;
+		offsets.push_back (i);
+		if (emptySegments && rand() % 8 == 0)
+			offsets.push_back (i);
+	}
+}
+
+// The segmented scans (exclusive and inclusive, by head flags and by offsets) and the segmented reductions
+// (by head flags and by offsets) of the sum of uint, checked against a host reference. Returns false when a
+// result is wrong.
+static bool benchmarkSegmented (std::ostream& csv, const std::vector<std::string>& dists, const std::string& options,
+	int minLog, int maxLog, int warmup, int reps)
+{
+	cl_int errNum;
+
+	clppIndex maxElements = (clppIndex)1 << maxLog;
+
+	clppSegmentedScan exclusiveScan (&clpp_context, clppOperator(clppDataType_UInt, clppOperator_Sum), maxElements, false);
+	clppSegmentedScan inclusiveScan (&clpp_context, clppOperator(clppDataType_UInt, clppOperator_Sum), maxElements, true);
+	clppSegmentedReduce reduce (&clpp_context, clppOperator(clppDataType_UInt, clppOperator_Sum), maxElements);
+
+	// The values (kept), their copy scanned in place, the head flags and the offsets
+	cl_mem d_source = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (cl_uint) * maxElements, NULL, &errNum);
+	clCheckError (errNum, "clCreateBuffer: d_source");
+	cl_mem d_values = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (cl_uint) * maxElements, NULL, &errNum);
+	clCheckError (errNum, "clCreateBuffer: d_values");
+	cl_mem d_heads = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (cl_uchar) * maxElements, NULL, &errNum);
+	clCheckError (errNum, "clCreateBuffer: d_heads");
+	cl_mem d_offsets = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (clppIndex) * maxElements * 2, NULL, &errNum);
+	clCheckError (errNum, "clCreateBuffer: d_offsets");
+
+	std::vector<unsigned int> keys;
+	std::vector<unsigned int> result;
+	std::vector<unsigned int> expected;
+	std::vector<unsigned char> heads;
+	std::vector<clppIndex> offsets;
+	std::vector<double> times;
+	bool allVerified = true;
+
+	for(size_t d = 0; d < dists.size(); d++)
+	for(int log = minLog; log <= maxLog; log++)
+	{
+		size_t n = (size_t)1 << log;
+
+		keys.resize (n);
+		generateKeys (dists[d], 32, keys);
+
+		errNum = clEnqueueWriteBuffer (clpp_context.clQueue, d_source, CL_TRUE, 0, sizeof (cl_uint) * n, &keys[0], 0, NULL, NULL);
+		clCheckError (errNum, "clEnqueueWriteBuffer: d_source");
+
+		//---- The scans : exclusive by head flags, inclusive by head flags, inclusive by offsets
+		for(int mode = 0; mode < 3; mode++)
+		{
+			bool inclusive = (mode > 0);
+			bool byOffsets = (mode == 2);
+			clppSegmentedScan& scan = inclusive ? inclusiveScan : exclusiveScan;
+
+			generateSegments (n, false, heads, offsets);
+			errNum  = clEnqueueWriteBuffer (clpp_context.clQueue, d_heads, CL_TRUE, 0, sizeof (cl_uchar) * n, &heads[0], 0, NULL, NULL);
+			errNum |= clEnqueueWriteBuffer (clpp_context.clQueue, d_offsets, CL_TRUE, 0, sizeof (clppIndex) * offsets.size(), &offsets[0], 0, NULL, NULL);
+			clCheckError (errNum, "clEnqueueWriteBuffer: segments");
+
+			times.clear ();
+			for(int r = 0; r < warmup + reps; r++)
+			{
+				errNum = clEnqueueCopyBuffer (clpp_context.clQueue, d_source, d_values, 0, 0, sizeof (cl_uint) * n, 0, NULL, NULL);
+				errNum |= clFinish (clpp_context.clQueue);
+				clCheckError (errNum, "clEnqueueCopyBuffer: d_values");
+
+				clppScopedTimer scan_timer ("segmented scan", true);
+				scan.pushCLDatas (d_values, n);
+				if (byOffsets)
+					scan.pushCLOffsets (d_offsets, offsets.size());
+				else
+					scan.pushCLHeads (d_heads);
+				scan.scan ();
+				clFinish (clpp_context.clQueue);
+				double duration = scan_timer.stop ();
+
+				if (r >= warmup)
+					times.push_back (duration);
+			}
+
+			result.resize (n);
+			scan.popDatas (&result[0]);
+
+			// The host reference : the sum restarts at each head
+			bool verified = true;
+			unsigned int sum = 0;
+			for(size_t i = 0; i < n; i++)
+			{
+				if (heads[i])
+					sum = 0;
+				if (!inclusive && result[i] != sum)
+					verified = false;
+				sum += keys[i];
+				if (inclusive && result[i] != sum)
+					verified = false;
+			}
+			allVerified &= verified;
+
+			const char* modeNames[] = { "exclusive-heads", "inclusive-heads", "inclusive-offsets" };
+			writeResult (csv, scan.getName(), modeNames[mode], 32, dists[d], n, options, times, verified);
+		}
+
+		//---- The reductions : by head flags, by offsets with empty segments
+		for(int mode = 0; mode < 2; mode++)
+		{
+			bool byOffsets = (mode == 1);
+
+			generateSegments (n, byOffsets, heads, offsets);
+			errNum  = clEnqueueWriteBuffer (clpp_context.clQueue, d_heads, CL_TRUE, 0, sizeof (cl_uchar) * n, &heads[0], 0, NULL, NULL);
+			errNum |= clEnqueueWriteBuffer (clpp_context.clQueue, d_offsets, CL_TRUE, 0, sizeof (clppIndex) * offsets.size(), &offsets[0], 0, NULL, NULL);
+			clCheckError (errNum, "clEnqueueWriteBuffer: segments");
+
+			times.clear ();
+			for(int r = 0; r < warmup + reps; r++)
+			{
+				clppScopedTimer reduce_timer ("segmented reduction", true);
+				reduce.pushCLDatas (d_source, n);
+				if (byOffsets)
+					reduce.pushCLOffsets (d_offsets, offsets.size());
+				else
+					reduce.pushCLHeads (d_heads);
+				reduce.reduce ();
+				clFinish (clpp_context.clQueue);
+				double duration = reduce_timer.stop ();
+
+				if (r >= warmup)
+					times.push_back (duration);
+			}
+
+			// The host reference : the sum of each segment, 0 for an empty one
+			expected.assign (offsets.size(), 0);
+			for(size_t s = 0; s < offsets.size(); s++)
+			{
+				size_t end = (s + 1 < offsets.size()) ? offsets[s + 1] : n;
+				for(size_t i = offsets[s]; i < end; i++)
+					expected[s] += keys[i];
+			}
+
+			bool verified = (reduce.popCount() == offsets.size());
+			if (verified)
+			{
+				result.resize (offsets.size());
+				reduce.popDatas (&result[0]);
+				verified = (result == expected);
+			}
+			allVerified &= verified;
+
+			writeResult (csv, reduce.getName(), byOffsets ? "offsets" : "heads", 32, dists[d], n, options, times, verified);
+		}
+	}
+
+	clReleaseMemObject (d_source);
+	clReleaseMemObject (d_values);
+	clReleaseMemObject (d_heads);
+	clReleaseMemObject (d_offsets);
+
+	return allVerified;
+}
+
+// The histograms of each data set : by key (uint), by range (float) and by bit-field (uint), checked against
+// the bins computed on the host. Returns false when a histogram is wrong.
+static bool benchmarkHistogram (std::ostream& csv, const std::vector<std::string>& dists, const std::string& options,
+	int minLog, int maxLog, int warmup, int reps)
+{
+	cl_int errNum;
+
+	const char* modeNames[] = { "key256", "key65536", "range", "bitfield" };
+	const unsigned int modeBins[] = { 256, 65536, 100, 64 };
+	const clppHistogramBinning modeBinnings[] = { clppHistogram_Key, clppHistogram_Key, clppHistogram_Range, clppHistogram_BitField };
+
+	// The range : 100 bins over [100, 1100[, the values from 0 to 1199. The bit-field : the bits 8 to 13.
+	const float rangeMin = 100.0f, rangeMax = 1100.0f;
+	const unsigned int shift = 8;
+
+	unsigned int maxElements = 1u << maxLog;
+
+	cl_mem d_values = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (cl_uint) * maxElements, NULL, &errNum);
+	clCheckError (errNum, "clCreateBuffer: d_values");
+
+	std::vector<unsigned int> keys;
+	std::vector<unsigned int> values;
+	std::vector<unsigned int> result;
+	std::vector<unsigned int> expected;
+	std::vector<double> times;
+	bool allVerified = true;
+
+	for(size_t m = 0; m < 4; m++)
+	{
+		unsigned int bins = modeBins[m];
+		bool isRange = (modeBinnings[m] == clppHistogram_Range);
+
+		clppHistogram histogram (&clpp_context, isRange ? clppDataType_Float : clppDataType_UInt, bins, modeBinnings[m], maxElements);
+		histogram.setRange (rangeMin, rangeMax);
+		histogram.setBitField (shift);
+		float rangeScale = bins / (rangeMax - rangeMin);
+
+		for(size_t d = 0; d < dists.size(); d++)
+		for(int log = minLog; log <= maxLog; log++)
+		{
+			size_t n = (size_t)1 << log;
+
+			//---- The values and their bins on the host, the same expressions as the kernel
+			keys.resize (n);
+			generateKeys (dists[d], 32, keys);
+
+			values.resize (n);
+			expected.assign (bins, 0);
+			for(size_t i = 0; i < n; i++)
+			{
+				unsigned int bin;
+				if (isRange)
+				{
+					float X = (float)(keys[i] % 1200);
+					memcpy (&values[i], &X, sizeof (float));
+					bin = (X >= rangeMin) ? (unsigned int)std::min ((float)(X - rangeMin) * rangeScale, (float)bins) : bins;
+				}
+				else if (modeBinnings[m] == clppHistogram_BitField)
+				{
+					values[i] = keys[i];
+					bin = (values[i] >> shift) & (bins - 1);
+				}
+				else
+				{
+					// A few values outside the bins
+					values[i] = keys[i] % (bins + bins / 8 + 1);
+					bin = values[i];
+				}
+
+				if (bin < bins)
+					expected[bin]++;
+			}
+
+			errNum = clEnqueueWriteBuffer (clpp_context.clQueue, d_values, CL_TRUE, 0, sizeof (cl_uint) * n, &values[0], 0, NULL, NULL);
+			clCheckError (errNum, "clEnqueueWriteBuffer: d_values");
+
+			//---- Warmup, then timed runs
+			times.clear ();
+			for(int r = 0; r < warmup + reps; r++)
+			{
+				clppScopedTimer histogram_timer ("histogram", true);
+				histogram.pushCLDatas (d_values, n);
+				histogram.histogram ();
+				clFinish (clpp_context.clQueue);
+				double duration = histogram_timer.stop ();
+
+				if (r >= warmup)
+					times.push_back (duration);
+			}
+
+			result.resize (bins);
+			histogram.popDatas (&result[0]);
+
+			bool verified = (result == expected);
+			allVerified &= verified;
+
+			writeResult (csv, histogram.getName(), modeNames[m], 32, dists[d], n, options, times, verified);
+		}
+	}
+
+	clReleaseMemObject (d_values);
+
+	return allVerified;
+}
+
+// The run-length encoding of each data set : the keys as they are, and runs of 1 to 700 equal keys (so the
+// runs cross the work-groups). The unique keys, offsets and lengths are checked against the runs found on
+// the host. Returns false when a run is wrong.
+static bool benchmarkRunLengthEncode (std::ostream& csv, const std::vector<std::string>& dists, const std::string& options,
+	int minLog, int maxLog, int warmup, int reps)
+{
+	cl_int errNum;
+
+	clppIndex maxElements = (clppIndex)1 << maxLog;
+
+	clppRunLengthEncode rle (&clpp_context, clppDataType_UInt, maxElements);
+
+	cl_mem d_keys = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (cl_uint) * maxElements, NULL, &errNum);
+	clCheckError (errNum, "clCreateBuffer: d_keys");
+
+	std::vector<unsigned int> keys;
+	std::vector<unsigned int> data;
+	std::vector<unsigned int> uniqueKeys, expectedKeys;
+	std::vector<clppIndex> offsets, expectedOffsets;
+	std::vector<clppIndex> lengths, expectedLengths;
+	std::vector<double> times;
+	bool allVerified = true;
+
+	for(int mode = 0; mode < 2; mode++)
+	for(size_t d = 0; d < dists.size(); d++)
+	for(int log = minLog; log <= maxLog; log++)
+	{
+		size_t n = (size_t)1 << log;
+
+		keys.resize (n);
+		generateKeys (dists[d], 32, keys);
+
+		//---- The keys as they are, or runs of the keys
+		data.resize (n);
+		if (mode == 0)
+			data = keys;
+		else
+		{
+			srand (4321);
+			size_t run = 0;
+			for(size_t i = 0; i < n; run++)
+			{
+				size_t end = std::min (n, i + 1 + rand() % 700);
+				for(; i < end; i++)
+					data[i] = keys[run];
+			}
+		}
+
+		//---- The runs on the host
+		expectedKeys.clear ();
+		expectedOffsets.clear ();
+		expectedLengths.clear ();
+		for(size_t i = 0; i < n; i++)
+		{
+			if (i == 0 || data[i] != data[i - 1])
+			{
+				expectedKeys.push_back (data[i]);
+				expectedOffsets.push_back (i);
+				expectedLengths.push_back (0);
+			}
+			expectedLengths.back()++;
+		}
+
+		errNum = clEnqueueWriteBuffer (clpp_context.clQueue, d_keys, CL_TRUE, 0, sizeof (cl_uint) * n, &data[0], 0, NULL, NULL);
+		clCheckError (errNum, "clEnqueueWriteBuffer: d_keys");
+
+		//---- Warmup, then timed runs
+		times.clear ();
+		for(int r = 0; r < warmup + reps; r++)
+		{
+			clppScopedTimer rle_timer ("rle", true);
+			rle.pushCLDatas (d_keys, n);
+			rle.encode ();
+			clFinish (clpp_context.clQueue);
+			double duration = rle_timer.stop ();
+
+			if (r >= warmup)
+				times.push_back (duration);
+		}
+
+		bool verified = (rle.popCount() == expectedKeys.size());
+		if (verified)
+		{
+			uniqueKeys.resize (expectedKeys.size());
+			offsets.resize (expectedKeys.size());
+			lengths.resize (expectedKeys.size());
+			rle.popDatas (&uniqueKeys[0], &offsets[0], &lengths[0]);
+			verified = (uniqueKeys == expectedKeys && offsets == expectedOffsets && lengths == expectedLengths);
+		}
+		allVerified &= verified;
+
+		writeResult (csv, rle.getName(), (mode == 0) ? "keys" : "runs", 32, dists[d], n, options, times, verified);
+	}
+
+	clReleaseMemObject (d_keys);
+
+	return allVerified;
+}
+
+int runBenchmark (int argc, char** argv)
+{
+	cl_int errNum;
+
+	int platform = 0, device = 0, minLog = 10, maxLog = 26, warmup = 2, reps = 10, cpuThreads = 0;
+	shrGetCmdLineArgumenti (argc, (const char**)argv, "platform", &platform);
+	shrGetCmdLineArgumenti (argc, (const char**)argv, "device", &device);
+	shrGetCmdLineArgumenti (argc, (const char**)argv, "minlog", &minLog);
+	shrGetCmdLineArgumenti (argc, (const char**)argv, "maxlog", &maxLog);
+	shrGetCmdLineArgumenti (argc, (const char**)argv, "warmup", &warmup);
+	shrGetCmdLineArgumenti (argc, (const char**)argv, "reps", &reps);
+	shrGetCmdLineArgumenti (argc, (const char**)argv, "threads", &cpuThreads);
+	reps = std::max (reps, 1);
+
+	// --timers : the host time of the steps of the sorts, printed at the end
+	bool timers = shrCheckCmdLineFlag (argc, (const char**)argv, "timers") != 0;
+	clppTimer::setEnabled (timers);
+
+	std::vector<std::string> sorts = getListArgument (argc, argv, "sorts", "gpu,radix,cpu");
+	std::vector<std::string> dists = getListArgument (argc, argv, "dists", "uniform,sorted,reverse,fewunique,phold");
+	std::vector<std::string> bitsList = getListArgument (argc, argv, "bits", "16,32");
+	std::vector<std::string> modes = getListArgument (argc, argv, "modes", "keys,kv");
+	std::vector<std::string> primitives = getListArgument (argc, argv, "primitives", "count,segmented,histogram,rle");
+	std::vector<std::string> optionSets = getListArgument (argc, argv, "options", "default");
+
+	std::ofstream csvFile;
+	char* csvName = NULL;
+	if (shrGetCmdLineArgumentstr (argc, (const char**)argv, "csv", &csvName))
+		csvFile.open (csvName);
+	std::ostream& csv = csvFile.is_open() ? csvFile : std::cout;
+
+	clpp_context.setup (platform, device);
+	clpp_context.printInformation ();
+
+	unsigned int maxElements = 1u << maxLog;
+
+	// The device buffers are sized for key-values, and shared by all the configurations
+	cl_mem d_source = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (cl_uint2) * maxElements, NULL, &errNum);
+	clCheckError (errNum, "clCreateBuffer: d_source");
+	cl_mem d_data = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (cl_uint2) * maxElements, NULL, &errNum);
+	clCheckError (errNum, "clCreateBuffer: d_data");
+	cl_mem d_scratch = clCreateBuffer (clpp_context.clContext, CL_MEM_READ_WRITE, sizeof (cl_uint2) * maxElements, NULL, &errNum);
+	clCheckError (errNum, "clCreateBuffer: d_scratch");
+
+	std::vector<unsigned int> keys;
+	std::vector<unsigned int> data;
+	std::vector<unsigned int> result;
+	std::vector<double> times;
+	bool allVerified = true;
+
+	csv << "sort,mode,bits,distribution,elements,build_options,median_ms,min_ms,mkeys_per_s,verified" << std::endl;
+
+	for(size_t o = 0; o < optionSets.size(); o++)
+	for(size_t s = 0; s < sorts.size(); s++)
+	for(size_t m = 0; m < modes.size(); m++)
+	for(size_t b = 0; b < bitsList.size(); b++)
+	{
+		bool keysOnly = (modes[m] != "kv");
+		unsigned int bits = atoi (bitsList[b].c_str());
+		unsigned int words = keysOnly ? 1 : 2;
+
+		// The options are part of the program cache keys : each set builds its own programs
+		clppProgram::setGlobalBuildOptions ((optionSets[o] == "default") ? "" : optionSets[o]);
+
+		if (sorts[s] == "merge")
+		{
+			allVerified &= benchmarkMerge (csv, dists, modes[m], bits, optionSets[o], minLog, maxLog, warmup, reps, cpuThreads);
+			continue;
+		}
+
+		clppSort* sort = createSort (sorts[s], maxElements, bits, keysOnly, cpuThreads);
+
+		for(size_t d = 0; d < dists.size(); d++)
+		for(int log = minLog; log <= maxLog; log++)
+		{
+			size_t n = (size_t)1 << log;
+
+			//---- Build and upload the data set, the values are the original indices
+			keys.resize (n);
+			generateKeys (dists[d], bits, keys);
+
+			data.resize (n * words);
+			for(size_t i = 0; i < n; i++)
+			{
+				data[i * words] = keys[i];
+				if (!keysOnly)
+					data[i * words + 1] = i;
+			}
+
+			errNum = clEnqueueWriteBuffer (clpp_context.clQueue, d_source, CL_TRUE, 0, sizeof (cl_uint) * n * words, &data[0], 0, NULL, NULL);
+			clCheckError (errNum, "clEnqueueWriteBuffer: d_source");
+
+			//---- Warmup, then timed runs on a fresh copy each time
+			times.clear ();
+			for(int r = 0; r < warmup + reps; r++)
+			{
+				errNum = clEnqueueCopyBuffer (clpp_context.clQueue, d_source, d_data, 0, 0, sizeof (cl_uint) * n * words, 0, NULL, NULL);
+				errNum |= clFinish (clpp_context.clQueue);
+				clCheckError (errNum, "clEnqueueCopyBuffer: d_data");
+
+				clppScopedTimer sort_timer ("sort", true);
+				sort->pushCLDatas (d_data, d_scratch, n);
+				sort->sort ();
+				sort->waitCompletion ();
+				clFinish (clpp_context.clQueue);
+				double duration = sort_timer.stop ();
+
+				if (r >= warmup)
+					times.push_back (duration);
+			}
+
+			//---- Check the last run : keys in order, and each value still with its key
+			result.resize (n * words);
+			errNum = clEnqueueReadBuffer (clpp_context.clQueue, sort->getCLResultBuffer(), CL_TRUE, 0, sizeof (cl_uint) * n * words, &result[0], 0, NULL, NULL);
+			clCheckError (errNum, "clEnqueueReadBuffer: result");
+
+			bool verified = verifySorted (result, keys, n, keysOnly);
+			allVerified &= verified;
+
+			writeResult (csv, sort->getName(), modes[m], bits, dists[d], n, optionSets[o], times, verified);
+		}
+
+		delete sort;
+	}
+
+	for(size_t o = 0; o < optionSets.size(); o++)
+	for(size_t p = 0; p < primitives.size(); p++)
+	{
+		clppProgram::setGlobalBuildOptions ((optionSets[o] == "default") ? "" : optionSets[o]);
+
+		if (primitives[p] == "count")
+			allVerified &= benchmarkCount (csv, dists, optionSets[o], minLog, maxLog, warmup, reps);
+		else if (primitives[p] == "segmented")
+			allVerified &= benchmarkSegmented (csv, dists, optionSets[o], minLog, maxLog, warmup, reps);
+		else if (primitives[p] == "histogram")
+			allVerified &= benchmarkHistogram (csv, dists, optionSets[o], minLog, maxLog, warmup, reps);
+		else if (primitives[p] == "rle")
+			allVerified &= benchmarkRunLengthEncode (csv, dists, optionSets[o], minLog, maxLog, warmup, reps);
+		else
+		{
+			std::cerr << "Unknown primitive: " << primitives[p] << std::endl;
+			exit (EXIT_FAILURE);
+		}
+	}
+
+	clReleaseMemObject (d_source);
+	clReleaseMemObject (d_data);
+	clReleaseMemObject (d_scratch);
+
+	if (timers)
+		clppTimer::printStats ();
+
+	return allVerified ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Program main
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+	return runBenchmark (argc, argv);
+}
\ No newline at end of file